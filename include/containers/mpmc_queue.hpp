@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace containers {
+
+/// @brief 有界无锁多生产者多消费者队列
+/// @note 基于序号的环形槽位(Vyukov)，容量向上取整为2的幂，元素按值移动入队
+/// @tparam T 需可默认构造与移动
+template <typename T> class MpmcQueue {
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+public:
+  /// @brief 指定容量构造
+  /// @param capacity
+  explicit MpmcQueue(size_t capacity = 1024) {
+    size_t size = 2;
+    while (size < capacity)
+      size <<= 1;
+    mask_ = size - 1;
+    cells_ = std::unique_ptr<Cell[]>(new Cell[size]);
+    for (size_t i = 0; i < size; ++i)
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+  /// @brief 尝试入队，队列满返回false且不移动data
+  /// @param data
+  /// @return
+  bool TryPush(T &&data) {
+    Cell *cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // 满
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(data);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief 尝试出队，队列空返回false
+  /// @param data
+  /// @return
+  bool TryPop(T &data) {
+    Cell *cell;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // 空
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    data = std::move(cell->data);
+    cell->data = T(); // 释放槽位持有的资源
+    cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief 近似元素个数(并发下仅供参考)
+  /// @return
+  size_t SizeApprox() const {
+    size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+    size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+    return enq > deq ? enq - deq : 0;
+  }
+
+  /// @brief 是否为空(并发下仅供参考)
+  /// @return
+  bool IsEmpty() const { return SizeApprox() == 0; }
+
+  /// @brief 容量
+  /// @return
+  size_t Capacity() const { return mask_ + 1; }
+
+private:
+  static constexpr size_t kCacheLine = 64;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  // 生产与消费游标分处不同缓存行，避免伪共享
+  alignas(kCacheLine) std::atomic<size_t> enqueue_pos_{0};
+  alignas(kCacheLine) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace containers
@@ -130,10 +130,14 @@ public:
   /// @brief hex打印缓冲区
   void PrintBuffer();
 
-  /// @brief 动态更新缓冲区容器实际大小
-  /// @return
+  /// @brief 动态更新缓冲区容器实际大小，保留未读数据(移至缓冲区头部)
+  /// @return 调整后的大小，新大小为0或小于已存储字节数时不变
   size_t Resize(size_t buffer_size);
 
+  /// @brief 原地将未读数据移至缓冲区头部，之后可经GetLinearReadSpace一次取得
+  /// @note 代价为未读字节数的内存移动，不重新分配；用于原地解析协议的场景
+  void Linearize();
+
   /// @brief 返回缓冲区容器实际大小
   /// @return
   size_t Capacity() const { return buffer_.size(); };
@@ -0,0 +1,459 @@
+#pragma once
+#include "../logger/logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <memory>
+#include <string.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace containers {
+
+/// @brief 共享内存环的生产者模式
+enum class ShmRingMode : uint32_t {
+  kSpsc = 0, // 单生产者
+  kMpsc = 1, // 多生产者(可跨进程)，预留用CAS，每条记录独立提交
+};
+
+/// @brief 进程间共享内存消息环
+/// @note 段由memfd(匿名，经fork继承或SCM_RIGHTS传递)或/dev/shm(具名)提供，
+/// 首页为控制头，其后为数据区；数据区被连续映射两次，任何消息在虚拟地址上
+/// 都是连续的，读写无需处理环回。消息为8字节对齐的长度前缀记录，负载可以是
+/// UnPacker帧或任意字节。
+/// kSpsc以提交游标发布消息；kMpsc以记录头中的提交位发布，生产者之间互不
+/// 等待，消费者按预留顺序读取并将已消费区域清零，供下一圈判断提交位。
+/// 稳态下收发不经系统调用：游标为共享原子量，只有消费者(或满时的生产者)
+/// 声明等待后对端才以futex(可选eventfd)唤醒。
+/// 每个进程各自持有一个ShmRing对象；同一对象的写接口在kMpsc模式下线程安全，
+/// 读接口只允许单个消费者调用
+class ShmRing {
+public:
+  static constexpr size_t kHeaderPage = 4096;
+  static constexpr size_t kRecordHeader = 8;
+
+  /// @brief 创建共享内存段
+  /// @param name 以'/'开头时在/dev/shm具名创建(已存在则覆盖)，否则为memfd名称
+  /// @param capacity 数据区字节数，向上取整为2的幂且不小于一页
+  /// @param mode
+  /// @return 失败返回nullptr
+  static std::unique_ptr<ShmRing> Create(const std::string &name,
+                                         size_t capacity,
+                                         ShmRingMode mode = ShmRingMode::kSpsc) {
+    size_t size = kHeaderPage;
+    while (size < capacity)
+      size <<= 1;
+
+    int fd = name.size() > 1 && name[0] == '/'
+                 ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600)
+                 : static_cast<int>(memfd_create(name.c_str(), MFD_CLOEXEC));
+    if (fd < 0) {
+      LOGP_ERROR("shm ring create %s failed,errno:%d", name.c_str(), errno);
+      return nullptr;
+    }
+    if (ftruncate(fd, static_cast<off_t>(kHeaderPage + size)) != 0) {
+      LOGP_ERROR("shm ring truncate failed,errno:%d", errno);
+      close(fd);
+      return nullptr;
+    }
+    std::unique_ptr<ShmRing> ring(new ShmRing(fd));
+    if (!ring->Map(size))
+      return nullptr;
+    // 新建的段由ftruncate清零，只需填写不变字段
+    Header *header = ring->header_;
+    header->capacity = size;
+    header->mode = static_cast<uint32_t>(mode);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+    return ring;
+  }
+
+  /// @brief 打开/dev/shm中已创建的具名段
+  /// @param name 以'/'开头
+  /// @return 失败返回nullptr
+  static std::unique_ptr<ShmRing> Open(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      LOGP_ERROR("shm ring open %s failed,errno:%d", name.c_str(), errno);
+      return nullptr;
+    }
+    return Attach(fd);
+  }
+
+  /// @brief 映射已有段的描述符(如经SCM_RIGHTS收到的memfd)，接管fd
+  /// @param fd
+  /// @return 失败返回nullptr并关闭fd
+  static std::unique_ptr<ShmRing> Attach(int fd) {
+    std::unique_ptr<ShmRing> ring(new ShmRing(fd));
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) <= kHeaderPage) {
+      LOG_ERROR("shm ring attach: invalid segment");
+      return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size) - kHeaderPage;
+    if ((size & (size - 1)) != 0 || !ring->Map(size))
+      return nullptr;
+    if (ring->header_->magic != kMagic ||
+        ring->header_->capacity != size) {
+      LOG_ERROR("shm ring attach: bad header");
+      return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return ring;
+  }
+
+  /// @brief 删除/dev/shm中的具名段，已映射的进程不受影响
+  static void Unlink(const std::string &name) { shm_unlink(name.c_str()); }
+
+  ShmRing(const ShmRing &) = delete;
+  ShmRing &operator=(const ShmRing &) = delete;
+
+  ~ShmRing() {
+    if (base_)
+      munmap(base_, kHeaderPage + 2 * mask_ + 2);
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+public:
+  /// @brief 尝试写入一条消息，原地填充
+  /// @param size 负载字节数，不超过MaxMessageSize
+  /// @param fill void(uint8_t *data)，向data写入size字节
+  /// @return 空间不足返回false
+  template <typename F> bool TryWrite(size_t size, F &&fill) {
+    if (size > MaxMessageSize())
+      return false;
+    const uint64_t need = RecordSize(size);
+    uint64_t pos = header_->write_pos.load(std::memory_order_relaxed);
+    const bool mpsc = header_->mode == static_cast<uint32_t>(ShmRingMode::kMpsc);
+    while (true) {
+      if (pos + need - header_->read_pos.load(std::memory_order_acquire) >
+          Capacity())
+        return false;
+      if (!mpsc) {
+        header_->write_pos.store(pos + need, std::memory_order_relaxed);
+        break;
+      }
+      if (header_->write_pos.compare_exchange_weak(
+              pos, pos + need, std::memory_order_relaxed))
+        break;
+    }
+
+    uint8_t *record = data_ + (pos & mask_);
+    fill(record + kRecordHeader);
+    if (mpsc) {
+      RecordWord(record)->store(static_cast<uint32_t>(size) | kCommitBit,
+                                std::memory_order_release);
+    } else {
+      uint32_t length = static_cast<uint32_t>(size);
+      memcpy(record, &length, sizeof(length));
+      header_->commit_pos.store(pos + need, std::memory_order_release);
+    }
+
+    // 与消费者Wait中的"先声明等待再检查"配对
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->consumer_waiting.load(std::memory_order_relaxed))
+      WakeConsumer();
+    return true;
+  }
+
+  /// @brief 尝试写入一条消息
+  /// @param data
+  /// @param size
+  /// @return 空间不足返回false
+  bool TryWrite(const void *data, size_t size) {
+    return TryWrite(size, [data, size](uint8_t *out) {
+      if (size)
+        memcpy(out, data, size);
+    });
+  }
+
+  /// @brief 写入一条消息，空间不足时等待消费者释放
+  /// @param data
+  /// @param size
+  /// @param timeout_ms 负数为不限
+  /// @return 超时或消息过大返回false
+  bool Write(const void *data, size_t size, int timeout_ms = -1) {
+    if (size > MaxMessageSize())
+      return false;
+    for (int spins = 0; spins < kSpinBeforeWait; ++spins) {
+      if (TryWrite(data, size))
+        return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+    while (true) {
+      uint32_t seq = header_->space_seq.load(std::memory_order_acquire);
+      header_->producers_waiting.fetch_add(1, std::memory_order_seq_cst);
+      bool written = TryWrite(data, size);
+      if (!written) {
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+          wait_ms = static_cast<int>(
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  deadline - std::chrono::steady_clock::now())
+                  .count());
+          if (wait_ms <= 0) {
+            header_->producers_waiting.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+          }
+        }
+        FutexWait(&header_->space_seq, seq, wait_ms);
+      }
+      header_->producers_waiting.fetch_sub(1, std::memory_order_relaxed);
+      if (written)
+        return true;
+    }
+  }
+
+  /// @brief 原地消费已提交的消息
+  /// @param cb void(const uint8_t *data, size_t size)，data仅在回调内有效
+  /// @param max_messages 本次最多消费的消息数
+  /// @return 消费的消息数
+  template <typename F> size_t Poll(F &&cb, size_t max_messages = SIZE_MAX) {
+    const uint64_t start = header_->read_pos.load(std::memory_order_relaxed);
+    uint64_t read = start;
+    size_t count = 0;
+    if (header_->mode == static_cast<uint32_t>(ShmRingMode::kMpsc)) {
+      // 以预留游标为界，避免读满一圈后把本轮的记录当作下一圈
+      const uint64_t reserved =
+          header_->write_pos.load(std::memory_order_acquire);
+      while (read != reserved && count < max_messages) {
+        uint8_t *record = data_ + (read & mask_);
+        uint32_t word = RecordWord(record)->load(std::memory_order_acquire);
+        if (!(word & kCommitBit))
+          break; // 未提交，后续记录即使已提交也按序等待
+        uint32_t size = word & ~kCommitBit;
+        cb(static_cast<const uint8_t *>(record + kRecordHeader),
+           static_cast<size_t>(size));
+        read += RecordSize(size);
+        count++;
+      }
+      // 数据区双重映射，跨越末尾的区域也可一次清零
+      if (count)
+        memset(data_ + (start & mask_), 0, static_cast<size_t>(read - start));
+    } else {
+      const uint64_t commit =
+          header_->commit_pos.load(std::memory_order_acquire);
+      while (read != commit && count < max_messages) {
+        const uint8_t *record = data_ + (read & mask_);
+        uint32_t size;
+        memcpy(&size, record, sizeof(uint32_t));
+        cb(record + kRecordHeader, static_cast<size_t>(size));
+        read += RecordSize(size);
+        count++;
+      }
+    }
+    if (count)
+      Release(read);
+    return count;
+  }
+
+  /// @brief 读取一条消息
+  /// @param out 输出，覆盖原内容
+  /// @return 无消息返回false
+  bool TryRead(std::vector<uint8_t> &out) {
+    return Poll(
+               [&out](const uint8_t *data, size_t size) {
+                 out.assign(data, data + size);
+               },
+               1) == 1;
+  }
+
+  /// @brief 消费者等待新消息
+  /// @param timeout_ms 负数为不限
+  /// @return 有可读消息返回true
+  bool Wait(int timeout_ms = -1) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+    // kMpsc下被后序记录的提交唤醒时，队首记录可能仍未提交，需继续等待
+    while (!HasData()) {
+      int wait_ms = -1;
+      if (timeout_ms >= 0) {
+        wait_ms = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now())
+                .count());
+        if (wait_ms <= 0)
+          return false;
+      }
+      uint32_t seq = header_->data_seq.load(std::memory_order_acquire);
+      if (ArmNotify())
+        FutexWait(&header_->data_seq, seq, wait_ms);
+      header_->consumer_waiting.store(0, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /// @brief 声明消费者即将休眠，之后的首次提交会唤醒消费者
+  /// @note 配合SetNotifyFd在epoll中等待eventfd：返回true后再进入epoll_wait
+  /// @return 已有可读消息返回false(无需休眠)
+  bool ArmNotify() {
+    header_->consumer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (HasData()) {
+      header_->consumer_waiting.store(0, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief 设置生产者侧的eventfd，唤醒消费者时额外写入该fd
+  /// @note eventfd由消费者创建并与段描述符一起传给生产者进程；不接管fd
+  /// @param event_fd -1为只使用futex
+  void SetNotifyFd(int event_fd) { notify_fd_ = event_fd; }
+
+public:
+  /// @brief 是否有已提交未消费的消息
+  bool HasData() const {
+    uint64_t read = header_->read_pos.load(std::memory_order_relaxed);
+    if (header_->mode == static_cast<uint32_t>(ShmRingMode::kMpsc))
+      return RecordWord(data_ + (read & mask_))
+                 ->load(std::memory_order_acquire) &
+             kCommitBit;
+    return header_->commit_pos.load(std::memory_order_acquire) != read;
+  }
+
+  /// @brief 已预留未消费的字节数(含记录头，并发下仅供参考)
+  size_t Length() const {
+    return static_cast<size_t>(
+        header_->write_pos.load(std::memory_order_acquire) -
+        header_->read_pos.load(std::memory_order_acquire));
+  }
+
+  /// @brief 数据区容量
+  size_t Capacity() const { return mask_ + 1; }
+
+  /// @brief 单条消息的最大负载
+  size_t MaxMessageSize() const {
+    return std::min<size_t>(Capacity() - kRecordHeader, kCommitBit - 1);
+  }
+
+  /// @brief 段描述符，可经SCM_RIGHTS传给其他进程后Attach
+  int Fd() const { return fd_; }
+
+  /// @brief 生产者模式
+  ShmRingMode Mode() const { return static_cast<ShmRingMode>(header_->mode); }
+
+private:
+  static constexpr uint32_t kMagic = 0x53524e47; // "SRNG"
+  static constexpr size_t kCacheLine = 64;
+  static constexpr int kSpinBeforeWait = 256;
+  static constexpr uint32_t kCommitBit = 0x80000000u;
+
+  /// @brief 控制头，位于段首页，各游标分处不同缓存行
+  struct Header {
+    uint32_t magic;
+    uint32_t mode;
+    uint64_t capacity;
+    alignas(kCacheLine) std::atomic<uint64_t> write_pos;  // 生产者预留
+    alignas(kCacheLine) std::atomic<uint64_t> commit_pos; // kSpsc已提交
+    alignas(kCacheLine) std::atomic<uint64_t> read_pos;   // 消费者已释放
+    alignas(kCacheLine) std::atomic<uint32_t> data_seq;   // futex: 新数据
+    std::atomic<uint32_t> consumer_waiting;
+    alignas(kCacheLine) std::atomic<uint32_t> space_seq;  // futex: 新空间
+    std::atomic<uint32_t> producers_waiting;
+  };
+  static_assert(sizeof(Header) <= kHeaderPage, "header exceeds first page");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "shared cursors must be lock free");
+
+  explicit ShmRing(int fd) : fd_(fd) {}
+
+  /// @brief 映射控制头与两份连续的数据区
+  bool Map(size_t size) {
+    const size_t total = kHeaderPage + 2 * size;
+    void *area = mmap(nullptr, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1, 0);
+    if (area == MAP_FAILED) {
+      LOGP_ERROR("shm ring reserve failed,errno:%d", errno);
+      return false;
+    }
+    uint8_t *base = static_cast<uint8_t *>(area);
+    if (mmap(base, kHeaderPage + size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd_, 0) == MAP_FAILED ||
+        mmap(base + kHeaderPage + size, size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd_, kHeaderPage) == MAP_FAILED) {
+      LOGP_ERROR("shm ring map failed,errno:%d", errno);
+      munmap(area, total);
+      return false;
+    }
+    base_ = base;
+    header_ = reinterpret_cast<Header *>(base);
+    data_ = base + kHeaderPage;
+    mask_ = size - 1;
+    return true;
+  }
+
+  /// @brief kMpsc记录头：负载长度|提交位
+  static std::atomic<uint32_t> *RecordWord(uint8_t *record) {
+    return reinterpret_cast<std::atomic<uint32_t> *>(record);
+  }
+
+  static uint64_t RecordSize(size_t size) {
+    return (kRecordHeader + size + 7) & ~static_cast<uint64_t>(7);
+  }
+
+  /// @brief 释放已消费的空间并唤醒等待空间的生产者
+  void Release(uint64_t read) {
+    header_->read_pos.store(read, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->producers_waiting.load(std::memory_order_relaxed)) {
+      header_->space_seq.fetch_add(1, std::memory_order_release);
+      FutexWake(&header_->space_seq);
+    }
+  }
+
+  void WakeConsumer() {
+    // 只有一个生产者负责唤醒
+    if (!header_->consumer_waiting.exchange(0, std::memory_order_acq_rel))
+      return;
+    header_->data_seq.fetch_add(1, std::memory_order_release);
+    FutexWake(&header_->data_seq);
+    if (notify_fd_ >= 0) {
+      uint64_t one = 1;
+      ssize_t ret = write(notify_fd_, &one, sizeof(one));
+      (void)ret;
+    }
+  }
+
+  /// @brief 跨进程futex(非PRIVATE)
+  static void FutexWait(std::atomic<uint32_t> *addr, uint32_t expected,
+                        int timeout_ms) {
+    timespec ts;
+    timespec *timeout = nullptr;
+    if (timeout_ms >= 0) {
+      ts.tv_sec = timeout_ms / 1000;
+      ts.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000;
+      timeout = &ts;
+    }
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT,
+            expected, timeout, nullptr, 0);
+  }
+
+  static void FutexWake(std::atomic<uint32_t> *addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+  }
+
+  int fd_ = -1;
+  int notify_fd_ = -1;
+  uint8_t *base_ = nullptr;
+  Header *header_ = nullptr;
+  uint8_t *data_ = nullptr;
+  size_t mask_ = 0;
+};
+
+} // namespace containers
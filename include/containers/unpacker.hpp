@@ -6,7 +6,8 @@
 namespace containers {
 
 /** 解析字节数回调:外部定义自定义解析逻辑
- * *head_ptr:解析数据头指针
+ * *head_ptr:解析数据头指针，至多可读UnPacker::kMaxHeadPeek(64)字节，
+ *   尚未收到的字节为0；head_size不超过64时，头部收全前不会据此判定包长
  * &head_size:获取头大小
  * &data_size:获取头尾之外数据大小
  * &tail_size:获取尾数据大小
@@ -25,11 +26,21 @@ using HeadKey = std::vector<uint8_t>;
 // 尾定位符
 using TailKey = std::vector<uint8_t>;
 
+// 每次读取都会触发的调试日志，默认不编译，需要时以-DNEBULA_UNPACKER_TRACE开启
+#if defined(NEBULA_UNPACKER_TRACE)
+#define UNPACKER_TRACE(fmt, ...) LOGP_DEBUG(fmt, ##__VA_ARGS__)
+#else
+#define UNPACKER_TRACE(fmt, ...)
+#endif
+
 class UnPacker : public RingBuffer {
   enum UnPackerResult { kSuccess = 0, kError = -1 };
   enum UnpackerModel { kNone, kHead, kHeadTail, KHeadTailCb };
 
 public:
+  // 数据长度回调可读取的最大头部字节数
+  static constexpr size_t kMaxHeadPeek = 64;
+
   static std::unique_ptr<UnPacker> CreateBasic(HeadKey &&h, TailKey &&t,
                                                size_t s) {
 
@@ -70,8 +81,8 @@ public:
     }
     size_t write_size =
         Write(reinterpret_cast<const std::byte *>(write_data), data_size);
-    LOGP_DEBUG("write_ret:%d,AvailableToRead:%d", write_size,
-               AvailableToRead());
+    UNPACKER_TRACE("write_ret:%d,AvailableToRead:%d", write_size,
+                   AvailableToRead());
     if (read_data.size() > 0)
       read_data.clear(); // 清空容器留存包，避免重复处理
     GetPack(read_data);
@@ -82,12 +93,27 @@ public:
   /// @param read_data
   /// @return
   size_t Get(std::vector<std::vector<uint8_t>> &read_data) {
-    LOGP_DEBUG("Get Pack,AvailableToRead:%d", AvailableToRead());
+    UNPACKER_TRACE("Get Pack,AvailableToRead:%d", AvailableToRead());
     if (read_data.size() > 0)
       read_data.clear(); // 清空容器留存包，避免重复处理
     return GetPack(read_data);
   };
 
+  /// @brief 尾定位符不匹配或校验失败而丢弃的候选包个数
+  /// @return
+  uint64_t InvalidCount() const { return invalid_count_; }
+
+  /// @brief 设置回调模式下允许的最大包长，用于缓冲区可扩容的场景
+  /// @param max_packet_size 0为当前缓冲区大小(默认)
+  void SetMaxPacketSize(size_t max_packet_size) {
+    max_packet_size_ = max_packet_size;
+  }
+
+  /// @brief 上次解析时读位置上未收全的包长(仅回调模式可知)，0为未知或无
+  /// @note 大于缓冲区大小时需扩容才能收全
+  /// @return
+  size_t PendingPacketSize() const { return pending_packet_size_; }
+
 private:
   /// @brief
   /// @param head_key
@@ -119,6 +145,7 @@ private:
   /// @param read_data
   /// @return UnPackerResult
   UnPackerResult GetPack(std::vector<std::vector<uint8_t>> &read_data) {
+    pending_packet_size_ = 0;
 
     // 仅头定位符（包含头定位符）
     if (unpacker_model_ == UnpackerModel::kHead) {
@@ -141,104 +168,73 @@ private:
 
   /// @brief 在环形缓冲区中查找关键字节序列
   /// @param find_key 要查找的关键字节序列
-  /// @param start_index 起始搜索位置（绝对位置）
+  /// @param start_offset 起始搜索位置（相对读位置）
   /// @return 找到返回相对位置，未找到返回缓冲区大小
   size_t FindKey(const std::vector<uint8_t> &find_key,
                  size_t start_offset = 0) {
-    if (find_key.empty() || find_key.size() > AvailableToRead() ||
-        start_offset >= AvailableToRead()) {
-      return buffer_.size(); // 无效参数
-    }
-
     const size_t key_len = find_key.size();
     const size_t total_size = AvailableToRead();
-
-    // 计算绝对起始位置（考虑环回）
-    const size_t abs_start = (read_index_ + start_offset) % buffer_.size();
-
-    // 可能的两部分（如果环回）
-    size_t part1_size =
-        std::min(buffer_.size() - abs_start, total_size - start_offset);
-    size_t part2_size = total_size - start_offset - part1_size;
-
-    // 检查第一部分
-    for (size_t i = 0; i <= part1_size - key_len; ++i) {
-      bool match = true;
-      for (size_t j = 0; j < key_len; ++j) {
-        if (buffer_[(abs_start + i + j) % buffer_.size()] != find_key[j]) {
-          match = false;
-          break;
-        }
-      }
-      if (match) {
-        return start_offset + i; // 返回相对位置
-      }
+    if (key_len == 0 || key_len > total_size || start_offset >= total_size) {
+      return buffer_.size(); // 无效参数
     }
 
-    // 检查第二部分（如果有）
-    if (part2_size >= key_len) {
-      for (size_t i = 0; i <= part2_size - key_len; ++i) {
-        bool match = true;
-        for (size_t j = 0; j < key_len; ++j) {
-          if (buffer_[i + j] != find_key[j]) {
-            match = false;
-            break;
-          }
-        }
-        if (match) {
-          return start_offset + part1_size + i;
-        }
-      }
+    // 逐位置比较，关键字可跨越环回边界
+    const size_t size = buffer_.size();
+    for (size_t i = start_offset; i + key_len <= total_size; ++i) {
+      const size_t abs = (read_index_ + i) % size;
+      if (buffer_[abs] != find_key[0])
+        continue;
+      size_t j = 1;
+      while (j < key_len && buffer_[(abs + j) % size] == find_key[j])
+        ++j;
+      if (j == key_len)
+        return i; // 返回相对位置
     }
 
     return buffer_.size(); // 未找到
   }
 
 private:
+  /// @brief 拷贝出相对读位置offset起size字节的数据包(处理环回)
+  std::vector<uint8_t> CopyPacket(size_t offset, size_t size) {
+    std::vector<uint8_t> packet(size);
+    const size_t abs_head = (read_index_ + offset) % buffer_.size();
+    const size_t to_end = buffer_.size() - abs_head;
+    const size_t part1_size = std::min(size, to_end);
+    memcpy(packet.data(), buffer_.data() + abs_head, part1_size);
+    if (size > part1_size) {
+      memcpy(packet.data() + part1_size, buffer_.data(), size - part1_size);
+    }
+    return packet;
+  }
+
+  /// @brief 查找头定位符，丢弃其之前无法成包的字节
+  /// @return 找到返回true，此时头位于读位置
+  bool SeekHead() {
+    size_t head_offset = FindKey(head_key_, 0);
+    if (head_offset == buffer_.size()) {
+      // 保留可能是半个头定位符的尾部字节
+      size_t keep = std::min(AvailableToRead(), head_key_.size() - 1);
+      CommitReadSize(AvailableToRead() - keep);
+      return false;
+    }
+    CommitReadSize(head_offset);
+    return true;
+  }
+
   /// @brief 仅头定位符分包模式
   /// @param read_data
   /// @return UnPackerResult
   UnPackerResult
   ProcessHeadOnlyMode(std::vector<std::vector<uint8_t>> &read_data) {
-    size_t current_pos = 0;
-    const size_t total_size = AvailableToRead(); // 保存当前可读数据总量
-    while (current_pos < total_size) {
-      // 查找头定位符
-      size_t head_offset = FindKey(head_key_, current_pos);
-      if (head_offset == buffer_.size())
-        break;
-
-      // 从头部后开始查找下一个头
-      size_t next_head_offset =
-          FindKey(head_key_, head_offset + head_key_.size());
+    while (SeekHead()) {
+      // 从头部后开始查找下一个头，包为当前头到下一个头之间的数据
+      size_t next_head_offset = FindKey(head_key_, head_key_.size());
       if (next_head_offset == buffer_.size())
         break;
 
-      // 计算包大小（从当前头到下一个头）
-      size_t packet_size = next_head_offset - head_offset;
-
-      // 提取数据包
-      std::vector<uint8_t> packet(packet_size);
-      const size_t abs_head = (read_index_ + head_offset) % buffer_.size();
-
-      // 计算线性拷贝部分
-      const size_t to_end = buffer_.size() - abs_head;
-      const size_t part1_size = std::min(packet_size, to_end);
-
-      // 拷贝第一部分
-      memcpy(packet.data(), buffer_.data() + abs_head, part1_size);
-
-      // 处理环回部分
-      if (packet_size > part1_size) {
-        memcpy(packet.data() + part1_size, buffer_.data(),
-               packet_size - part1_size);
-      }
-
-      read_data.push_back(std::move(packet));
-      current_pos = head_offset + packet_size; // 移动到当前包结束位置
-
-      // 提交读取
-      CommitReadSize(packet_size);
+      read_data.push_back(CopyPacket(0, next_head_offset));
+      CommitReadSize(next_head_offset);
     }
     return UnPackerResult::kSuccess;
   };
@@ -248,43 +244,15 @@ private:
   /// @return UnPackerResult
   UnPackerResult
   ProcessHeadTailMode(std::vector<std::vector<uint8_t>> &read_data) {
-    size_t current_pos = 0;
-    const size_t total_size = AvailableToRead(); // 保存当前可读数据总量
-    while (current_pos < total_size) {
-      // 查找头定位符
-      size_t head_offset = FindKey(head_key_, current_pos);
-      if (head_offset == buffer_.size())
-        break; // 找不到头
-
+    while (SeekHead()) {
       // 从头部后开始查找尾
-      size_t tail_offset = FindKey(tail_key_, head_offset + head_key_.size());
+      size_t tail_offset = FindKey(tail_key_, head_key_.size());
       if (tail_offset == buffer_.size())
-        break; // 找不到尾
-
-      // 计算包尺寸（包括头尾）
-      size_t packet_size = tail_offset + tail_key_.size() - head_offset;
-
-      // 提取数据包
-      std::vector<uint8_t> packet(packet_size);
-      const size_t abs_head = (read_index_ + head_offset) % buffer_.size();
-
-      // 计算线性复制部分
-      const size_t to_end = buffer_.size() - abs_head;
-      const size_t part1_size = std::min(packet_size, to_end);
+        break; // 找不到尾，等待更多数据
 
-      // 复制第一部分
-      memcpy(packet.data(), buffer_.data() + abs_head, part1_size);
-
-      // 如果有环回部分
-      if (packet_size > part1_size) {
-        memcpy(packet.data() + part1_size, buffer_.data(),
-               packet_size - part1_size);
-      }
-
-      read_data.push_back(std::move(packet));
-      current_pos = tail_offset + tail_key_.size(); // 移动当前位置
-
-      // 提交读取
+      // 包尺寸（包括头尾）
+      size_t packet_size = tail_offset + tail_key_.size();
+      read_data.push_back(CopyPacket(0, packet_size));
       CommitReadSize(packet_size);
     }
 
@@ -296,64 +264,71 @@ private:
   /// @return UnPackerResult
   UnPackerResult
   ProcessHeadTailAndCbMode(std::vector<std::vector<uint8_t>> &read_data) {
-    size_t current_pos = 0;
-    const size_t total_size = AvailableToRead();
-
-    while (current_pos < total_size) {
-      // 查找头定位符
-      size_t head_offset = FindKey(head_key_, current_pos);
-      if (head_offset == buffer_.size())
-        break;
-
+    std::vector<uint8_t> head_copy;
+    while (SeekHead()) {
       // 应用回调获取包结构
-      const size_t abs_head = (read_index_ + head_offset) % buffer_.size();
       size_t head_size = 0, data_size = 0, tail_size = 0;
-      data_sz_cb_(buffer_.data() + abs_head, head_size, data_size, tail_size);
-
+      data_sz_cb_(PeekHead(head_copy), head_size, data_size, tail_size);
       size_t packet_size = head_size + data_size + tail_size;
 
-      // 验证包尺寸合理性
+      // 头部未收全时长度字段读到的是补零字节，等待头部收全再判定
+      if (head_size > AvailableToRead() && head_size <= kMaxHeadPeek) {
+        pending_packet_size_ = head_size;
+        break;
+      }
+
+      // 验证包尺寸合理性，超过最大包长的包视为误匹配的头
+      const size_t max_packet_size =
+          max_packet_size_ ? max_packet_size_ : buffer_.size();
       if (head_size < head_key_.size() || tail_size < tail_key_.size() ||
-          head_offset + packet_size > total_size) {
-        current_pos = head_offset + 1; // 移动到下一个字节
+          packet_size > max_packet_size) {
+        ++invalid_count_;
+        CommitReadSize(1); // 移动到下一个字节
         continue;
       }
+      if (packet_size > AvailableToRead()) {
+        pending_packet_size_ = packet_size;
+        break; // 数据不完整，等待更多数据
+      }
 
       // 验证尾定位符位置
-      size_t expected_tail_offset = head_offset + head_size + data_size;
-      size_t tail_offset = FindKey(tail_key_, expected_tail_offset);
-
-      // 尾定位符不匹配
-      if (tail_offset != expected_tail_offset) {
-        current_pos = head_offset + 1;
+      size_t expected_tail_offset = head_size + data_size;
+      if (FindKey(tail_key_, expected_tail_offset) != expected_tail_offset) {
+        ++invalid_count_;
+        CommitReadSize(1);
         continue;
       }
 
-      // 创建完整包
-      std::vector<uint8_t> packet(packet_size);
-      const size_t to_end = buffer_.size() - abs_head;
-      const size_t part1_size = std::min(packet_size, to_end);
-
-      memcpy(packet.data(), buffer_.data() + abs_head, part1_size);
-
-      if (packet_size > part1_size) {
-        memcpy(packet.data() + part1_size, buffer_.data(),
-               packet_size - part1_size);
-      }
-
-      // 应用校验
+      // 创建完整包并应用校验
+      std::vector<uint8_t> packet = CopyPacket(0, packet_size);
       if (!check_sz_cb_ || check_sz_cb_(packet.data())) {
         read_data.push_back(std::move(packet));
-        current_pos = head_offset + packet_size;
         CommitReadSize(packet_size);
       } else {
-        current_pos = head_offset + 1; // 校验失败，移动到下一个字节
+        ++invalid_count_;
+        CommitReadSize(1); // 校验失败，移动到下一个字节
       }
     }
 
     return kSuccess;
   }
 
+  /// @brief 取得交给数据长度回调的头部指针
+  /// @note 回调按线性内存读取至多kMaxHeadPeek字节。头部靠近缓冲区末尾或
+  /// 已收数据不足kMaxHeadPeek时拷贝到head_copy，未到达的字节补零，
+  /// 回调不会越过缓冲区末尾，也不会读到上一轮残留的数据
+  /// @param head_copy 拷贝用的暂存区
+  /// @return
+  const uint8_t *PeekHead(std::vector<uint8_t> &head_copy) {
+    const size_t available = AvailableToRead();
+    if (buffer_.size() - read_index_ >= kMaxHeadPeek &&
+        available >= kMaxHeadPeek)
+      return buffer_.data() + read_index_;
+    head_copy = CopyPacket(0, std::min(available, kMaxHeadPeek));
+    head_copy.resize(kMaxHeadPeek, 0);
+    return head_copy.data();
+  }
+
 private:
   HeadKey head_key_{};
   TailKey tail_key_{};
@@ -361,6 +336,9 @@ private:
   DataSzCb data_sz_cb_ = nullptr;
   CheckValidCb check_sz_cb_ = nullptr;
   UnpackerModel unpacker_model_ = UnpackerModel::kNone;
+  uint64_t invalid_count_ = 0;
+  size_t max_packet_size_ = 0;
+  size_t pending_packet_size_ = 0;
 };
 
 } // namespace containers
\ No newline at end of file
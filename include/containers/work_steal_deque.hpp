@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace containers {
+
+/// @brief 无界工作窃取双端队列(Chase-Lev)
+/// @note 所有者线程在底部Push/Pop(后进先出，缓存友好)，其他线程从顶部
+/// Steal(先进先出)。按C11内存模型实现(Lê等，PPoPP'13)。扩容时旧数组
+/// 保留到析构，窃取方可能仍在读取，避免回收问题
+/// @tparam T 需可平凡拷贝(通常为指针)
+template <typename T> class WorkStealDeque {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "WorkStealDeque element must be trivially copyable");
+
+  struct Array {
+    explicit Array(int64_t size)
+        : capacity(size), mask(size - 1), slots(new std::atomic<T>[size]) {}
+
+    T Get(int64_t index) const {
+      return slots[index & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t index, T value) {
+      slots[index & mask].store(value, std::memory_order_relaxed);
+    }
+
+    int64_t capacity;
+    int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+public:
+  /// @brief 指定初始容量构造
+  /// @param capacity 向上取整为2的幂
+  explicit WorkStealDeque(size_t capacity = 256) {
+    int64_t size = 2;
+    while (size < static_cast<int64_t>(capacity))
+      size <<= 1;
+    arrays_.emplace_back(std::make_unique<Array>(size));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealDeque(const WorkStealDeque &) = delete;
+  WorkStealDeque &operator=(const WorkStealDeque &) = delete;
+
+  /// @brief 底部入队，仅所有者线程调用，满时扩容
+  /// @param value
+  void Push(T value) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array *array = array_.load(std::memory_order_relaxed);
+    if (b - t > array->capacity - 1)
+      array = Grow(array, t, b);
+    array->Put(b, value);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  /// @brief 底部出队，仅所有者线程调用
+  /// @param value
+  /// @return 空返回false
+  bool Pop(T &value) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array *array = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = array->Get(b);
+    if (t == b) {
+      // 最后一个元素，与窃取方竞争
+      bool won = top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  /// @brief 顶部窃取，任意线程调用
+  /// @param value
+  /// @return 空或与其他线程竞争失败返回false
+  bool Steal(T &value) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+    Array *array = array_.load(std::memory_order_acquire);
+    T item = array->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      return false;
+    value = item;
+    return true;
+  }
+
+  /// @brief 近似元素个数(并发下仅供参考)
+  /// @return
+  size_t SizeApprox() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  /// @brief 是否为空(并发下仅供参考)
+  /// @return
+  bool IsEmpty() const { return SizeApprox() == 0; }
+
+  /// @brief 当前数组容量
+  /// @return
+  size_t Capacity() const {
+    return static_cast<size_t>(
+        array_.load(std::memory_order_relaxed)->capacity);
+  }
+
+private:
+  Array *Grow(Array *old, int64_t top, int64_t bottom) {
+    auto array = std::make_unique<Array>(old->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i)
+      array->Put(i, old->Get(i));
+    Array *raw = array.get();
+    arrays_.push_back(std::move(array));
+    array_.store(raw, std::memory_order_release);
+    return raw;
+  }
+
+  static constexpr size_t kCacheLine = 64;
+
+  // 窃取方只写top，所有者主要写bottom，分处不同缓存行
+  alignas(kCacheLine) std::atomic<int64_t> top_{0};
+  alignas(kCacheLine) std::atomic<int64_t> bottom_{0};
+  std::atomic<Array *> array_{nullptr};
+  std::vector<std::unique_ptr<Array>> arrays_; // 仅所有者线程修改
+};
+
+} // namespace containers
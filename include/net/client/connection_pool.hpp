@@ -0,0 +1,244 @@
+#pragma once
+#include "../core/reactor_core.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+
+/// @brief 连接池参数
+struct PoolOptions {
+  size_t max_conns_per_key = 8;       // 每个后端的最大连接数(含建连中)
+  size_t max_idle_per_key = 8;        // 每个后端保留的最大空闲连接数
+  uint64_t acquire_timeout_ms = 5000; // 等待可用连接的超时，0为不限
+  uint64_t backoff_initial_ms = 100;  // 建连失败后的首次重试间隔
+  uint64_t backoff_max_ms = 10000;    // 重试间隔上限(指数退避)
+  ConnectOptions connect;             // 建连参数，on_close由连接池接管
+};
+
+/// @brief 获取连接回调，在循环线程执行
+/// @param conn_id 成功时为可独占使用的连接，用完后需Release
+/// @param error 0为成功，否则为errno(等待超时为ETIMEDOUT)
+using AcquireCb = std::function<void(ConnId conn_id, int error)>;
+
+/// @brief 按后端地址分组的出站连接池
+/// 连接由ReactorCore::Connect建立并在同一个事件循环上收发，空闲连接后进先出复用；
+/// 建连失败按指数退避重试，等待者在超时前持续排队
+/// @note 状态只在循环线程访问，公开接口线程安全；连接池需在事件循环停止后析构
+class ConnectionPool {
+public:
+  ConnectionPool(ReactorCore &reactor, PoolOptions options = PoolOptions())
+      : reactor_(reactor), options_(std::move(options)) {}
+
+  ConnectionPool(const ConnectionPool &) = delete;
+  ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+  /// @brief 获取到后端的连接，结果总是异步回调
+  /// @param host 数字地址
+  /// @param port
+  /// @param cb
+  void Acquire(const std::string &host, uint16_t port, AcquireCb cb) {
+    reactor_.QueueInLoop([this, host, port, cb = std::move(cb)]() mutable {
+      AcquireInLoop(host, port, std::move(cb));
+    });
+  }
+
+  /// @brief 归还连接
+  /// @note 未被借出的连接(如重复归还)忽略，避免同一连接两次进入空闲列表
+  /// @param conn_id
+  /// @param reusable 为false时关闭连接(如协议出错)
+  void Release(ConnId conn_id, bool reusable = true) {
+    reactor_.RunInLoop([this, conn_id, reusable]() {
+      auto it = conns_.find(conn_id);
+      if (it == conns_.end())
+        return; // 已关闭
+      if (!it->second.in_use) {
+        LOGP_WARN("pool release of idle conn:%lu ignored", conn_id);
+        return;
+      }
+      it->second.in_use = false;
+      if (!reusable) {
+        reactor_.Close(conn_id);
+        return;
+      }
+      Hand(endpoints_[it->second.key], conn_id);
+    });
+  }
+
+private:
+  struct Waiter {
+    uint64_t id = 0;
+    AcquireCb cb;
+    threading::TimerId timer = 0;
+    bool timer_armed = false;
+  };
+
+  /// @brief 已建立的连接
+  struct Conn {
+    std::string key;     // 所属后端
+    bool in_use = false; // 已交给等待者，尚未归还
+  };
+
+  struct Endpoint {
+    std::string key;
+    std::string host;
+    uint16_t port = 0;
+    std::vector<ConnId> idle;
+    std::deque<Waiter> waiters;
+    size_t open = 0;       // 已建立与建连中的连接数
+    size_t connecting = 0; // 建连中的连接数
+    uint64_t backoff_ms = 0;
+    uint64_t retry_at_ms = 0;
+    bool retry_scheduled = false;
+  };
+
+  static uint64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void AcquireInLoop(const std::string &host, uint16_t port, AcquireCb cb) {
+    std::string key = host + ":" + std::to_string(port);
+    Endpoint &ep = endpoints_[key];
+    if (ep.key.empty()) {
+      ep.key = key;
+      ep.host = host;
+      ep.port = port;
+    }
+
+    Waiter waiter;
+    waiter.id = ++next_waiter_id_;
+    waiter.cb = std::move(cb);
+    if (options_.acquire_timeout_ms) {
+      uint64_t waiter_id = waiter.id;
+      waiter.timer = reactor_.RunAfter(
+          options_.acquire_timeout_ms,
+          [this, key, waiter_id]() { ExpireWaiter(key, waiter_id); });
+      waiter.timer_armed = true;
+    }
+    ep.waiters.push_back(std::move(waiter));
+    Pump(ep);
+  }
+
+  /// @brief 用空闲连接满足等待者，不足时发起新连接
+  void Pump(Endpoint &ep) {
+    while (!ep.waiters.empty() && !ep.idle.empty()) {
+      ConnId conn_id = ep.idle.back();
+      ep.idle.pop_back();
+      Serve(ep, conn_id);
+    }
+    while (ep.waiters.size() > ep.connecting &&
+           ep.open < options_.max_conns_per_key) {
+      if (!StartConnect(ep))
+        break;
+    }
+  }
+
+  /// @brief 发起连接，处于退避期时安排重试并返回false
+  bool StartConnect(Endpoint &ep) {
+    uint64_t now = NowMs();
+    if (now < ep.retry_at_ms) {
+      if (!ep.retry_scheduled) {
+        ep.retry_scheduled = true;
+        std::string key = ep.key;
+        reactor_.RunAfter(ep.retry_at_ms - now, [this, key]() {
+          Endpoint &ep = endpoints_[key];
+          ep.retry_scheduled = false;
+          Pump(ep);
+        });
+      }
+      return false;
+    }
+
+    ep.open++;
+    ep.connecting++;
+    std::string key = ep.key;
+    ConnectOptions options = options_.connect;
+    options.on_close = [this, key](ConnId conn_id) { OnClosed(key, conn_id); };
+    reactor_.Connect(
+        ep.host, ep.port,
+        [this, key](ConnId conn_id, int error) {
+          OnConnected(key, conn_id, error);
+        },
+        std::move(options));
+    return true;
+  }
+
+  void OnConnected(const std::string &key, ConnId conn_id, int error) {
+    Endpoint &ep = endpoints_[key];
+    ep.connecting--;
+    if (error != 0) {
+      ep.open--;
+      ep.backoff_ms =
+          ep.backoff_ms == 0
+              ? options_.backoff_initial_ms
+              : std::min(ep.backoff_ms * 2, options_.backoff_max_ms);
+      ep.retry_at_ms = NowMs() + ep.backoff_ms;
+      LOGP_WARN("pool connect %s failed,errno:%d,retry in %lums", key.c_str(),
+                error, ep.backoff_ms);
+      Pump(ep);
+      return;
+    }
+    ep.backoff_ms = 0;
+    ep.retry_at_ms = 0;
+    conns_[conn_id].key = key;
+    Hand(ep, conn_id);
+  }
+
+  void OnClosed(const std::string &key, ConnId conn_id) {
+    Endpoint &ep = endpoints_[key];
+    conns_.erase(conn_id);
+    ep.open--;
+    auto it = std::find(ep.idle.begin(), ep.idle.end(), conn_id);
+    if (it != ep.idle.end())
+      ep.idle.erase(it);
+    Pump(ep);
+  }
+
+  /// @brief 连接可用：交给等待者或放回空闲列表
+  void Hand(Endpoint &ep, ConnId conn_id) {
+    if (!ep.waiters.empty()) {
+      Serve(ep, conn_id);
+      return;
+    }
+    if (ep.idle.size() >= options_.max_idle_per_key) {
+      reactor_.Close(conn_id);
+      return;
+    }
+    ep.idle.push_back(conn_id);
+  }
+
+  void Serve(Endpoint &ep, ConnId conn_id) {
+    Waiter waiter = std::move(ep.waiters.front());
+    ep.waiters.pop_front();
+    if (waiter.timer_armed)
+      reactor_.CancelTimer(waiter.timer);
+    conns_[conn_id].in_use = true;
+    waiter.cb(conn_id, 0);
+  }
+
+  void ExpireWaiter(const std::string &key, uint64_t waiter_id) {
+    Endpoint &ep = endpoints_[key];
+    auto it = std::find_if(ep.waiters.begin(), ep.waiters.end(),
+                           [waiter_id](const Waiter &w) {
+                             return w.id == waiter_id;
+                           });
+    if (it == ep.waiters.end())
+      return;
+    AcquireCb cb = std::move(it->cb);
+    ep.waiters.erase(it);
+    cb(0, ETIMEDOUT);
+  }
+
+  ReactorCore &reactor_;
+  PoolOptions options_;
+  uint64_t next_waiter_id_ = 0;
+  std::unordered_map<std::string, Endpoint> endpoints_;
+  std::unordered_map<ConnId, Conn> conns_;
+};
+
+} // namespace net
@@ -0,0 +1,149 @@
+#pragma once
+#include "reactor_core.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace net {
+
+/// @brief 跨事件循环的主题广播
+/// @note 订阅按连接所属的事件循环分片保存，每个分片只在其循环线程访问，
+/// 无锁。Publish将消息编码结果包装为一份只读的引用计数缓冲，每个循环投递
+/// 一个任务，由各循环并行向本循环的订阅者追加缓冲引用，内存中每条消息
+/// 只有一份。已关闭的连接在下次发布时惰性移除。
+/// 订阅变更与发布均以QueueInLoop延后执行，彼此保持投递顺序，且关闭回调中
+/// 取消订阅不会使正在进行的发布遍历失效。
+/// 公开接口线程安全；需在所有事件循环停止后析构
+class BroadcastHub {
+public:
+  using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+  /// @brief 构造
+  /// @param reactors 参与广播的事件循环，生命周期需长于本对象
+  explicit BroadcastHub(std::vector<ReactorCore *> reactors) {
+    shards_.reserve(reactors.size());
+    for (ReactorCore *reactor : reactors)
+      shards_.emplace_back(std::make_unique<Shard>(reactor));
+  }
+
+  BroadcastHub(const BroadcastHub &) = delete;
+  BroadcastHub &operator=(const BroadcastHub &) = delete;
+
+  /// @brief 订阅主题，重复订阅无副作用
+  /// @param reactor 连接所属的事件循环，需为构造时传入的之一
+  /// @param topic
+  /// @param conn_id
+  void Subscribe(ReactorCore &reactor, const std::string &topic,
+                 ConnId conn_id) {
+    Shard *shard = FindShard(reactor);
+    if (!shard)
+      return;
+    reactor.QueueInLoop([shard, topic, conn_id]() {
+      Topic &t = shard->topics[topic];
+      if (t.index.emplace(conn_id, t.conns.size()).second)
+        t.conns.push_back(conn_id);
+    });
+  }
+
+  /// @brief 取消订阅
+  /// @param reactor
+  /// @param topic
+  /// @param conn_id
+  void Unsubscribe(ReactorCore &reactor, const std::string &topic,
+                   ConnId conn_id) {
+    Shard *shard = FindShard(reactor);
+    if (!shard)
+      return;
+    reactor.QueueInLoop([shard, topic, conn_id]() {
+      auto it = shard->topics.find(topic);
+      if (it == shard->topics.end())
+        return;
+      Remove(it->second, conn_id);
+      if (it->second.conns.empty())
+        shard->topics.erase(it);
+    });
+  }
+
+  /// @brief 向主题的所有订阅者发送同一份缓冲
+  /// @param topic
+  /// @param buffer 所有连接发送完成前保持存活，调用方不得修改
+  void Publish(const std::string &topic, Buffer buffer) {
+    OutputChunk chunk = OutputChunk::FromBuffer(std::move(buffer));
+    for (auto &shard : shards_) {
+      Shard *s = shard.get();
+      s->reactor->QueueInLoop(
+          [s, topic, chunk]() { PublishInLoop(*s, topic, chunk); });
+    }
+  }
+
+  /// @brief 向主题的所有订阅者发送数据，只复制一次
+  /// @param topic
+  /// @param data
+  void Publish(const std::string &topic, std::vector<uint8_t> &&data) {
+    Publish(topic, std::make_shared<const std::vector<uint8_t>>(std::move(data)));
+  }
+
+  /// @brief 本循环中主题的订阅者数，仅限该循环线程调用
+  size_t Subscribers(ReactorCore &reactor, const std::string &topic) const {
+    for (const auto &shard : shards_) {
+      if (shard->reactor != &reactor)
+        continue;
+      auto it = shard->topics.find(topic);
+      return it == shard->topics.end() ? 0 : it->second.conns.size();
+    }
+    return 0;
+  }
+
+private:
+  struct Topic {
+    std::vector<ConnId> conns;                 // 连续存放便于遍历
+    std::unordered_map<ConnId, size_t> index;  // 连接在conns中的下标
+  };
+
+  struct Shard {
+    explicit Shard(ReactorCore *r) : reactor(r) {}
+    ReactorCore *reactor;
+    std::unordered_map<std::string, Topic> topics; // 只在循环线程访问
+    std::vector<ConnId> closed;                    // 复用的临时表
+  };
+
+  Shard *FindShard(ReactorCore &reactor) {
+    for (auto &shard : shards_) {
+      if (shard->reactor == &reactor)
+        return shard.get();
+    }
+    LOG_ERROR("broadcast hub: reactor not registered");
+    return nullptr;
+  }
+
+  static void PublishInLoop(Shard &shard, const std::string &topic,
+                            const OutputChunk &chunk) {
+    auto it = shard.topics.find(topic);
+    if (it == shard.topics.end())
+      return;
+    Topic &t = it->second;
+    shard.closed.clear();
+    shard.reactor->BroadcastInLoop(t.conns, chunk, &shard.closed);
+    for (ConnId conn_id : shard.closed)
+      Remove(t, conn_id);
+    if (t.conns.empty())
+      shard.topics.erase(it);
+  }
+
+  /// @brief 与末尾交换后删除，O(1)
+  static void Remove(Topic &t, ConnId conn_id) {
+    auto it = t.index.find(conn_id);
+    if (it == t.index.end())
+      return;
+    size_t pos = it->second;
+    t.index.erase(it);
+    if (pos + 1 != t.conns.size()) {
+      t.conns[pos] = t.conns.back();
+      t.index[t.conns[pos]] = pos;
+    }
+    t.conns.pop_back();
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace net
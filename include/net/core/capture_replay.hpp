@@ -0,0 +1,222 @@
+#pragma once
+#include "../transport/protocol_handler.hpp"
+#include "traffic_capture.hpp"
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+namespace net {
+
+/// @brief 回放参数
+struct ReplayOptions {
+  bool original_pacing = false; // 按抓包时的时间间隔回放，否则全速
+  double speed = 1.0;           // 按原始节奏回放时的倍速
+  ConnId only_conn = 0;         // 非0时只回放该连接
+  size_t max_packet_size = 0;   // ToUnPacker缓冲区扩容上限，0为不扩容
+};
+
+/// @brief 回放统计
+struct ReplayStats {
+  uint64_t records = 0;  // 回放的接收记录数
+  uint64_t bytes = 0;    // 回放的字节数
+  uint64_t packets = 0;  // 解析出的包数(ToUnPacker)
+  uint64_t invalid = 0;  // 解包器丢弃的候选包数(ToUnPacker)
+  uint64_t rejected = 0; // 包长超过扩容上限而丢弃的记录数(ToUnPacker)
+  uint64_t elapsed_ns = 0;
+};
+
+/// @brief 抓包回放驱动
+/// @note 按原始接收分段依次送入解析器，用真实的分段方式基准测试UnPacker
+/// 与协议处理器；全速回放测吞吐，原始节奏回放复现突发与空闲
+class CaptureReplay {
+public:
+  /// @brief 按连接创建解包器
+  using UnPackerFactory =
+      std::function<std::unique_ptr<containers::UnPacker>()>;
+
+  /// @brief 按连接创建协议处理器
+  /// @param fd 回放用的本地套接字(流式记录为SOCK_STREAM，数据报为SOCK_DGRAM)
+  /// @param kind
+  using HandlerMaker = std::function<std::unique_ptr<ProtocolHandler>(
+      int fd, CaptureKind kind)>;
+
+  /// @param reader 生命周期需长于本对象
+  /// @param options
+  CaptureReplay(const CaptureReader &reader,
+                ReplayOptions options = ReplayOptions())
+      : reader_(reader), options_(options) {}
+
+  /// @brief 逐条回放记录
+  /// @param cb void(const CaptureRecord &)
+  /// @return
+  template <typename F> ReplayStats Run(F &&cb) const {
+    ReplayStats stats;
+    auto start = std::chrono::steady_clock::now();
+    reader_.ForEach([&](const CaptureRecord &record) {
+      if (options_.only_conn && record.conn_id != options_.only_conn)
+        return true;
+      if (options_.original_pacing && options_.speed > 0) {
+        auto due = start + std::chrono::nanoseconds(static_cast<uint64_t>(
+                               record.time_ns / options_.speed));
+        std::this_thread::sleep_until(due);
+      }
+      cb(record);
+      stats.records++;
+      stats.bytes += record.size;
+      return true;
+    });
+    stats.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    return stats;
+  }
+
+  /// @brief 回放到每个连接独立的解包器，读取与解析方式同TcpHandler/UdpHandler
+  /// @note 缓冲区按ReplayOptions::max_packet_size扩容，未收全的包无法容纳时
+  /// 丢弃已缓冲数据与该记录剩余部分
+  /// @param make
+  /// @param on_packets 可为空，为空时只计数
+  /// @return
+  ReplayStats ToUnPacker(const UnPackerFactory &make,
+                         const ConnExecCb &on_packets = nullptr) const {
+    std::unordered_map<ConnId, std::unique_ptr<containers::UnPacker>> unpackers;
+    std::vector<std::vector<uint8_t>> packs;
+    uint64_t packets = 0, rejected = 0;
+    ReplayStats stats = Run([&](const CaptureRecord &record) {
+      auto &unpacker = unpackers[record.conn_id];
+      if (!unpacker) {
+        unpacker = make();
+        // 同TcpHandler::SetRecvBufferPolicy，允许声明长度超过当前容量的包
+        if (options_.max_packet_size > unpacker->Capacity())
+          unpacker->SetMaxPacketSize(options_.max_packet_size);
+      }
+      auto deliver = [&]() {
+        packets += packs.size();
+        if (on_packets && !packs.empty())
+          on_packets(record.conn_id, packs);
+      };
+
+      if (record.kind == CaptureKind::kDatagram) {
+        // 每个数据报独立解包
+        unpacker->Clear();
+        if (record.size)
+          unpacker->PushAndGet(record.data, record.size, packs);
+        deliver();
+        return;
+      }
+      for (size_t offset = 0; offset < record.size;) {
+        auto [buffer, capacity] = unpacker->GetLinearWriteSpace();
+        if (capacity == 0) {
+          // 未收全的包超过缓冲区，同TcpHandler扩容，已达上限时丢弃
+          size_t current = unpacker->Capacity();
+          if (current >= options_.max_packet_size) {
+            unpacker->Clear();
+            rejected++;
+            break;
+          }
+          unpacker->Resize(std::min(current * 2, options_.max_packet_size));
+          continue;
+        }
+        size_t n = std::min(capacity, record.size - offset);
+        memcpy(buffer, record.data + offset, n);
+        unpacker->CommitWriteSize(n);
+        offset += n;
+        unpacker->Get(packs);
+        deliver();
+      }
+    });
+    stats.packets = packets;
+    stats.rejected = rejected;
+    for (const auto &[conn_id, unpacker] : unpackers)
+      stats.invalid += unpacker->InvalidCount();
+    return stats;
+  }
+
+  /// @brief 回放到真实的协议处理器
+  /// @note 每个连接对应一对本地套接字，记录写入一端后以可读事件驱动处理器，
+  /// 处理器按自身缓冲区读取；处理器发出的响应写入本地套接字后丢弃
+  /// @param make
+  /// @param dispatcher 处理器派发批次的目标
+  /// @return
+  ReplayStats ToHandlers(const HandlerMaker &make,
+                         PacketDispatcher &dispatcher) const {
+    std::unordered_map<ConnId, Endpoint> endpoints;
+    ReplayStats stats = Run([&](const CaptureRecord &record) {
+      auto it = endpoints.find(record.conn_id);
+      if (it == endpoints.end()) {
+        Endpoint endpoint;
+        if (!endpoint.Open(record.kind, make))
+          return;
+        it = endpoints.emplace(record.conn_id, std::move(endpoint)).first;
+      }
+      Endpoint &endpoint = it->second;
+      if (!endpoint.handler)
+        return; // 处理器已要求关闭
+      Event event{endpoint.fds[0], EventFlags::kReadable, record.conn_id};
+      for (size_t offset = 0;
+           offset < record.size || (record.size == 0 && offset == 0);) {
+        ssize_t n = send(endpoint.fds[1], record.data + offset,
+                         record.size - offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+          break;
+        if (n > 0)
+          offset += static_cast<size_t>(n);
+        endpoint.handler->HandleEvent(-1, event, dispatcher);
+        endpoint.Drain();
+        if (endpoint.handler->ShouldClose()) {
+          endpoint.handler.reset();
+          break;
+        }
+        if (record.size == 0)
+          break;
+      }
+    });
+    return stats;
+  }
+
+private:
+  /// @brief 回放用的本地套接字对与处理器
+  struct Endpoint {
+    int fds[2] = {-1, -1}; // 0:处理器端 1:回放写入端
+    std::unique_ptr<ProtocolHandler> handler;
+
+    Endpoint() = default;
+    Endpoint(Endpoint &&other) noexcept : handler(std::move(other.handler)) {
+      fds[0] = other.fds[0];
+      fds[1] = other.fds[1];
+      other.fds[0] = other.fds[1] = -1;
+    }
+    Endpoint &operator=(Endpoint &&) = delete;
+
+    ~Endpoint() {
+      handler.reset();
+      for (int fd : fds) {
+        if (fd >= 0)
+          close(fd);
+      }
+    }
+
+    bool Open(CaptureKind kind, const HandlerMaker &make) {
+      int type = kind == CaptureKind::kDatagram ? SOCK_DGRAM : SOCK_STREAM;
+      if (socketpair(AF_UNIX, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) !=
+          0) {
+        LOGP_ERROR("replay socketpair failed,errno:%d", errno);
+        return false;
+      }
+      handler = make(fds[0], kind);
+      return handler != nullptr;
+    }
+
+    /// @brief 丢弃处理器写回的响应，避免本地套接字写满
+    void Drain() {
+      uint8_t sink[16 * 1024];
+      while (recv(fds[1], sink, sizeof(sink), MSG_DONTWAIT) > 0) {
+      }
+    }
+  };
+
+  const CaptureReader &reader_;
+  ReplayOptions options_;
+};
+
+} // namespace net
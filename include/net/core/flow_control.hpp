@@ -0,0 +1,133 @@
+#pragma once
+#include "packet_dispatcher.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace net {
+
+/// @brief 读侧流控参数，0表示不限制
+/// @note 在途批次达到上限时暂停读取，回落到上限一半时恢复
+struct FlowLimits {
+  uint32_t conn_max_inflight = 0;   // 单连接在途批次上限
+  uint64_t global_max_inflight = 0; // 全局(单个ReactorCore)在途批次上限
+};
+
+/// @brief 读侧流控
+/// 事件循环派发批次时计数，工作线程执行完毕时回减；
+/// 达到上限时由事件循环暂停该fd的EPOLLIN，回落后通知事件循环恢复
+class FlowControl : public std::enable_shared_from_this<FlowControl> {
+public:
+  /// @brief 单连接流控状态，随批次交给工作线程
+  class ConnFlow : public BatchTracker {
+  public:
+    ConnFlow(std::shared_ptr<FlowControl> control, ConnId conn_id)
+        : control_(std::move(control)), conn_id_(conn_id) {}
+
+    /// @brief 事件循环派发前计数
+    void OnDispatch() {
+      inflight_.fetch_add(1, std::memory_order_seq_cst);
+      control_->global_inflight_.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    /// @brief 工作线程执行完批次后回减
+    void OnBatchDone() override {
+      inflight_.fetch_sub(1, std::memory_order_seq_cst);
+      control_->OnBatchDone(*this);
+    }
+
+    /// @brief 是否达到上限需要暂停读取
+    bool Saturated() const { return control_->Saturated(*this); }
+
+    ConnId Id() const { return conn_id_; }
+    uint32_t Inflight() const {
+      return inflight_.load(std::memory_order_seq_cst);
+    }
+
+  private:
+    friend class FlowControl;
+    std::shared_ptr<FlowControl> control_;
+    ConnId conn_id_;
+    std::atomic<uint32_t> inflight_{0};
+    std::atomic<bool> paused_{false};
+  };
+
+  /// @brief 构造
+  /// @param limits
+  /// @param notify 需要恢复读取时调用(工作线程上)，应唤醒事件循环
+  FlowControl(const FlowLimits &limits, std::function<void(void)> notify)
+      : limits_(limits), notify_(std::move(notify)) {}
+
+  std::shared_ptr<ConnFlow> CreateConnFlow(ConnId conn_id) {
+    return std::make_shared<ConnFlow>(shared_from_this(), conn_id);
+  }
+
+  /// @brief 是否达到上限需要暂停读取
+  bool Saturated(const ConnFlow &flow) const {
+    return (limits_.conn_max_inflight &&
+            flow.Inflight() >= limits_.conn_max_inflight) ||
+           (limits_.global_max_inflight &&
+            GlobalInflight() >= limits_.global_max_inflight);
+  }
+
+  /// @brief 是否已回落到可恢复读取的水位
+  bool CanResume(const ConnFlow &flow) const {
+    return (!limits_.conn_max_inflight ||
+            flow.Inflight() <= limits_.conn_max_inflight / 2) &&
+           (!limits_.global_max_inflight ||
+            GlobalInflight() <= limits_.global_max_inflight / 2);
+  }
+
+  /// @brief 事件循环标记暂停
+  /// @return 标记后若已可恢复(工作线程在标记前已全部完成)返回false
+  bool MarkPaused(ConnFlow &flow) {
+    flow.paused_.store(true, std::memory_order_seq_cst);
+    paused_count_.fetch_add(1, std::memory_order_seq_cst);
+    if (CanResume(flow)) {
+      MarkResumed(flow);
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief 事件循环标记恢复
+  void MarkResumed(ConnFlow &flow) {
+    if (flow.paused_.exchange(false, std::memory_order_seq_cst))
+      paused_count_.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+  /// @brief 事件循环处理恢复请求前调用，之后的回落会再次触发通知
+  void ClearResumeRequest() {
+    resume_requested_.store(false, std::memory_order_seq_cst);
+  }
+
+  uint64_t GlobalInflight() const {
+    return global_inflight_.load(std::memory_order_seq_cst);
+  }
+  uint64_t PausedCount() const {
+    return paused_count_.load(std::memory_order_seq_cst);
+  }
+  const FlowLimits &Limits() const { return limits_; }
+
+private:
+  /// @brief 工作线程回减后判断是否需要通知恢复
+  void OnBatchDone(ConnFlow &flow) {
+    global_inflight_.fetch_sub(1, std::memory_order_seq_cst);
+    bool conn_ready = flow.paused_.load(std::memory_order_seq_cst) &&
+                      CanResume(flow);
+    bool global_ready = limits_.global_max_inflight &&
+                        paused_count_.load(std::memory_order_seq_cst) > 0 &&
+                        GlobalInflight() <= limits_.global_max_inflight / 2;
+    if ((conn_ready || global_ready) &&
+        !resume_requested_.exchange(true, std::memory_order_seq_cst))
+      notify_();
+  }
+
+  FlowLimits limits_;
+  std::function<void(void)> notify_;
+  std::atomic<uint64_t> global_inflight_{0};
+  std::atomic<uint64_t> paused_count_{0};
+  std::atomic<bool> resume_requested_{false};
+};
+
+} // namespace net
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+namespace net {
+
+/// @brief 投递到事件循环线程执行的任务
+using LoopTask = std::function<void(void)>;
+
+/// @brief 跨线程投递到事件循环的任务队列
+/// @note 通过eventfd唤醒epoll；连续投递只写一次eventfd。
+/// 由共享指针持有，事件循环销毁后投递方仍可安全调用，任务不会再被执行
+class LoopTaskQueue {
+public:
+  LoopTaskQueue() {
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ == -1)
+      throw std::runtime_error("eventfd failed");
+  }
+
+  ~LoopTaskQueue() {
+    if (event_fd_ >= 0)
+      close(event_fd_);
+  }
+
+  LoopTaskQueue(const LoopTaskQueue &) = delete;
+  LoopTaskQueue &operator=(const LoopTaskQueue &) = delete;
+
+  /// @brief 投递任务，线程安全
+  /// @param task
+  void Post(LoopTask task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    Wakeup();
+  }
+
+  /// @brief 唤醒事件循环(已有未处理唤醒时不重复写fd)
+  void Wakeup() {
+    if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+      uint64_t one = 1;
+      ssize_t n = write(event_fd_, &one, sizeof(one));
+      (void)n;
+    }
+  }
+
+  /// @brief 事件循环线程调用：清空eventfd并执行全部任务
+  /// @return 执行的任务数
+  size_t Drain() {
+    uint64_t count = 0;
+    ssize_t n = read(event_fd_, &count, sizeof(count));
+    (void)n;
+    wakeup_pending_.store(false, std::memory_order_release);
+
+    // 交换出任务列表，执行期间新投递的任务留到下一轮
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_.swap(tasks_);
+    }
+    size_t executed = running_.size();
+    for (auto &task : running_)
+      task();
+    running_.clear();
+    return executed;
+  }
+
+  /// @brief 供epoll注册的eventfd
+  /// @return
+  int Fd() const { return event_fd_; }
+
+private:
+  int event_fd_ = -1;
+  std::atomic<bool> wakeup_pending_{false};
+  std::mutex mutex_;
+  std::vector<LoopTask> tasks_;
+  std::vector<LoopTask> running_;
+};
+
+} // namespace net
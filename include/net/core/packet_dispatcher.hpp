@@ -0,0 +1,465 @@
+#pragma once
+#include "../../containers/mpmc_queue.hpp"
+#include "../transport/enums.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace net {
+
+/// @brief 业务执行回调类型定义
+/// @param packs 解析后的数据包
+using ExecCb = std::function<void(std::vector<std::vector<uint8_t>> &packs)>;
+
+/// @brief 携带来源连接的业务回调，可用于经ReactorCore::Send回包
+/// @param conn_id 来源连接
+/// @param packs 解析后的数据包
+using ConnExecCb = std::function<void(
+    ConnId conn_id, std::vector<std::vector<uint8_t>> &packs)>;
+
+/// @brief 经AF_UNIX连接收到文件描述符时的回调
+/// @param conn_id 来源连接
+/// @param fds 按到达顺序排列，所有权归回调，先于同一批次的数据包执行
+using FdRecvCb = std::function<void(ConnId conn_id, std::vector<int> &fds)>;
+
+/// @brief UDP数据报，保留对端地址与数据报边界
+struct Datagram {
+  sockaddr_storage peer{};
+  socklen_t peer_len = 0;
+  std::vector<uint8_t> payload;
+  std::vector<int> fds; // SCM_RIGHTS描述符(仅AF_UNIX)，收到时所有权归回调
+};
+
+/// @brief UDP数据报业务回调
+/// @param fd 接收套接字，可直接用于回包
+/// @param datagrams 本批次收到的数据报
+using UdpExecCb =
+    std::function<void(int fd, std::vector<Datagram> &datagrams)>;
+
+/// @brief 批次完成通知，工作线程执行完批次后调用(用于流控计数)
+class BatchTracker {
+public:
+  virtual void OnBatchDone() = 0;
+  virtual ~BatchTracker() = default;
+};
+
+/// @brief 事件循环派发给工作线程的数据包批次
+/// @note 按值移动入队，工作线程独占所有权，不与连接共享缓冲；携带的描述符
+/// 执行时移交回调，未执行即丢弃(如停止时)的批次在析构时关闭
+struct PacketBatch {
+  ConnId conn_id = 0;               // 来源连接
+  std::shared_ptr<const ExecCb> cb; // 业务回调
+  std::shared_ptr<const ConnExecCb> conn_cb; // 携带连接ID的业务回调
+  std::vector<std::vector<uint8_t>> packs;
+  std::shared_ptr<const UdpExecCb> udp_cb; // UDP数据报回调
+  std::vector<Datagram> datagrams;
+  std::shared_ptr<const FdRecvCb> fd_cb; // 描述符回调
+  std::vector<int> fds;
+  std::shared_ptr<BatchTracker> tracker; // 完成通知，可为空
+
+  PacketBatch() = default;
+  PacketBatch(PacketBatch &&) noexcept = default;
+  PacketBatch &operator=(PacketBatch &&other) noexcept {
+    if (this == &other)
+      return *this;
+    CloseFds();
+    conn_id = other.conn_id;
+    cb = std::move(other.cb);
+    conn_cb = std::move(other.conn_cb);
+    packs = std::move(other.packs);
+    udp_cb = std::move(other.udp_cb);
+    datagrams = std::move(other.datagrams);
+    fd_cb = std::move(other.fd_cb);
+    fds = std::move(other.fds);
+    tracker = std::move(other.tracker);
+    other.fds.clear();
+    other.datagrams.clear();
+    return *this;
+  }
+  ~PacketBatch() { CloseFds(); }
+
+  bool Empty() const {
+    return ((!cb && !conn_cb) || packs.empty()) &&
+           (!udp_cb || datagrams.empty()) && (!fd_cb || fds.empty());
+  }
+
+  void Run() {
+    if (fd_cb && !fds.empty()) {
+      (*fd_cb)(conn_id, fds);
+      fds.clear(); // 所有权已归回调
+    }
+    if (cb && !packs.empty())
+      (*cb)(packs);
+    if (conn_cb && !packs.empty())
+      (*conn_cb)(conn_id, packs);
+    if (udp_cb && !datagrams.empty()) {
+      (*udp_cb)(ConnIdToFd(conn_id), datagrams);
+      for (auto &datagram : datagrams)
+        datagram.fds.clear();
+    }
+    if (tracker)
+      tracker->OnBatchDone();
+  }
+
+private:
+  /// @brief 关闭尚未移交回调的描述符
+  void CloseFds() {
+    for (int fd : fds)
+      close(fd);
+    fds.clear();
+    for (auto &datagram : datagrams) {
+      for (int fd : datagram.fds)
+        close(fd);
+      datagram.fds.clear();
+    }
+  }
+};
+
+/// @brief 派发策略
+enum class DispatchPolicy : uint8_t {
+  kRoundRobin = 0, // 投递到任一有空位的队列，同一连接的批次可能并发、乱序执行
+  kShardByConn,    // 按连接ID固定到一个工作线程，连接内按派发顺序执行
+  kShardByKey,     // 按用户提取的键逐包路由，同键按派发顺序执行
+};
+
+/// @brief 分片键提取回调，在派发线程(事件循环)上调用
+/// @param conn_id 来源连接
+/// @param data 单个数据包或数据报负载
+/// @param size
+using ShardKeyCb = std::function<uint64_t(ConnId conn_id, const uint8_t *data,
+                                          size_t size)>;
+
+/// @brief 数据包派发器
+/// 事件循环直接把批次投递到工作线程的无锁队列，工作线程空闲时才休眠，
+/// 只有对方休眠时生产者才需要加锁唤醒
+class PacketDispatcher {
+  struct Worker {
+    Worker(size_t capacity, size_t shard) : queue(capacity), index(shard) {}
+    containers::MpmcQueue<PacketBatch> queue;
+    // 工作线程投递时队列已满的批次，在队列取空后按序执行
+    std::deque<PacketBatch> overflow;
+    std::mutex overflow_mutex;
+    std::atomic<size_t> overflow_size{0};
+    size_t index;
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+  };
+
+public:
+  /// @brief 指定工作线程数与每个线程的队列容量构造
+  /// @param worker_count
+  /// @param queue_capacity
+  explicit PacketDispatcher(
+      size_t worker_count = std::thread::hardware_concurrency(),
+      size_t queue_capacity = 1024) {
+    if (worker_count == 0)
+      worker_count = 1;
+    for (size_t i = 0; i < worker_count; ++i)
+      workers_.emplace_back(std::make_unique<Worker>(queue_capacity, i));
+    for (auto &worker : workers_)
+      worker->thread = std::thread(&PacketDispatcher::WorkerLoop, this,
+                                   worker.get());
+  }
+
+  ~PacketDispatcher() {
+    running_.store(false);
+    for (auto &worker : workers_) {
+      {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+      }
+      worker->cv.notify_one();
+    }
+    for (auto &worker : workers_) {
+      if (worker->thread.joinable())
+        worker->thread.join();
+    }
+  }
+
+  /// @brief 设置派发策略，需在开始派发前调用
+  /// @note 分片策略下同一键的批次总由同一工作线程按派发顺序执行，键相关的
+  /// 状态可按CurrentShard()分片存放而无需加锁。目标队列满时派发线程等待
+  /// 而不是代为执行，以免破坏顺序；工作线程在回调中派发时不等待，批次转入
+  /// 目标分片的溢出队列，排在已入队的批次之后。慢键会拖慢同分片的其他键
+  /// @param policy
+  /// @param key_cb kShardByKey时必填，为空则退化为kShardByConn
+  void SetPolicy(DispatchPolicy policy, ShardKeyCb key_cb = nullptr) {
+    if (policy == DispatchPolicy::kShardByKey && !key_cb)
+      policy = DispatchPolicy::kShardByConn;
+    policy_ = policy;
+    key_cb_ = std::move(key_cb);
+  }
+
+  DispatchPolicy Policy() const { return policy_; }
+
+  /// @brief 派发批次，所有权转移给工作线程
+  /// @note 轮询策略下所有队列均满时在调用线程直接执行，形成天然背压
+  /// @param batch
+  void Dispatch(PacketBatch &&batch) {
+    if (batch.Empty())
+      return;
+
+    if (policy_ == DispatchPolicy::kShardByConn) {
+      PushToShard(ShardOf(batch.conn_id), std::move(batch));
+      return;
+    }
+    if (policy_ == DispatchPolicy::kShardByKey) {
+      DispatchByKey(std::move(batch));
+      return;
+    }
+
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      Worker &worker = *workers_[(start + i) % workers_.size()];
+      if (worker.queue.TryPush(std::move(batch))) {
+        Wake(worker);
+        return;
+      }
+    }
+    caller_runs_.fetch_add(1, std::memory_order_relaxed);
+    batch.Run();
+  }
+
+  /// @brief 工作线程数
+  /// @return
+  size_t WorkerCount() const { return workers_.size(); }
+
+  /// @brief 所有工作线程队列中的批次数(近似)
+  /// @return
+  size_t QueueDepthApprox() const {
+    size_t depth = 0;
+    for (const auto &worker : workers_)
+      depth += worker->queue.SizeApprox();
+    return depth;
+  }
+
+  /// @brief 因队列满而在调用线程执行的批次数
+  /// @return
+  uint64_t CallerRuns() const {
+    return caller_runs_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief 分片派发时目标队列满而等待的次数
+  /// @return
+  uint64_t ShardStalls() const {
+    return shard_stalls_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief 工作线程派发时转入溢出队列的批次数
+  /// @return
+  uint64_t ShardOverflows() const {
+    return shard_overflows_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief 键所属的分片(工作线程下标)
+  /// @param key 连接ID或ShardKeyCb返回的键
+  /// @return
+  size_t ShardOf(uint64_t key) const {
+    // 混合高低位，使连接ID中的fd与代数都参与分布
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key % workers_.size());
+  }
+
+  /// @brief 当前线程所在的分片
+  /// @return 非本派发器的工作线程返回kNoShard
+  size_t CurrentShard() const {
+    const WorkerContext &context = Context();
+    return context.owner == this ? context.shard : kNoShard;
+  }
+
+  static constexpr size_t kNoShard = SIZE_MAX;
+
+private:
+  /// @brief 工作线程身份，用于CurrentShard与避免向自身队列阻塞投递
+  struct WorkerContext {
+    const PacketDispatcher *owner = nullptr;
+    size_t shard = kNoShard;
+  };
+
+  static WorkerContext &Context() {
+    thread_local WorkerContext context;
+    return context;
+  }
+
+  /// @brief 拆分后的子批次全部执行完才通知一次原批次的跟踪器
+  class SplitTracker : public BatchTracker {
+  public:
+    SplitTracker(std::shared_ptr<BatchTracker> inner, size_t parts)
+        : inner_(std::move(inner)), remaining_(parts) {}
+
+    void OnBatchDone() override {
+      if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        inner_->OnBatchDone();
+    }
+
+  private:
+    std::shared_ptr<BatchTracker> inner_;
+    std::atomic<size_t> remaining_;
+  };
+
+  /// @brief 投递到指定分片，队列满时等待
+  /// @note 工作线程互相投递时等待会相互阻塞，改为追加到溢出队列；溢出队列
+  /// 非空时后续投递也追加到其后，保持同一派发线程的顺序
+  void PushToShard(size_t shard, PacketBatch &&batch) {
+    Worker &worker = *workers_[shard];
+    if (CurrentShard() != kNoShard) {
+      if (worker.overflow_size.load(std::memory_order_acquire) != 0 ||
+          !worker.queue.TryPush(std::move(batch))) {
+        shard_overflows_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(worker.overflow_mutex);
+        worker.overflow.push_back(std::move(batch));
+        worker.overflow_size.store(worker.overflow.size(),
+                                   std::memory_order_release);
+      }
+      Wake(worker);
+      return;
+    }
+    // 溢出队列取空前同样等待，使溢出批次不被持续入队的批次饿死
+    auto pushed = [&] {
+      return worker.overflow_size.load(std::memory_order_acquire) == 0 &&
+             worker.queue.TryPush(std::move(batch));
+    };
+    if (!pushed()) {
+      shard_stalls_.fetch_add(1, std::memory_order_relaxed);
+      do {
+        Wake(worker);
+        std::this_thread::yield();
+      } while (!pushed());
+    }
+    Wake(worker);
+  }
+
+  /// @brief 队列取空后再取溢出批次，保证溢出批次排在先入队的批次之后
+  bool PopOverflow(Worker &worker, PacketBatch &batch) {
+    if (worker.overflow_size.load(std::memory_order_acquire) == 0)
+      return false;
+    std::lock_guard<std::mutex> lock(worker.overflow_mutex);
+    if (worker.overflow.empty())
+      return false;
+    batch = std::move(worker.overflow.front());
+    worker.overflow.pop_front();
+    worker.overflow_size.store(worker.overflow.size(),
+                               std::memory_order_release);
+    return true;
+  }
+
+  /// @brief 按键逐包路由，同一批次落在多个分片时拆分
+  void DispatchByKey(PacketBatch &&batch) {
+    thread_local std::vector<size_t> pack_shards, datagram_shards;
+    pack_shards.clear();
+    datagram_shards.clear();
+    for (const auto &pack : batch.packs)
+      pack_shards.push_back(
+          ShardOf(key_cb_(batch.conn_id, pack.data(), pack.size())));
+    for (const auto &datagram : batch.datagrams)
+      datagram_shards.push_back(ShardOf(key_cb_(
+          batch.conn_id, datagram.payload.data(), datagram.payload.size())));
+
+    // 描述符随首个数据包，保持先于数据包执行；没有数据包时按连接路由
+    size_t first = !pack_shards.empty()       ? pack_shards.front()
+                   : !datagram_shards.empty() ? datagram_shards.front()
+                                              : ShardOf(batch.conn_id);
+    auto same = [first](size_t shard) { return shard == first; };
+    if (std::all_of(pack_shards.begin(), pack_shards.end(), same) &&
+        std::all_of(datagram_shards.begin(), datagram_shards.end(), same)) {
+      PushToShard(first, std::move(batch));
+      return;
+    }
+
+    std::vector<PacketBatch> parts(workers_.size());
+    for (auto &part : parts) {
+      part.conn_id = batch.conn_id;
+      part.cb = batch.cb;
+      part.conn_cb = batch.conn_cb;
+      part.udp_cb = batch.udp_cb;
+      part.fd_cb = batch.fd_cb;
+    }
+    parts[first].fds = std::move(batch.fds);
+    for (size_t i = 0; i < batch.packs.size(); ++i)
+      parts[pack_shards[i]].packs.push_back(std::move(batch.packs[i]));
+    for (size_t i = 0; i < batch.datagrams.size(); ++i)
+      parts[datagram_shards[i]].datagrams.push_back(
+          std::move(batch.datagrams[i]));
+
+    size_t count = 0;
+    for (const auto &part : parts)
+      count += part.Empty() ? 0 : 1;
+    std::shared_ptr<BatchTracker> tracker =
+        batch.tracker ? std::make_shared<SplitTracker>(
+                            std::move(batch.tracker), count)
+                      : nullptr;
+    for (size_t shard = 0; shard < parts.size(); ++shard) {
+      if (parts[shard].Empty())
+        continue;
+      parts[shard].tracker = tracker;
+      PushToShard(shard, std::move(parts[shard]));
+    }
+  }
+
+  void Wake(Worker &worker) {
+    // 与WorkerLoop中的sleeping/队列检查构成Dekker式配对，防止丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed)) {
+      {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+      }
+      worker.cv.notify_one();
+    }
+  }
+
+  /// @brief 工作线程主循环：先自旋后休眠
+  void WorkerLoop(Worker *worker) {
+    static constexpr int kSpinRounds = 64;
+    Context() = WorkerContext{this, worker->index};
+    PacketBatch batch;
+    while (true) {
+      bool got = false;
+      for (int i = 0; i < kSpinRounds && !got; ++i) {
+        got = worker->queue.TryPop(batch) || PopOverflow(*worker, batch);
+        if (!got)
+          std::this_thread::yield();
+      }
+
+      if (got) {
+        batch.Run();
+        batch = PacketBatch();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(worker->mutex);
+      worker->sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto idle = [&] {
+        return worker->queue.IsEmpty() &&
+               worker->overflow_size.load(std::memory_order_acquire) == 0;
+      };
+      worker->cv.wait(lock, [&] { return !running_.load() || !idle(); });
+      worker->sleeping.store(false, std::memory_order_relaxed);
+      if (!running_.load() && idle())
+        return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_{0};
+  std::atomic<uint64_t> caller_runs_{0};
+  std::atomic<uint64_t> shard_stalls_{0};
+  std::atomic<uint64_t> shard_overflows_{0};
+  DispatchPolicy policy_ = DispatchPolicy::kRoundRobin;
+  ShardKeyCb key_cb_;
+  std::atomic<bool> running_{true};
+};
+
+} // namespace net
@@ -0,0 +1,152 @@
+#pragma once
+#include "../../logger/logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+// 旧版内核头文件缺少的定义(Linux 5.11 / 6.9)
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+#ifndef EPIOCSPARAMS
+struct epoll_params {
+  uint32_t busy_poll_usecs;
+  uint16_t busy_poll_budget;
+  uint8_t prefer_busy_poll;
+  uint8_t __pad;
+};
+#define EPOLL_IOC_TYPE 0x8A
+#define EPIOCSPARAMS _IOW(EPOLL_IOC_TYPE, 0x01, struct epoll_params)
+#endif
+
+namespace net {
+
+/// @brief 事件循环轮询策略，默认直接阻塞等待
+struct PollOptions {
+  uint64_t spin_us = 0;          // 阻塞前以零超时轮询的最长时间，0为不自旋
+  uint32_t busy_poll_us = 0;     // SO_BUSY_POLL与epoll忙轮询时长，0为不开启
+  uint16_t busy_poll_budget = 0; // 单次忙轮询处理的最大包数，0为内核默认
+  bool prefer_busy_poll = false; // SO_PREFER_BUSY_POLL，忙轮询期间抑制软中断
+  int cpu = -1;                  // 循环线程绑定的CPU，-1为不绑定
+};
+
+/// @brief 自适应轮询等待
+/// 先以零超时epoll_wait自旋，自旋期间命中事件则恢复完整预算，
+/// 落空则预算减半直至退化为直接阻塞；阻塞后很快被唤醒说明流量回升，预算再次加倍
+/// @note 单线程使用(由事件循环独占)
+class AdaptivePoller {
+public:
+  void SetOptions(const PollOptions &options) {
+    options_ = options;
+    spin_budget_us_ = options.spin_us;
+  }
+
+  const PollOptions &Options() const { return options_; }
+
+  /// @brief 当前自旋预算(us)
+  /// @return
+  uint64_t SpinBudgetUs() const { return spin_budget_us_; }
+
+  /// @brief 等待事件
+  /// @return 同epoll_wait
+  int Wait(int epoll_fd, epoll_event *events, int max_events,
+           const std::atomic<bool> &running) {
+    if (options_.spin_us == 0)
+      return epoll_wait(epoll_fd, events, max_events, -1);
+
+    if (spin_budget_us_ > 0) {
+      auto deadline = Clock::now() + std::chrono::microseconds(spin_budget_us_);
+      do {
+        int n = epoll_wait(epoll_fd, events, max_events, 0);
+        if (n != 0) {
+          if (n > 0)
+            spin_budget_us_ = options_.spin_us;
+          return n;
+        }
+        CpuRelax();
+      } while (Clock::now() < deadline && running.load(std::memory_order_relaxed));
+      spin_budget_us_ /= 2;
+    }
+
+    auto block_start = Clock::now();
+    int n = epoll_wait(epoll_fd, events, max_events, -1);
+    if (n > 0 && Clock::now() - block_start <
+                     std::chrono::microseconds(options_.spin_us)) {
+      spin_budget_us_ =
+          std::min(options_.spin_us, std::max(spin_budget_us_ * 2, kMinSpinUs));
+    }
+    return n;
+  }
+
+  /// @brief 为epoll实例开启忙轮询(Linux 6.9+，不支持时忽略)
+  /// @param epoll_fd
+  /// @return
+  bool ApplyEpollParams(int epoll_fd) const {
+    if (options_.busy_poll_us == 0)
+      return true;
+    epoll_params params{};
+    params.busy_poll_usecs = options_.busy_poll_us;
+    params.busy_poll_budget = options_.busy_poll_budget;
+    params.prefer_busy_poll = options_.prefer_busy_poll ? 1 : 0;
+    return ioctl(epoll_fd, EPIOCSPARAMS, &params) == 0;
+  }
+
+  /// @brief 为套接字设置忙轮询选项
+  /// @param fd
+  /// @return
+  bool ApplySocketOptions(int fd) const {
+    if (options_.busy_poll_us == 0)
+      return true;
+    bool ok = true;
+    int value = static_cast<int>(options_.busy_poll_us);
+    ok &= setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) == 0;
+    if (options_.prefer_busy_poll) {
+      value = 1;
+      ok &= setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &value,
+                       sizeof(value)) == 0;
+    }
+    if (options_.busy_poll_budget) {
+      value = options_.busy_poll_budget;
+      ok &= setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &value,
+                       sizeof(value)) == 0;
+    }
+    return ok;
+  }
+
+  /// @brief 将调用线程绑定到配置的CPU
+  /// @return
+  bool PinCurrentThread() const {
+    if (options_.cpu < 0)
+      return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(options_.cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr uint64_t kMinSpinUs = 8;
+
+  static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  PollOptions options_;
+  uint64_t spin_budget_us_ = 0;
+};
+
+} // namespace net
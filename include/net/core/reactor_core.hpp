@@ -1,39 +1,143 @@
 #pragma once
 #include "../../logger/logger.hpp"
+#include "../../threading/timing_wheel.hpp"
 #include "../transport/enums.hpp"
 #include "../transport/protocol_handler.hpp"
+#include "../transport/socket_creator.hpp"
+#include "flow_control.hpp"
+#include "loop_task_queue.hpp"
+#include "packet_dispatcher.hpp"
+#include "poll_strategy.hpp"
+#include "reactor_metrics.hpp"
 #include <arpa/inet.h>
 #include <atomic>
 #include <cstring>
 #include <fcntl.h>
 #include <memory>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdexcept>
+#include <string>
 #include <sys/epoll.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace net {
 
+/// @brief 连接超时配置(ms)，0表示不启用
+struct ConnTimeouts {
+  uint64_t idle_timeout_ms = 0;  // 读写均无活动
+  uint64_t read_timeout_ms = 0;  // 无数据可读
+  uint64_t write_timeout_ms = 0; // 有待发送数据但无写进展
+};
+
+/// @brief 新连接回调，在循环线程执行
+/// @param conn_id accept得到的连接
+using AcceptCb = std::function<void(ConnId conn_id)>;
+
+/// @brief 主动连接结果回调，在循环线程执行
+/// @param conn_id 成功时为新连接ID
+/// @param error 0为成功，否则为errno
+using ConnectCb = std::function<void(ConnId conn_id, int error)>;
+
+/// @brief 连接关闭回调，在循环线程执行
+using CloseCb = std::function<void(ConnId conn_id)>;
+
+/// @brief 主动连接参数
+struct ConnectOptions {
+  uint64_t timeout_ms = 3000; // 建连超时，0为不限
+  bool no_delay = true;       // TCP_NODELAY
+  ConnTimeouts timeouts;      // 建立后的连接超时
+  ConnExecCb exec_cb;         // 响应回调，为空时使用SetConnExecCallback的回调
+  CloseCb on_close;           // 建立后的连接关闭时回调
+  RecvBufferPolicy buffer_policy; // 接收缓冲区容量策略
+};
+
 class ReactorCore {
+  /// @brief fd槽位类型
+  enum class SlotType : uint8_t {
+    kFree,
+    kTimer,
+    kWakeup,
+    kListener,
+    kConnecting,
+    kConnection,
+    kDraining // 已关闭的连接，等待零拷贝完成通知后释放fd
+  };
+
+  /// @brief fd索引的连接槽位
+  struct ConnSlot {
+    std::unique_ptr<ProtocolHandler> handler;
+    uint32_t generation = 0; // fd关闭时递增，用于识别过期事件
+    SlotType type = SlotType::kFree;
+
+    // 超时管理：活动时只刷新时间戳，定时器到期时再惰性重排
+    ConnTimeouts timeouts;
+    uint64_t last_read_ms = 0;
+    uint64_t last_write_ms = 0;
+    threading::TimerId timeout_timer = 0;
+    bool timer_armed = false;
+
+    // 读侧流控：下游饱和时从epoll中摘除EPOLLIN
+    std::shared_ptr<FlowControl::ConnFlow> flow;
+    uint32_t epoll_events = 0;
+    bool read_paused = false;
+
+    // 读取预算用尽，等待就绪列表轮转补读
+    bool read_pending = false;
+
+    // 接收缓冲区策略：监听fd为其accept的连接继承的策略，连接fd为解析后的策略
+    RecvBufferPolicy buffer_policy;
+
+    // 监听fd：accept的连接使用的处理器工厂，为空时使用TcpHandler
+    HandlerFactory handler_factory;
+
+    // 主动连接
+    ConnectCb connect_cb;
+    CloseCb close_cb;
+  };
+
 public:
   ReactorCore(uint64_t max_events = 64) : max_events_(max_events) {
     epoll_fd_ = epoll_create1(0);
     if (epoll_fd_ == -1)
       throw std::runtime_error("epoll_create failed");
+
+    // 定时器fd与IO事件共用同一个epoll
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ == -1)
+      throw std::runtime_error("timerfd_create failed");
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = OccupySlot(timer_fd_, SlotType::kTimer, nullptr);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev) == -1)
+      throw std::runtime_error("epoll_ctl ADD timerfd");
+
+    // 跨线程任务队列的eventfd，同样由epoll唤醒
+    task_queue_ = std::make_shared<LoopTaskQueue>();
+    ev.data.u64 = OccupySlot(task_queue_->Fd(), SlotType::kWakeup, nullptr);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, task_queue_->Fd(), &ev) == -1)
+      throw std::runtime_error("epoll_ctl ADD eventfd");
     LOGP_MSG("ReactorCore initialized with max_events: %lu", max_events);
   }
 
   ~ReactorCore() {
+    if (timer_fd_ >= 0)
+      close(timer_fd_);
     if (epoll_fd_ >= 0)
       close(epoll_fd_);
 
     // 清理所有处理器
-    for (auto &handler : protocol_handlers_) {
-      close(handler.first);
+    for (size_t fd = 0; fd < slots_.size(); ++fd) {
+      if (slots_[fd].type == SlotType::kListener ||
+          slots_[fd].type == SlotType::kConnecting ||
+          slots_[fd].type == SlotType::kConnection ||
+          slots_[fd].type == SlotType::kDraining)
+        close(static_cast<int>(fd));
     }
   }
 
@@ -41,12 +145,12 @@ public:
   /// @param fd
   /// @param handler
   /// @param is_listener
-  void RegisterProtocol(int fd, std::unique_ptr<ProtocolHandler> handler,
-                        bool is_listener = false) {
+  /// @return 连接ID
+  ConnId RegisterProtocol(int fd, std::unique_ptr<ProtocolHandler> handler,
+                          bool is_listener = false) {
     // 配置epoll事件 水平触发或边缘触发
     epoll_event ev{};
     ev.events = EPOLLIN | EPOLLET;
-    ev.data.fd = fd;
 
     // 设置非阻塞模式
     int flags = fcntl(fd, F_GETFL);
@@ -54,30 +158,47 @@ public:
       throw std::runtime_error("fcntl F_GETFL");
     if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
       throw std::runtime_error("fcntl O_NONBLOCK");
+    poller_.ApplySocketOptions(fd);
+
+    // 存储处理器，epoll携带带代数的连接ID
+    ConnId conn_id = OccupySlot(
+        fd, is_listener ? SlotType::kListener : SlotType::kConnection,
+        std::move(handler));
+    ev.data.u64 = conn_id;
 
     // 添加到epoll
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+      ReleaseSlot(fd);
       throw std::runtime_error("epoll_ctl ADD");
+    }
+    slots_[fd].epoll_events = ev.events;
+    if (!is_listener) {
+      AttachFlow(fd);
+      slots_[fd].handler->SetReadBudget(read_budget_);
+    }
 
-    // 存储处理器
-    protocol_handlers_[fd] = std::move(handler);
-
-    // 标记监听套接字
     if (is_listener) {
-      listeners_.insert(fd);
       LOGP_MSG("Registered LISTENER on fd:%d", fd);
     } else {
       LOGP_MSG("Registered CONNECTION on fd:%d", fd);
     }
+    return conn_id;
   }
 
   /// @brief 事件循环机制
   void Run() {
     epoll_event events[max_events_];
-    timer_shceduler_->Start();
+    if (!dispatcher_)
+      dispatcher_ = std::make_shared<PacketDispatcher>();
+    loop_thread_id_ = std::this_thread::get_id();
+    if (!poller_.PinCurrentThread())
+      LOGP_WARN("Failed to pin loop thread to cpu:%d", poller_.Options().cpu);
     while (running_) {
-      // 等待事件
-      int nfds = epoll_wait(epoll_fd_, events, max_events_, -1);
+      ArmTimerFd();
+      // 等待事件(按轮询策略自旋或阻塞)，有待补读的连接或延后任务时只取已就绪事件
+      int nfds = ready_conns_.empty() && deferred_tasks_.empty()
+                     ? poller_.Wait(epoll_fd_, events, max_events_, running_)
+                     : epoll_wait(epoll_fd_, events, max_events_, 0);
       if (nfds == -1) {
         if (errno == EINTR)
           continue; // 信号中断，重新等待
@@ -85,56 +206,355 @@ public:
         break;
       }
 
-      LOGP_MSG("Processing %d events", nfds);
+      // 本轮活动时间戳，避免每个事件读一次时钟
+      const uint64_t loop_start_ns = NowNs();
+      loop_now_ms_ = loop_start_ns / 1000000;
+      metrics_.wakeups.Add();
+      metrics_.events.Add(nfds);
+      metrics_.events_per_wakeup.Record(nfds);
+      metrics_.dispatch_depth.Record(dispatcher_->QueueDepthApprox());
 
+      uint64_t event_start_ns = loop_start_ns;
       for (int i = 0; i < nfds; ++i) {
-        int fd = events[i].data.fd;
-        uint32_t revents = events[i].events;
-
-        // 构造事件对象
-        Event ev;
-        ev.fd = fd;
-        ev.event_flags = static_cast<EventFlags>(0); // 初始化为无事件
-
-        if (revents & EPOLLIN)
-          ev.event_flags =
-              static_cast<EventFlags>(ev.event_flags | EventFlags::kReadable);
-        if (revents & EPOLLOUT)
-          ev.event_flags =
-              static_cast<EventFlags>(ev.event_flags | EventFlags::kWritable);
-        if (revents & EPOLLERR)
-          ev.event_flags =
-              static_cast<EventFlags>(ev.event_flags | EventFlags::kError);
-        if (revents & EPOLLHUP)
-          ev.event_flags =
-              static_cast<EventFlags>(ev.event_flags | EventFlags::kHangUp);
-
-        // 如果是监听套接字（TCP）
-        if (listeners_.find(fd) != listeners_.end()) {
+        const ConnId conn_id = events[i].data.u64;
+        const int fd = ConnIdToFd(conn_id);
+
+        // 槽位代数不一致：同一批事件中fd已关闭或被复用
+        ConnSlot &slot = slots_[fd];
+        if (slot.generation != ConnIdToGeneration(conn_id))
+          continue;
+
+        switch (slot.type) {
+        case SlotType::kTimer: // 定时器到期，在循环线程内执行回调
+          HandleTimerExpired();
+          break;
+        case SlotType::kWakeup: // 其他线程投递的任务
+          metrics_.loop_tasks.Add(task_queue_->Drain());
+          break;
+        case SlotType::kListener: // TCP监听套接字
           HandleNewConnections(fd);
+          break;
+        case SlotType::kConnecting: // 主动连接完成或失败
+          HandleConnectEvent(fd, conn_id);
+          break;
+        case SlotType::kConnection: {
+          HandleConnEvent(fd, conn_id, events[i].events);
+          uint64_t now_ns = NowNs();
+          metrics_.handler_ns.Record(now_ns - event_start_ns);
+          event_start_ns = now_ns;
           continue;
         }
-
-        // 查找处理器
-        auto it = protocol_handlers_.find(fd);
-        if (it != protocol_handlers_.end()) {
-          try {
-            it->second->HandleEvent(epoll_fd_, ev, timer_shceduler_);
-          } catch (const std::exception &e) {
-            LOGP_MSG("Error handling fd:%d - %s", fd, e.what());
-            UnregisterFd(fd);
-          }
-
-          // 检查连接是否需要关闭
-          if (it->second->ShouldClose()) {
-            UnregisterFd(fd);
-          }
+        case SlotType::kDraining: // 零拷贝完成通知
+          if (slot.handler->ReapZeroCopy() == 0)
+            FinishDrain(fd);
+          break;
+        case SlotType::kFree:
+          break;
         }
+        event_start_ns = NowNs();
       }
+      ServiceReadyConns();
+      RunDeferredTasks();
+      metrics_.loop_latency_ns.Record(NowNs() - loop_start_ns);
+    }
+  }
+
+  /// @brief 事件循环指标快照，线程安全且无锁
+  /// @return
+  ReactorMetricsSnapshot Metrics() const {
+    ReactorMetricsSnapshot snap = metrics_.Snapshot();
+    if (dispatcher_) {
+      snap.caller_runs = dispatcher_->CallerRuns();
+      snap.shard_stalls = dispatcher_->ShardStalls();
+      snap.shard_overflows = dispatcher_->ShardOverflows();
+    }
+    return snap;
+  }
+
+  /// @brief 连接统计快照
+  /// @note 仅限循环线程调用，其他线程经RunInLoop调用
+  /// @param conn_id
+  /// @param stats
+  /// @return 连接不存在返回false
+  bool GetConnStats(ConnId conn_id, ConnStatsSnapshot &stats) const {
+    int fd = ConnIdToFd(conn_id);
+    if (static_cast<size_t>(fd) >= slots_.size())
+      return false;
+    const ConnSlot &slot = slots_[fd];
+    if (slot.generation != ConnIdToGeneration(conn_id) || !slot.handler)
+      return false;
+    stats = slot.handler->Stats().Snapshot();
+    return true;
+  }
+
+  /// @brief 停止事件循环，线程安全
+  void Stop() {
+    running_ = false;
+    task_queue_->Wakeup();
+  }
+
+  /// @brief 在循环线程执行任务，线程安全
+  /// @note 在循环线程内调用时直接执行，否则投递并唤醒epoll
+  /// @param task
+  void RunInLoop(LoopTask task) {
+    if (IsInLoopThread())
+      task();
+    else
+      task_queue_->Post(std::move(task));
+  }
+
+  /// @brief 投递任务到循环线程延后执行，线程安全
+  /// @note 循环线程内调用时放入本轮事件处理之后执行的延后队列，不经eventfd；
+  /// 其他线程投递经eventfd唤醒
+  /// @param task
+  void QueueInLoop(LoopTask task) {
+    if (IsInLoopThread())
+      deferred_tasks_.push_back(std::move(task));
+    else
+      task_queue_->Post(std::move(task));
+  }
+
+  /// @brief 向连接发送数据，线程安全
+  /// @note 异步执行：在循环线程追加到连接发送队列并尽量立即写出，
+  /// 写不完的部分注册EPOLLOUT续写；连接已关闭时数据被丢弃
+  /// @param conn_id
+  /// @param chunk
+  void Send(ConnId conn_id, OutputChunk chunk) {
+    RunInLoop([this, conn_id, chunk]() mutable {
+      SendInLoop(conn_id, std::move(chunk));
+    });
+  }
+
+  /// @brief 发送内存数据，线程安全
+  /// @param conn_id
+  /// @param data
+  void Send(ConnId conn_id, std::vector<uint8_t> data) {
+    Send(conn_id, OutputChunk::FromVector(std::move(data)));
+  }
+
+  /// @brief 发送共享缓冲，线程安全；大块缓冲在开启零拷贝时不经拷贝直接发送
+  /// @param conn_id
+  /// @param buffer 发送(或零拷贝完成)前保持存活，调用方不得修改
+  void Send(ConnId conn_id, std::shared_ptr<const std::vector<uint8_t>> buffer) {
+    Send(conn_id, OutputChunk::FromBuffer(std::move(buffer)));
+  }
+
+  /// @brief 向多个连接发送同一份共享缓冲，线程安全
+  /// @note 整批只投递一次循环任务，各连接的发送队列只追加对缓冲的引用，
+  /// 数据在内存中只有一份
+  /// @param conn_ids
+  /// @param buffer 发送完成前保持存活，调用方不得修改
+  void Broadcast(std::vector<ConnId> conn_ids,
+                 std::shared_ptr<const std::vector<uint8_t>> buffer) {
+    RunInLoop([this, conn_ids = std::move(conn_ids),
+               chunk = OutputChunk::FromBuffer(std::move(buffer))]() {
+      BroadcastInLoop(conn_ids, chunk);
+    });
+  }
+
+  /// @brief 在循环线程向多个连接追加同一发送块的引用，仅限循环线程调用
+  /// @param conn_ids
+  /// @param chunk
+  /// @param closed 非空时追加已关闭(或不存在)的连接，便于调用方清理订阅
+  /// @return 成功追加的连接数
+  size_t BroadcastInLoop(const std::vector<ConnId> &conn_ids,
+                         const OutputChunk &chunk,
+                         std::vector<ConnId> *closed = nullptr) {
+    size_t sent = 0;
+    for (ConnId conn_id : conn_ids) {
+      if (SendInLoop(conn_id, OutputChunk(chunk)))
+        sent++;
+      else if (closed)
+        closed->push_back(conn_id);
     }
+    return sent;
   }
 
-  void Stop() { running_ = false; }
+  /// @brief 使用sendfile发送文件区间，线程安全
+  /// @param conn_id
+  /// @param file_fd
+  /// @param offset
+  /// @param length
+  /// @param take_ownership 为true时发送完成或连接关闭后关闭file_fd
+  void SendFile(ConnId conn_id, int file_fd, off_t offset, size_t length,
+                bool take_ownership = false) {
+    Send(conn_id,
+         OutputChunk::FromFile(file_fd, offset, length, take_ownership));
+  }
+
+  /// @brief 经AF_UNIX流式连接发送数据并附带文件描述符，线程安全
+  /// @note 描述符随data首字节到达对端，对端需设置SetFdRecvCallback
+  /// @param conn_id
+  /// @param data 至少1字节
+  /// @param fds 不超过kMaxPassFds个
+  /// @param take_ownership 为true时发送完成或连接关闭后关闭fds
+  void SendFds(ConnId conn_id, std::vector<uint8_t> data, std::vector<int> fds,
+               bool take_ownership = true) {
+    Send(conn_id, OutputChunk::FromVectorWithFds(std::move(data), std::move(fds),
+                                                 take_ownership));
+  }
+
+  /// @brief 非阻塞主动连接，线程安全
+  /// @note 仅接受数字地址(IPv4/IPv6)，不在循环线程做DNS解析；
+  /// 建立后与accept的连接一样使用TcpHandler与UnPacker解析响应，
+  /// 结果总是异步回调(在循环线程)
+  /// @param host
+  /// @param port
+  /// @param cb
+  /// @param options
+  void Connect(const std::string &host, uint16_t port, ConnectCb cb,
+               ConnectOptions options = ConnectOptions()) {
+    QueueInLoop([this, host, port, cb = std::move(cb),
+                 options = std::move(options)]() mutable {
+      ConnectInLoop(host, port, std::move(cb), std::move(options));
+    });
+  }
+
+  /// @brief 非阻塞连接AF_UNIX流式套接字，线程安全
+  /// @note 语义同Connect，建立后按SetFdRecvCallback接收描述符
+  /// @param path 以'@'开头为抽象命名空间
+  /// @param cb
+  /// @param options no_delay被忽略
+  void ConnectUnix(const std::string &path, ConnectCb cb,
+                   ConnectOptions options = ConnectOptions()) {
+    QueueInLoop([this, path, cb = std::move(cb),
+                 options = std::move(options)]() mutable {
+      sockaddr_storage addr{};
+      socklen_t addr_len = 0;
+      if (path.empty() ||
+          !SocketCreator::MakeUnixAddress(
+              path, *reinterpret_cast<sockaddr_un *>(&addr), addr_len)) {
+        cb(0, EINVAL);
+        return;
+      }
+      options.no_delay = false;
+      ConnectAddrInLoop(addr, addr_len, std::move(cb), std::move(options));
+    });
+  }
+
+  /// @brief 主动关闭连接，线程安全
+  /// @param conn_id
+  void Close(ConnId conn_id) {
+    RunInLoop([this, conn_id]() {
+      int fd = ConnIdToFd(conn_id);
+      if (static_cast<size_t>(fd) < slots_.size() &&
+          slots_[fd].generation == ConnIdToGeneration(conn_id) &&
+          slots_[fd].type == SlotType::kConnection)
+        UnregisterFd(fd);
+    });
+  }
+
+  /// @brief 设置accept连接的零拷贝阈值，不小于该长度的缓冲使用MSG_ZEROCOPY
+  /// @note 0为关闭(默认)；仅对之后accept的连接生效
+  /// @param threshold
+  void SetZeroCopyThreshold(size_t threshold) {
+    zerocopy_threshold_ = threshold;
+  }
+
+  /// @brief 当前线程是否为循环线程
+  /// @return
+  bool IsInLoopThread() const {
+    return loop_thread_id_ == std::this_thread::get_id();
+  }
+
+  /// @brief 添加单次定时器，回调在循环线程执行
+  /// @note 仅限循环线程(或Run之前)调用
+  /// @param delay_ms
+  /// @param cb
+  /// @return 定时器ID
+  threading::TimerId RunAfter(uint64_t delay_ms, threading::TimerCb cb) {
+    return timing_wheel_.Add(delay_ms, std::move(cb));
+  }
+
+  /// @brief 添加周期定时器，回调在循环线程执行
+  /// @note 仅限循环线程(或Run之前)调用
+  /// @param interval_ms
+  /// @param cb
+  /// @return 定时器ID
+  threading::TimerId RunEvery(uint64_t interval_ms, threading::TimerCb cb) {
+    return timing_wheel_.Add(interval_ms, std::move(cb), interval_ms);
+  }
+
+  /// @brief 取消定时器
+  /// @param timer_id
+  /// @return 是否取消成功
+  bool CancelTimer(threading::TimerId timer_id) {
+    return timing_wheel_.Cancel(timer_id);
+  }
+
+  /// @brief 设置连接超时
+  /// @note 对监听fd设置时由其accept的连接继承，对连接fd设置时立即生效；
+  /// 超时的连接由循环线程关闭回收，仅限循环线程(或Run之前)调用
+  /// @param fd 监听或连接fd
+  /// @param timeouts
+  void SetConnTimeouts(int fd, const ConnTimeouts &timeouts) {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots_.size())
+      return;
+    ConnSlot &slot = slots_[fd];
+    slot.timeouts = timeouts;
+    if (slot.type == SlotType::kConnection)
+      ArmConnTimer(fd, NextConnDeadline(slot, NowMs()));
+  }
+
+  /// @brief 设置新连接回调，accept的连接注册完成后在循环线程调用
+  /// @note 仅限Run之前调用
+  /// @param cb
+  void SetAcceptCallback(AcceptCb cb) { accept_cb_ = std::move(cb); }
+
+  /// @brief 设置连接的内联包回调：包在循环线程解析后直接回调，不经派发器与流控
+  /// @note 仅限循环线程调用；回调执行于事件处理过程中，不得同步关闭该连接。
+  /// 用于在循环线程恢复协程等轻量处理
+  /// @param conn_id
+  /// @param cb 为空时恢复派发
+  /// @return 连接不存在返回false
+  bool SetConnInlineCallback(ConnId conn_id, ConnExecCb cb) {
+    ConnSlot *slot = FindConnSlot(conn_id);
+    if (!slot)
+      return false;
+    slot->handler->SetInlineCallback(
+        cb ? std::make_shared<const ConnExecCb>(std::move(cb)) : nullptr);
+    return true;
+  }
+
+  /// @brief 设置连接关闭回调，替换已有回调
+  /// @note 仅限循环线程调用
+  /// @param conn_id
+  /// @param cb
+  /// @param previous 非空时取出被替换的回调，便于串联
+  /// @return 连接不存在返回false
+  bool SetCloseCallback(ConnId conn_id, CloseCb cb,
+                        CloseCb *previous = nullptr) {
+    ConnSlot *slot = FindConnSlot(conn_id);
+    if (!slot)
+      return false;
+    if (previous)
+      *previous = std::move(slot->close_cb);
+    slot->close_cb = std::move(cb);
+    return true;
+  }
+
+  /// @brief 设置监听fd的接收缓冲区容量策略，由其之后accept的连接继承
+  /// @note 仅限循环线程(或Run之前)调用；未设置时容量固定为SetConnHandlerParams的
+  /// buffer_size。开启收缩时由周期任务检查空闲连接
+  /// @param listen_fd
+  /// @param policy
+  void SetRecvBufferPolicy(int listen_fd, const RecvBufferPolicy &policy) {
+    if (listen_fd < 0 || static_cast<size_t>(listen_fd) >= slots_.size())
+      return;
+    slots_[listen_fd].buffer_policy = policy;
+    EnsureShrinkSweep(policy.shrink_idle_ms);
+  }
+
+  /// @brief 设置监听fd的连接处理器工厂，其之后accept的连接由工厂创建处理器
+  /// @note 仅限循环线程(或Run之前)调用；用于HTTP等自带解析的应用层协议，
+  /// 此时SetConnHandlerParams的解包参数与业务回调对这些连接不生效
+  /// @param listen_fd
+  /// @param factory 为空时恢复TcpHandler
+  void SetHandlerFactory(int listen_fd, HandlerFactory factory) {
+    if (listen_fd < 0 || static_cast<size_t>(listen_fd) >= slots_.size())
+      return;
+    slots_[listen_fd].handler_factory = std::move(factory);
+  }
 
   /// @brief 设置连接处理器参数
   /// @param head_key
@@ -153,34 +573,613 @@ public:
     tail_key_ = std::move(tail_key);
     data_sz_cb_ = std::move(data_sz_cb);
     check_sz_cb_ = std::move(check_sz_cb);
-    exec_cb_ = std::move(exec_cb);
+    exec_cb_ = exec_cb ? std::make_shared<const ExecCb>(std::move(exec_cb))
+                       : nullptr;
     buffer_size_ = buffer_size;
   }
 
-  /// @brief 注入定时线程池依赖
-  /// @param timer_shceduler
-  void SetTimerScheduler(
-      std::shared_ptr<threading::TimerScheduler> timer_shceduler) {
-    timer_shceduler_ = std::move(timer_shceduler);
+  /// @brief 设置携带连接ID的业务回调，回调内可用Send向来源连接回包
+  /// @note 与SetConnHandlerParams中的exec_cb可同时设置，仅对之后accept的连接生效
+  /// @param cb
+  void SetConnExecCallback(ConnExecCb cb) {
+    conn_exec_cb_ = cb ? std::make_shared<const ConnExecCb>(std::move(cb))
+                       : nullptr;
+  }
+
+  /// @brief 设置AF_UNIX连接收到文件描述符时的回调
+  /// @note 设置后AF_UNIX流式连接改用recvmsg读取，描述符与同一次读取解析出的包
+  /// 同批派发且先于包回调执行；未设置时内核丢弃收到的描述符。
+  /// 仅对之后accept或ConnectUnix的连接生效
+  /// @param cb
+  void SetFdRecvCallback(FdRecvCb cb) {
+    fd_recv_cb_ =
+        cb ? std::make_shared<const FdRecvCb>(std::move(cb)) : nullptr;
+  }
+
+  /// @brief 注入数据包派发器依赖，未注入时Run内创建默认派发器
+  /// @note 多个ReactorCore可共享同一个派发器
+  /// @param dispatcher
+  void SetDispatcher(std::shared_ptr<PacketDispatcher> dispatcher) {
+    dispatcher_ = std::move(dispatcher);
   };
 
+  /// @brief 设置事件循环轮询策略(低延迟模式)
+  /// @note 仅限Run之前调用；忙轮询选项同时作用于epoll实例与已注册/之后注册的套接字，
+  /// 超过net.core.busy_read的SO_BUSY_POLL需要CAP_NET_ADMIN
+  /// @param options
+  void SetPollOptions(const PollOptions &options) {
+    poller_.SetOptions(options);
+    if (!poller_.ApplyEpollParams(epoll_fd_))
+      LOGP_WARN("epoll busy poll unsupported,errno:%d", errno);
+    for (size_t fd = 0; fd < slots_.size(); ++fd) {
+      if ((slots_[fd].type == SlotType::kListener ||
+           slots_[fd].type == SlotType::kConnection) &&
+          !poller_.ApplySocketOptions(static_cast<int>(fd)))
+        LOGP_WARN("SO_BUSY_POLL failed on fd:%d,errno:%d", fd, errno);
+    }
+  }
+
+  /// @brief 设置单次可读事件的读取预算，0为不限(默认)
+  /// @note 边缘触发下连接会一直读到EAGAIN，大流量连接可能饿死同批次的其他连接；
+  /// 用尽预算的连接进入就绪列表，每轮事件处理后按轮转顺序各补读一个预算。
+  /// 仅限Run之前调用，已注册的连接同样生效
+  /// @param max_bytes
+  /// @param max_packets
+  void SetReadBudget(size_t max_bytes, size_t max_packets = 0) {
+    read_budget_.max_bytes = max_bytes;
+    read_budget_.max_packets = max_packets;
+    for (ConnSlot &slot : slots_) {
+      if (slot.handler)
+        slot.handler->SetReadBudget(read_budget_);
+    }
+  }
+
+  /// @brief 开启接收抓包，各连接每次读取的原始数据连同时间戳写入capture
+  /// @note 供CaptureReplay离线回放；多个事件循环可共享同一写入器。
+  /// 仅限Run之前调用，已注册的连接同样生效
+  /// @param capture 为空时关闭
+  void SetCapture(std::shared_ptr<TrafficCapture> capture) {
+    capture_ = std::move(capture);
+    for (ConnSlot &slot : slots_) {
+      if (slot.handler && slot.type != SlotType::kListener)
+        slot.handler->SetCapture(capture_);
+    }
+  }
+
+  /// @brief 开启读侧流控
+  /// @note 单连接或全局在途批次达到上限时暂停该连接的EPOLLIN，数据留在
+  /// 内核接收缓冲区由TCP窗口向对端施加背压；回落到上限一半时恢复。
+  /// 仅限Run之前调用，已注册的连接同样生效
+  /// @param limits
+  void SetFlowLimits(const FlowLimits &limits) {
+    std::weak_ptr<LoopTaskQueue> queue = task_queue_;
+    flow_control_ = std::make_shared<FlowControl>(limits, [this, queue]() {
+      // 工作线程上调用；事件循环销毁后队列失效，任务不再投递
+      if (auto q = queue.lock())
+        q->Post([this]() { ResumePausedConns(); });
+    });
+    for (size_t fd = 0; fd < slots_.size(); ++fd) {
+      if (slots_[fd].type == SlotType::kConnection)
+        AttachFlow(static_cast<int>(fd));
+    }
+  }
+
 private:
+  /// @brief 根据时间轮最近到期时间设置timerfd
+  /// @note 到期时刻未变化时跳过，避免每轮循环一次系统调用
+  void ArmTimerFd() {
+    int64_t next_tick = timing_wheel_.NextExpireTick();
+    if (next_tick == armed_tick_)
+      return;
+
+    int64_t timeout_ms = timing_wheel_.NextTimeoutMs();
+    itimerspec spec{}; // it_value全0表示解除
+    if (timeout_ms >= 0) {
+      spec.it_value.tv_sec = timeout_ms / 1000;
+      spec.it_value.tv_nsec = (timeout_ms % 1000) * 1000000 + 1;
+    }
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == -1)
+      perror("timerfd_settime");
+    armed_tick_ = next_tick;
+  }
+
+  /// @brief timerfd可读：清空计数并推进时间轮
+  void HandleTimerExpired() {
+    uint64_t expirations = 0;
+    while (read(timer_fd_, &expirations, sizeof(expirations)) > 0) {
+    }
+    armed_tick_ = -2; // 已触发，强制下一轮重新设置
+    timing_wheel_.Advance();
+  }
+
+  /// @brief 占用fd槽位，返回连接ID
+  ConnId OccupySlot(int fd, SlotType type,
+                    std::unique_ptr<ProtocolHandler> handler) {
+    if (static_cast<size_t>(fd) >= slots_.size())
+      slots_.resize(fd + 1);
+    ConnSlot &slot = slots_[fd];
+    slot.handler = std::move(handler);
+    slot.type = type;
+    if (capture_ && slot.handler && type != SlotType::kListener)
+      slot.handler->SetCapture(capture_);
+    slot.last_read_ms = slot.last_write_ms = NowMs();
+    return MakeConnId(fd, slot.generation);
+  }
+
+  /// @brief 释放fd槽位并递增代数，使残留事件失效
+  void ReleaseSlot(int fd) {
+    ConnSlot &slot = slots_[fd];
+    slot.connect_cb = nullptr;
+    slot.close_cb = nullptr;
+    if (slot.timer_armed)
+      timing_wheel_.Cancel(slot.timeout_timer);
+    slot.timer_armed = false;
+    slot.timeouts = ConnTimeouts{};
+    if (slot.flow && slot.read_paused)
+      flow_control_->MarkResumed(*slot.flow);
+    slot.flow.reset();
+    slot.read_paused = false;
+    slot.read_pending = false;
+    slot.buffer_policy = RecvBufferPolicy{};
+    slot.handler_factory = nullptr;
+    slot.epoll_events = 0;
+    slot.handler.reset();
+    slot.type = SlotType::kFree;
+    slot.generation++;
+  }
+
+  static uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static uint64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /// @brief 计算连接最近的超时截止时间，无超时配置返回0
+  uint64_t NextConnDeadline(const ConnSlot &slot, uint64_t now_ms) const {
+    const ConnTimeouts &t = slot.timeouts;
+    uint64_t deadline = UINT64_MAX;
+    if (t.idle_timeout_ms)
+      deadline = std::min(deadline, std::max(slot.last_read_ms,
+                                             slot.last_write_ms) +
+                                        t.idle_timeout_ms);
+    if (t.read_timeout_ms)
+      deadline = std::min(deadline, slot.last_read_ms + t.read_timeout_ms);
+    if (t.write_timeout_ms) {
+      // 无待发送数据时写超时不计时，按周期复查
+      bool pending = slot.handler && slot.handler->HasPendingOutput();
+      deadline = std::min(deadline, (pending ? slot.last_write_ms : now_ms) +
+                                        t.write_timeout_ms);
+    }
+    return deadline == UINT64_MAX ? 0 : deadline;
+  }
+
+  /// @brief 为连接挂载超时检查定时器，每个连接最多一个
+  void ArmConnTimer(int fd, uint64_t deadline_ms) {
+    ConnSlot &slot = slots_[fd];
+    if (slot.timer_armed) {
+      timing_wheel_.Cancel(slot.timeout_timer);
+      slot.timer_armed = false;
+    }
+    if (deadline_ms == 0)
+      return;
+    uint64_t now = NowMs();
+    ConnId conn_id = MakeConnId(fd, slot.generation);
+    slot.timeout_timer =
+        timing_wheel_.Add(deadline_ms > now ? deadline_ms - now : 0,
+                          [this, conn_id]() { CheckConnTimeout(conn_id); });
+    slot.timer_armed = true;
+  }
+
+  /// @brief 超时检查：到期则关闭，否则按最新活动时间重排
+  void CheckConnTimeout(ConnId conn_id) {
+    int fd = ConnIdToFd(conn_id);
+    ConnSlot &slot = slots_[fd];
+    if (slot.generation != ConnIdToGeneration(conn_id) ||
+        slot.type != SlotType::kConnection)
+      return;
+    slot.timer_armed = false;
+
+    uint64_t now = NowMs();
+    uint64_t deadline = NextConnDeadline(slot, now);
+    if (deadline != 0 && deadline <= now) {
+      LOGP_MSG("Connection timeout on fd:%d", fd);
+      metrics_.conn_timeouts.Add();
+      UnregisterFd(fd);
+      return;
+    }
+    ArmConnTimer(fd, deadline);
+  }
+
+  /// @brief 连接事件分发
+  void HandleConnEvent(int fd, ConnId conn_id, uint32_t revents) {
+    ConnSlot &slot = slots_[fd];
+    ProtocolHandler *handler = slot.handler.get();
+    if (!handler)
+      return;
+
+    // O(1)刷新活动时间
+    if (revents & EPOLLIN)
+      slot.last_read_ms = loop_now_ms_;
+    if (revents & EPOLLOUT)
+      slot.last_write_ms = loop_now_ms_;
+
+    // 事件标志与epoll位一致，直接掩码转换
+    Event ev;
+    ev.fd = fd;
+    ev.event_flags = static_cast<EventFlags>(revents & kEventFlagsMask);
+    ev.conn_id = conn_id;
+
+    try {
+      handler->HandleEvent(epoll_fd_, ev, *dispatcher_);
+    } catch (const std::exception &e) {
+      LOGP_MSG("Error handling fd:%d - %s", fd, e.what());
+      UnregisterFd(fd);
+      return;
+    }
+
+    // 检查连接是否需要关闭
+    if (handler->ShouldClose()) {
+      UnregisterFd(fd);
+      return;
+    }
+
+    SyncWriteInterest(fd, conn_id);
+
+    // 下游饱和：停止监听可读，避免继续读入无法及时处理的数据
+    if (slot.flow && handler->ConsumeReadThrottled() && !slot.read_paused)
+      PauseRead(fd, conn_id);
+
+    // 预算用尽：边缘触发不会再次通知，排入就绪列表稍后补读
+    if (handler->ConsumeBudgetExhausted() && !slot.read_paused &&
+        !slot.read_pending) {
+      slot.read_pending = true;
+      metrics_.budget_yields.Add();
+      ready_conns_.push_back(conn_id);
+    }
+  }
+
+  /// @brief 查找仍然有效的已建立连接槽位
+  ConnSlot *FindConnSlot(ConnId conn_id) {
+    int fd = ConnIdToFd(conn_id);
+    if (static_cast<size_t>(fd) >= slots_.size())
+      return nullptr;
+    ConnSlot &slot = slots_[fd];
+    if (slot.generation != ConnIdToGeneration(conn_id) ||
+        slot.type != SlotType::kConnection || !slot.handler)
+      return nullptr;
+    return &slot;
+  }
+
+  /// @brief 执行本轮之前延后的任务，期间新加入的任务留到下一轮
+  void RunDeferredTasks() {
+    if (deferred_tasks_.empty())
+      return;
+    running_tasks_.swap(deferred_tasks_);
+    for (LoopTask &task : running_tasks_)
+      task();
+    metrics_.loop_tasks.Add(running_tasks_.size());
+    running_tasks_.clear();
+  }
+
+  /// @brief 轮转补读就绪列表中的连接，每个连接一个预算
+  /// @note 再次用尽预算的连接排到队尾，与下一轮新事件交替处理
+  void ServiceReadyConns() {
+    if (ready_conns_.empty())
+      return;
+    servicing_conns_.swap(ready_conns_);
+    for (ConnId conn_id : servicing_conns_) {
+      int fd = ConnIdToFd(conn_id);
+      ConnSlot &slot = slots_[fd];
+      // 连接已关闭或fd被复用
+      if (slot.generation != ConnIdToGeneration(conn_id) || !slot.read_pending)
+        continue;
+      slot.read_pending = false;
+      // 流控暂停期间不读取，恢复时重新设置EPOLLIN会触发边缘通知
+      if (slot.read_paused)
+        continue;
+      HandleConnEvent(fd, conn_id, EPOLLIN);
+    }
+    servicing_conns_.clear();
+  }
+
+  /// @brief 在循环线程追加发送数据
+  /// @return 连接已关闭(或因发送失败而关闭)返回false
+  bool SendInLoop(ConnId conn_id, OutputChunk &&chunk) {
+    int fd = ConnIdToFd(conn_id);
+    if (static_cast<size_t>(fd) >= slots_.size())
+      return false;
+    ConnSlot &slot = slots_[fd];
+    if (slot.generation != ConnIdToGeneration(conn_id) ||
+        slot.type != SlotType::kConnection || !slot.handler)
+      return false;
+
+    // 发送队列由空变为非空时开始计算写超时
+    if (!slot.handler->HasPendingOutput())
+      slot.last_write_ms = NowMs();
+    if (!slot.handler->Send(std::move(chunk)) ||
+        slot.handler->ShouldClose()) {
+      UnregisterFd(fd);
+      return false;
+    }
+    SyncWriteInterest(fd, conn_id);
+    return true;
+  }
+
+  /// @brief 有待发送数据时注册EPOLLOUT，写完后注销，避免空转唤醒
+  void SyncWriteInterest(int fd, ConnId conn_id) {
+    ConnSlot &slot = slots_[fd];
+    bool want = slot.handler && slot.handler->HasPendingOutput();
+    bool has = slot.epoll_events & EPOLLOUT;
+    if (want != has)
+      ModifyEvents(fd, conn_id,
+                   want ? slot.epoll_events | EPOLLOUT
+                        : slot.epoll_events & ~EPOLLOUT);
+  }
+
+  /// @brief 为连接创建流控状态并注入处理器
+  void AttachFlow(int fd) {
+    ConnSlot &slot = slots_[fd];
+    if (!flow_control_ || !slot.handler || slot.flow)
+      return;
+    slot.flow = flow_control_->CreateConnFlow(MakeConnId(fd, slot.generation));
+    slot.handler->SetFlow(slot.flow);
+  }
+
+  /// @brief 修改fd监听的事件集合
+  bool ModifyEvents(int fd, ConnId conn_id, uint32_t events) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = conn_id;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1) {
+      perror("epoll_ctl mod");
+      return false;
+    }
+    slots_[fd].epoll_events = events;
+    return true;
+  }
+
+  /// @brief 暂停连接读取
+  void PauseRead(int fd, ConnId conn_id) {
+    ConnSlot &slot = slots_[fd];
+    // 标记前工作线程已回落：重新设置事件以触发边缘通知，读取剩余数据
+    if (!flow_control_->MarkPaused(*slot.flow)) {
+      ModifyEvents(fd, conn_id, slot.epoll_events);
+      return;
+    }
+    if (!ModifyEvents(fd, conn_id, slot.epoll_events & ~EPOLLIN)) {
+      flow_control_->MarkResumed(*slot.flow);
+      return;
+    }
+    slot.read_paused = true;
+    metrics_.read_pauses.Add();
+    paused_conns_.push_back(conn_id);
+  }
+
+  /// @brief 恢复已回落到低水位的连接(工作线程通知后在循环线程执行)
+  void ResumePausedConns() {
+    if (!flow_control_)
+      return;
+    // 先清除请求标记，之后的回落会重新通知，不会丢失恢复
+    flow_control_->ClearResumeRequest();
+    size_t kept = 0;
+    for (ConnId conn_id : paused_conns_) {
+      int fd = ConnIdToFd(conn_id);
+      ConnSlot &slot = slots_[fd];
+      // 连接已关闭或fd被复用
+      if (slot.generation != ConnIdToGeneration(conn_id) || !slot.read_paused)
+        continue;
+      if (!flow_control_->CanResume(*slot.flow)) {
+        paused_conns_[kept++] = conn_id;
+        continue;
+      }
+      flow_control_->MarkResumed(*slot.flow);
+      slot.read_paused = false;
+      // 重新加入EPOLLIN，边缘触发下内核若有残留数据会立即再次通知
+      ModifyEvents(fd, conn_id, slot.epoll_events | EPOLLIN);
+    }
+    paused_conns_.resize(kept);
+  }
+
   void UnregisterFd(int fd) {
+    ConnSlot &slot = slots_[fd];
+    ConnId conn_id = MakeConnId(fd, slot.generation);
+    CloseCb close_cb = std::move(slot.close_cb);
+
+    // 内核仍引用零拷贝缓冲时不能立即释放，连接转入排空状态
+    if (slot.type == SlotType::kConnection && slot.handler &&
+        slot.handler->ReapZeroCopy() != 0) {
+      std::unique_ptr<ProtocolHandler> handler = std::move(slot.handler);
+      ReleaseSlot(fd);
+      DrainZeroCopy(fd, std::move(handler));
+    } else {
+      if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == -1) {
+        perror("epoll_ctl del");
+      }
+      ReleaseSlot(fd);
+      close(fd);
+    }
+    metrics_.conns_closed.Add();
+    LOGP_MSG("Unregistered fd:%d", fd);
+    if (close_cb)
+      close_cb(conn_id);
+  }
+
+  /// @brief 已关闭但仍有零拷贝发送在途的连接：保留fd与处理器(连同其持有的
+  /// 缓冲)，只等待错误队列的完成通知
+  /// @note shutdown后对端照常收到FIN，代数已递增，旧连接ID的事件与发送均被丢弃；
+  /// kZeroCopyDrainMs内未收齐通知则以RST中止，内核随即清空发送队列
+  void DrainZeroCopy(int fd, std::unique_ptr<ProtocolHandler> handler) {
+    shutdown(fd, SHUT_RDWR);
+    ConnId drain_id = OccupySlot(fd, SlotType::kDraining, std::move(handler));
+    // 仅边缘触发的EPOLLERR/EPOLLHUP，shutdown后的挂起状态不会反复唤醒
+    ModifyEvents(fd, drain_id, EPOLLET);
+    ConnSlot &slot = slots_[fd];
+    slot.timeout_timer = timing_wheel_.Add(kZeroCopyDrainMs, [this, drain_id]() {
+      int drain_fd = ConnIdToFd(drain_id);
+      ConnSlot &drain_slot = slots_[drain_fd];
+      if (drain_slot.generation != ConnIdToGeneration(drain_id) ||
+          drain_slot.type != SlotType::kDraining)
+        return;
+      drain_slot.timer_armed = false;
+      LOGP_WARN("zerocopy completions timed out on fd:%d", drain_fd);
+      linger reset{1, 0};
+      setsockopt(drain_fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+      FinishDrain(drain_fd);
+    });
+    slot.timer_armed = true;
+    // 通知可能在转入排空前已经到达
+    if (slot.handler->ReapZeroCopy() == 0)
+      FinishDrain(fd);
+  }
+
+  /// @brief 零拷贝发送全部完成，释放排空中的连接
+  void FinishDrain(int fd) {
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == -1) {
       perror("epoll_ctl del");
     }
+    // 先关闭fd再释放处理器，中止时内核在close内丢弃对缓冲的引用
+    close(fd);
+    ReleaseSlot(fd);
+  }
+
+  /// @brief 发起非阻塞连接，完成后由EPOLLOUT通知
+  void ConnectInLoop(const std::string &host, uint16_t port, ConnectCb cb,
+                     ConnectOptions options) {
+    sockaddr_storage addr{};
+    socklen_t addr_len = 0;
+    auto *v4 = reinterpret_cast<sockaddr_in *>(&addr);
+    auto *v6 = reinterpret_cast<sockaddr_in6 *>(&addr);
+    if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1) {
+      v4->sin_family = AF_INET;
+      v4->sin_port = htons(port);
+      addr_len = sizeof(sockaddr_in);
+    } else if (inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1) {
+      v6->sin6_family = AF_INET6;
+      v6->sin6_port = htons(port);
+      addr_len = sizeof(sockaddr_in6);
+    } else {
+      cb(0, EINVAL);
+      return;
+    }
+    ConnectAddrInLoop(addr, addr_len, std::move(cb), std::move(options));
+  }
+
+  /// @brief 按已解析地址发起连接(TCP与AF_UNIX共用)
+  void ConnectAddrInLoop(const sockaddr_storage &addr, socklen_t addr_len,
+                         ConnectCb cb, ConnectOptions options) {
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    0);
+    if (fd < 0) {
+      cb(0, errno);
+      return;
+    }
+    if (options.no_delay) {
+      int on = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    // AF_UNIX返回EAGAIN表示对端backlog已满，按失败处理
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&addr), addr_len) ==
+            -1 &&
+        errno != EINPROGRESS) {
+      int err = errno;
+      close(fd);
+      cb(0, err);
+      return;
+    }
+    poller_.ApplySocketOptions(fd);
+
+    // 立即连接成功同样等待EPOLLOUT，统一在HandleConnectEvent中完成
+    EnsureShrinkSweep(options.buffer_policy.shrink_idle_ms);
+    auto handler = MakeTcpHandler(fd, addr.ss_family, options.buffer_policy);
+    if (options.exec_cb)
+      handler->SetConnCallback(
+          std::make_shared<const ConnExecCb>(std::move(options.exec_cb)));
+    ConnId conn_id = OccupySlot(fd, SlotType::kConnecting, std::move(handler));
+    epoll_event ev{};
+    ev.events = EPOLLOUT | EPOLLET;
+    ev.data.u64 = conn_id;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+      int err = errno;
+      ReleaseSlot(fd);
+      close(fd);
+      cb(0, err);
+      return;
+    }
+
+    ConnSlot &slot = slots_[fd];
+    slot.epoll_events = ev.events;
+    slot.buffer_policy = ResolveBufferPolicy(options.buffer_policy);
+    slot.timeouts = options.timeouts;
+    slot.connect_cb = std::move(cb);
+    slot.close_cb = std::move(options.on_close);
+    if (options.timeout_ms) {
+      slot.timeout_timer =
+          timing_wheel_.Add(options.timeout_ms, [this, conn_id]() {
+            int fd = ConnIdToFd(conn_id);
+            ConnSlot &slot = slots_[fd];
+            if (slot.generation != ConnIdToGeneration(conn_id) ||
+                slot.type != SlotType::kConnecting)
+              return;
+            slot.timer_armed = false;
+            FailConnect(fd, ETIMEDOUT);
+          });
+      slot.timer_armed = true;
+    }
+  }
+
+  /// @brief 连接完成：检查SO_ERROR，成功则转为普通连接
+  void HandleConnectEvent(int fd, ConnId conn_id) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1)
+      err = errno;
+    if (err != 0) {
+      FailConnect(fd, err);
+      return;
+    }
 
-    protocol_handlers_.erase(fd);
-    listeners_.erase(fd);
+    ConnSlot &slot = slots_[fd];
+    if (slot.timer_armed) {
+      timing_wheel_.Cancel(slot.timeout_timer);
+      slot.timer_armed = false;
+    }
+    if (!ModifyEvents(fd, conn_id, EPOLLIN | EPOLLET)) {
+      FailConnect(fd, errno);
+      return;
+    }
+    slot.type = SlotType::kConnection;
+    slot.last_read_ms = slot.last_write_ms = NowMs();
+    AttachFlow(fd);
+    ArmConnTimer(fd, NextConnDeadline(slot, slot.last_read_ms));
+    LOGP_MSG("Connected fd:%d", fd);
+
+    ConnectCb cb = std::move(slot.connect_cb);
+    if (cb)
+      cb(conn_id, 0);
+  }
+
+  /// @brief 连接失败：释放槽位并回调错误，不触发关闭回调
+  void FailConnect(int fd, int error) {
+    ConnectCb cb = std::move(slots_[fd].connect_cb);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ReleaseSlot(fd);
     close(fd);
-    LOGP_MSG("Unregistered fd:%d", fd);
+    LOGP_MSG("Connect failed on fd:%d,errno:%d", fd, error);
+    if (cb)
+      cb(0, error);
   }
 
   /// @brief 处理TCP新连接到来
   /// @param listen_fd
   void HandleNewConnections(int listen_fd) {
     while (true) {
-      sockaddr_in client_addr{};
+      sockaddr_storage client_addr{};
       socklen_t addr_len = sizeof(client_addr);
 
       int conn_fd = accept4(listen_fd, (sockaddr *)&client_addr, &addr_len,
@@ -190,42 +1189,190 @@ private:
         if (errno == EAGAIN || errno == EWOULDBLOCK)
           break;
         perror("accept4");
+        metrics_.accept_errors.Add();
         continue;
       }
 
-      char ip_str[INET_ADDRSTRLEN];
-      inet_ntop(AF_INET, &client_addr.sin_addr, ip_str, sizeof(ip_str));
-      LOGP_MSG("Accepted connection [fd:%d] from %s:%d", conn_fd, ip_str,
-               ntohs(client_addr.sin_port));
+      metrics_.accepts.Add();
+      LOGP_MSG("Accepted connection [fd:%d] from %s", conn_fd,
+               FormatPeer(client_addr, addr_len).c_str());
 
-      // 为连接创建处理程序
-      CreateConnHandler(conn_fd);
+      // 为连接创建处理程序，继承监听套接字的超时与缓冲区策略
+      RecvBufferPolicy policy = slots_[listen_fd].buffer_policy;
+      if (!CreateConnHandler(conn_fd, client_addr.ss_family, policy,
+                             slots_[listen_fd].handler_factory))
+        continue;
+      ConnSlot &slot = slots_[conn_fd];
+      if (slot.type != SlotType::kConnection)
+        continue;
+      slot.buffer_policy = ResolveBufferPolicy(policy);
+      slot.timeouts = slots_[listen_fd].timeouts;
+      ArmConnTimer(conn_fd, NextConnDeadline(slot, loop_now_ms_));
+      if (accept_cb_)
+        accept_cb_(MakeConnId(conn_fd, slot.generation));
     }
   }
 
+  /// @brief 格式化对端地址用于日志
+  static std::string FormatPeer(const sockaddr_storage &addr,
+                                socklen_t addr_len) {
+    char ip_str[INET6_ADDRSTRLEN] = {};
+    if (addr.ss_family == AF_INET) {
+      auto &v4 = reinterpret_cast<const sockaddr_in &>(addr);
+      inet_ntop(AF_INET, &v4.sin_addr, ip_str, sizeof(ip_str));
+      return std::string(ip_str) + ":" + std::to_string(ntohs(v4.sin_port));
+    }
+    if (addr.ss_family == AF_INET6) {
+      auto &v6 = reinterpret_cast<const sockaddr_in6 &>(addr);
+      inet_ntop(AF_INET6, &v6.sin6_addr, ip_str, sizeof(ip_str));
+      return "[" + std::string(ip_str) + "]:" +
+             std::to_string(ntohs(v6.sin6_port));
+    }
+    if (addr.ss_family == AF_UNIX) {
+      // 客户端通常未绑定，地址只有族字段
+      auto &un = reinterpret_cast<const sockaddr_un &>(addr);
+      size_t len = addr_len > offsetof(sockaddr_un, sun_path)
+                       ? addr_len - offsetof(sockaddr_un, sun_path)
+                       : 0;
+      if (len == 0)
+        return "unix:(unnamed)";
+      if (un.sun_path[0] == '\0')
+        return "unix:@" + std::string(un.sun_path + 1, len - 1);
+      return "unix:" + std::string(un.sun_path, strnlen(un.sun_path, len));
+    }
+    return "family " + std::to_string(addr.ss_family);
+  }
+
   /// @brief 创建处理器
   /// @param conn_fd
-  void CreateConnHandler(int conn_fd) {
-    // 创建解包器（每个连接独立）
+  /// @param family 连接的地址族
+  /// @param policy 接收缓冲区策略
+  /// @param factory 监听fd的处理器工厂，为空时创建TcpHandler
+  /// @return 工厂未创建处理器时关闭连接并返回false
+  bool CreateConnHandler(int conn_fd, int family,
+                         const RecvBufferPolicy &policy,
+                         const HandlerFactory &factory) {
+    // 先创建处理器再注册，注册可能扩容槽位表使factory引用失效
+    std::unique_ptr<ProtocolHandler> handler =
+        factory ? factory(conn_fd, family)
+                : MakeTcpHandler(conn_fd, family, policy);
+    if (!handler) {
+      LOGP_WARN("No handler created for fd:%d", conn_fd);
+      close(conn_fd);
+      return false;
+    }
+    // 注册新连接
+    RegisterProtocol(conn_fd, std::move(handler));
+    return true;
+  }
+
+  /// @brief 将策略中的缺省值解析为具体尺寸
+  RecvBufferPolicy ResolveBufferPolicy(const RecvBufferPolicy &policy) const {
+    RecvBufferPolicy resolved = policy;
+    if (resolved.initial_size == 0)
+      resolved.initial_size = buffer_size_;
+    resolved.max_size = std::max(resolved.max_size, resolved.initial_size);
+    if (resolved.min_size == 0 || resolved.min_size > resolved.initial_size)
+      resolved.min_size = resolved.initial_size;
+    return resolved;
+  }
+
+  /// @brief 按需启动空闲连接缓冲区收缩的周期任务，间隔为最短空闲时长的一半
+  void EnsureShrinkSweep(uint64_t shrink_idle_ms) {
+    if (shrink_idle_ms == 0)
+      return;
+    uint64_t interval = std::max<uint64_t>(shrink_idle_ms / 2, 1);
+    if (shrink_sweep_armed_ && interval >= shrink_sweep_interval_ms_)
+      return;
+    if (shrink_sweep_armed_)
+      timing_wheel_.Cancel(shrink_sweep_timer_);
+    shrink_sweep_interval_ms_ = interval;
+    shrink_sweep_timer_ = timing_wheel_.Add(
+        interval, [this]() { ShrinkIdleBuffers(); }, interval);
+    shrink_sweep_armed_ = true;
+  }
+
+  /// @brief 收缩空闲连接的接收缓冲区
+  void ShrinkIdleBuffers() {
+    uint64_t now = NowMs();
+    for (ConnSlot &slot : slots_) {
+      uint64_t idle_ms = slot.buffer_policy.shrink_idle_ms;
+      if (slot.type != SlotType::kConnection || !slot.handler ||
+          idle_ms == 0 || now - slot.last_read_ms < idle_ms)
+        continue;
+      slot.handler->ShrinkRecvBuffer();
+    }
+  }
+
+  /// @brief 按连接处理器参数创建流式处理器(accept与主动连接共用)
+  /// @note AF_UNIX连接不支持MSG_ZEROCOPY，改为按需接收描述符
+  /// @param conn_fd
+  /// @param family
+  /// @param policy 接收缓冲区策略，解析后记录到连接槽位
+  /// @return
+  std::unique_ptr<TcpHandler> MakeTcpHandler(int conn_fd, int family,
+                                             const RecvBufferPolicy &policy) {
+    RecvBufferPolicy resolved = ResolveBufferPolicy(policy);
+
+    // 创建解包器（每个连接独立，参数按值拷贝，保留模板供后续连接使用）
     auto unpacker = containers::UnPacker::CreateWithCallbacks(
-        std::forward<containers::HeadKey>(head_key_),
-        std::forward<containers::TailKey>(tail_key_),
-        std::forward<containers::DataSzCb>(data_sz_cb_),
-        std::forward<containers::CheckValidCb>(check_sz_cb_), 1024);
+        containers::HeadKey(head_key_), containers::TailKey(tail_key_),
+        containers::DataSzCb(data_sz_cb_),
+        containers::CheckValidCb(check_sz_cb_), resolved.initial_size);
 
     // 创建TCP处理器
     auto handler = std::make_unique<TcpHandler>(conn_fd, std::move(unpacker));
     // 设置业务执行回调
     handler->SetCallback(exec_cb_);
-
-    // 注册新连接
-    RegisterProtocol(conn_fd, std::move(handler));
+    handler->SetConnCallback(conn_exec_cb_);
+    handler->SetReadBudget(read_budget_);
+    handler->SetRecvBufferPolicy(resolved);
+    if (family == AF_UNIX) {
+      handler->SetFdCallback(fd_recv_cb_);
+      return handler;
+    }
+    if (zerocopy_threshold_ && !handler->EnableZeroCopy(zerocopy_threshold_))
+      LOGP_WARN("MSG_ZEROCOPY unsupported on fd:%d", conn_fd);
+    return handler;
   }
 
+  // 关闭后等待零拷贝完成通知的最长时间
+  static constexpr uint64_t kZeroCopyDrainMs = 30000;
+
   // epoll与事件循环相关
   int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+  int64_t armed_tick_ = -1; // timerfd当前对应的时间轮tick，-1为未设置
+  AdaptivePoller poller_;
+  ReactorMetrics metrics_;
+  threading::TimingWheel timing_wheel_;
+  uint64_t loop_now_ms_ = 0;
   uint64_t max_events_ = 64;
   std::atomic<bool> running_{true};
+  std::thread::id loop_thread_id_;
+
+  // 跨线程任务投递，循环线程内投递的任务延后到本轮末尾执行
+  std::shared_ptr<LoopTaskQueue> task_queue_;
+  std::vector<LoopTask> deferred_tasks_;
+  std::vector<LoopTask> running_tasks_;
+  AcceptCb accept_cb_;
+
+  // 读侧流控
+  std::shared_ptr<FlowControl> flow_control_;
+  std::vector<ConnId> paused_conns_;
+
+  // 接收抓包
+  std::shared_ptr<TrafficCapture> capture_;
+
+  // 读取预算与待补读连接(轮转)
+  ReadBudget read_budget_;
+  std::vector<ConnId> ready_conns_;
+  std::vector<ConnId> servicing_conns_;
+
+  // 空闲连接接收缓冲区收缩
+  threading::TimerId shrink_sweep_timer_ = 0;
+  uint64_t shrink_sweep_interval_ms_ = 0;
+  bool shrink_sweep_armed_ = false;
 
   // 解包器参数
   containers::HeadKey head_key_{};
@@ -233,16 +1380,18 @@ private:
   containers::DataSzCb data_sz_cb_ = nullptr;
   containers::CheckValidCb check_sz_cb_ = nullptr;
   size_t buffer_size_ = 1024;
+  size_t zerocopy_threshold_ = 0;
 
-  // 处理器业务执行回调
-  ExecCb exec_cb_ = nullptr;
+  // 处理器业务执行回调(所有连接共享)
+  std::shared_ptr<const ExecCb> exec_cb_;
+  std::shared_ptr<const ConnExecCb> conn_exec_cb_;
+  std::shared_ptr<const FdRecvCb> fd_recv_cb_;
 
-  // 协议处理器映射与TCP监听套接字
-  std::unordered_map<int, std::unique_ptr<ProtocolHandler>> protocol_handlers_;
-  std::unordered_set<int> listeners_;
+  // fd索引的连接槽位表(协议处理器、监听套接字、定时器)
+  std::vector<ConnSlot> slots_;
 
-  // 定时线程池依赖
-  std::shared_ptr<threading::TimerScheduler> timer_shceduler_;
+  // 数据包派发器依赖
+  std::shared_ptr<PacketDispatcher> dispatcher_;
 };
 
 } // namespace net
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace net {
+
+/// @brief 单写者计数器
+/// @note 仅由事件循环线程写入，load+store代替原子加，任意线程可无锁读取
+class MetricCounter {
+public:
+  void Add(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n,
+                 std::memory_order_relaxed);
+  }
+  uint64_t Load() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/// @brief 单写者瞬时值
+class MetricGauge {
+public:
+  void Set(uint64_t value) { value_.store(value, std::memory_order_relaxed); }
+  uint64_t Load() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/// @brief 直方图快照
+struct HistogramSnapshot {
+  static constexpr size_t kBuckets = 65;
+
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  // 第i个桶统计[2^(i-1), 2^i)，第0个桶统计0
+  std::array<uint64_t, kBuckets> buckets{};
+
+  double Mean() const {
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0;
+  }
+
+  /// @brief 近似分位数，返回所在桶的上界(不超过最大值)
+  /// @param p 0~1
+  /// @return
+  uint64_t Percentile(double p) const {
+    if (count == 0)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count));
+    if (rank >= count)
+      rank = count - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += buckets[i];
+      if (seen > rank) {
+        uint64_t upper = i == 0 ? 0 : (i >= 64 ? UINT64_MAX : (1ull << i) - 1);
+        return upper < max ? upper : max;
+      }
+    }
+    return max;
+  }
+};
+
+/// @brief 以2的幂分桶的单写者直方图，记录为O(1)且无锁
+class MetricHistogram {
+public:
+  void Record(uint64_t value) {
+    size_t bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    Bump(buckets_[bucket], 1);
+    Bump(count_, 1);
+    Bump(sum_, value);
+    if (value > max_.load(std::memory_order_relaxed))
+      max_.store(value, std::memory_order_relaxed);
+  }
+
+  HistogramSnapshot Snapshot() const {
+    HistogramSnapshot snap;
+    for (size_t i = 0; i < HistogramSnapshot::kBuckets; ++i)
+      snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    snap.count = count_.load(std::memory_order_relaxed);
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    return snap;
+  }
+
+private:
+  static void Bump(std::atomic<uint64_t> &v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, HistogramSnapshot::kBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+/// @brief 事件循环指标快照
+struct ReactorMetricsSnapshot {
+  uint64_t wakeups = 0;         // epoll_wait返回次数
+  uint64_t events = 0;          // 处理的事件总数
+  uint64_t accepts = 0;         // 接受的连接数
+  uint64_t accept_errors = 0;   // accept失败次数
+  uint64_t conns_closed = 0;    // 关闭的连接数
+  uint64_t conn_timeouts = 0;   // 超时关闭的连接数
+  uint64_t read_pauses = 0;     // 流控暂停读取次数
+  uint64_t budget_yields = 0;   // 读取预算用尽让出循环的次数
+  uint64_t loop_tasks = 0;      // 执行的跨线程任务数
+  uint64_t caller_runs = 0;     // 派发器队列满时在循环线程执行的批次数
+  uint64_t shard_stalls = 0;    // 分片派发时目标队列满而等待的次数
+  uint64_t shard_overflows = 0; // 工作线程派发时转入溢出队列的批次数
+  uint64_t uptime_ms = 0;       // 指标开始统计至今
+
+  HistogramSnapshot events_per_wakeup;
+  HistogramSnapshot loop_latency_ns; // 单轮循环处理耗时(不含等待)
+  HistogramSnapshot handler_ns;      // 单个连接事件处理耗时
+  HistogramSnapshot dispatch_depth;  // 每轮采样的派发队列深度
+};
+
+/// @brief 事件循环指标，仅循环线程写入，Snapshot可在任意线程调用
+struct ReactorMetrics {
+  MetricCounter wakeups;
+  MetricCounter events;
+  MetricCounter accepts;
+  MetricCounter accept_errors;
+  MetricCounter conns_closed;
+  MetricCounter conn_timeouts;
+  MetricCounter read_pauses;
+  MetricCounter budget_yields;
+  MetricCounter loop_tasks;
+
+  MetricHistogram events_per_wakeup;
+  MetricHistogram loop_latency_ns;
+  MetricHistogram handler_ns;
+  MetricHistogram dispatch_depth;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  ReactorMetricsSnapshot Snapshot() const {
+    ReactorMetricsSnapshot snap;
+    snap.wakeups = wakeups.Load();
+    snap.events = events.Load();
+    snap.accepts = accepts.Load();
+    snap.accept_errors = accept_errors.Load();
+    snap.conns_closed = conns_closed.Load();
+    snap.conn_timeouts = conn_timeouts.Load();
+    snap.read_pauses = read_pauses.Load();
+    snap.budget_yields = budget_yields.Load();
+    snap.loop_tasks = loop_tasks.Load();
+    snap.uptime_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    snap.events_per_wakeup = events_per_wakeup.Snapshot();
+    snap.loop_latency_ns = loop_latency_ns.Snapshot();
+    snap.handler_ns = handler_ns.Snapshot();
+    snap.dispatch_depth = dispatch_depth.Snapshot();
+    return snap;
+  }
+};
+
+/// @brief 单连接统计快照
+struct ConnStatsSnapshot {
+  uint64_t bytes_read = 0;
+  uint64_t packets_read = 0;   // 解析出的包数(UDP为数据报数)
+  uint64_t read_calls = 0;     // 读系统调用次数
+  uint64_t bytes_written = 0;
+  uint64_t unpack_failures = 0; // 校验失败或缓冲区满无法成包
+  uint64_t recv_buffer_bytes = 0; // 当前接收缓冲区容量
+  uint64_t buffer_resizes = 0;    // 接收缓冲区扩容与收缩次数
+};
+
+/// @brief 单连接统计，由处理器在循环线程更新
+struct ConnStats {
+  MetricCounter bytes_read;
+  MetricCounter packets_read;
+  MetricCounter read_calls;
+  MetricCounter bytes_written;
+  MetricCounter unpack_failures;
+  MetricGauge recv_buffer_bytes;
+  MetricCounter buffer_resizes;
+
+  ConnStatsSnapshot Snapshot() const {
+    ConnStatsSnapshot snap;
+    snap.bytes_read = bytes_read.Load();
+    snap.packets_read = packets_read.Load();
+    snap.read_calls = read_calls.Load();
+    snap.bytes_written = bytes_written.Load();
+    snap.unpack_failures = unpack_failures.Load();
+    snap.recv_buffer_bytes = recv_buffer_bytes.Load();
+    snap.buffer_resizes = buffer_resizes.Load();
+    return snap;
+  }
+};
+
+} // namespace net
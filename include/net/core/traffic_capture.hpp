@@ -0,0 +1,281 @@
+#pragma once
+#include "../../logger/logger.hpp"
+#include "../transport/enums.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <memory>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace net {
+
+/// @brief 抓包记录的来源
+enum class CaptureKind : uint8_t {
+  kStream = 1,   // 流式连接的一次read
+  kDatagram = 2, // 一个数据报
+};
+
+/// @brief 一条接收记录，data指向映射的抓包文件
+struct CaptureRecord {
+  uint64_t time_ns = 0; // 相对抓包开始的单调时间
+  ConnId conn_id = 0;
+  CaptureKind kind = CaptureKind::kStream;
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+};
+
+/// @brief 抓包文件格式
+/// @note 文件头32字节，其后为8字节对齐的记录：
+/// 时间8 连接ID8 长度4 类型1 保留3 负载(补齐到8字节)。类型最后写入，
+/// 为0的记录视为未写完(进程异常退出时)，读取到此为止
+struct CaptureFormat {
+  static constexpr uint32_t kMagic = 0x5041434e; // "NCAP"
+  static constexpr uint16_t kVersion = 1;
+  static constexpr size_t kFileHeader = 32;
+  static constexpr size_t kRecordHeader = 24;
+
+  struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t start_unix_ns; // 抓包开始的墙上时间
+    uint64_t reserved2[2];
+  };
+  static_assert(sizeof(FileHeader) == kFileHeader, "capture file header");
+
+  static uint64_t RecordSize(size_t size) {
+    return (kRecordHeader + size + 7) & ~static_cast<uint64_t>(7);
+  }
+};
+
+/// @brief 接收数据抓包写入器
+/// @note 记录按原始读取粒度保存(一次read或一个数据报一条)，保留分段方式，
+/// 供离线回放基准测试解析器。文件预先映射为稀疏文件，追加只是一次原子预留
+/// 加内存拷贝，多个事件循环可共享同一写入器；写满后丢弃并计数。
+/// 由ReactorCore::SetCapture注入各连接处理器
+class TrafficCapture {
+public:
+  /// @brief 创建抓包文件
+  /// @param path 已存在则覆盖
+  /// @param max_bytes 文件上限，按需占用磁盘
+  /// @return 失败返回nullptr
+  static std::shared_ptr<TrafficCapture> Open(const std::string &path,
+                                              size_t max_bytes) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      LOGP_ERROR("capture open %s failed,errno:%d", path.c_str(), errno);
+      return nullptr;
+    }
+    max_bytes = std::max(max_bytes, CaptureFormat::kFileHeader);
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(max_bytes)) == 0)
+      base = mmap(nullptr, max_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      LOGP_ERROR("capture map %s failed,errno:%d", path.c_str(), errno);
+      close(fd);
+      return nullptr;
+    }
+    return std::shared_ptr<TrafficCapture>(
+        new TrafficCapture(fd, static_cast<uint8_t *>(base), max_bytes));
+  }
+
+  TrafficCapture(const TrafficCapture &) = delete;
+  TrafficCapture &operator=(const TrafficCapture &) = delete;
+
+  ~TrafficCapture() { Close(); }
+
+  /// @brief 追加一条记录，线程安全
+  /// @param conn_id
+  /// @param kind
+  /// @param data
+  /// @param size
+  /// @return 文件已满或已关闭返回false
+  bool Append(ConnId conn_id, CaptureKind kind, const uint8_t *data,
+              size_t size) {
+    if (!enabled_.load(std::memory_order_relaxed))
+      return false;
+    uint64_t need = CaptureFormat::RecordSize(size);
+    uint64_t offset = used_.load(std::memory_order_relaxed);
+    do {
+      // 放不下的记录丢弃，之后的小记录仍可能放得下
+      if (offset + need > capacity_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    } while (!used_.compare_exchange_weak(offset, offset + need,
+                                          std::memory_order_relaxed));
+    uint8_t *record = base_ + offset;
+    uint64_t time_ns = MonotonicNs() - start_ns_;
+    uint32_t length = static_cast<uint32_t>(size);
+    memcpy(record, &time_ns, sizeof(time_ns));
+    memcpy(record + 8, &conn_id, sizeof(conn_id));
+    memcpy(record + 16, &length, sizeof(length));
+    if (size)
+      memcpy(record + CaptureFormat::kRecordHeader, data, size);
+    reinterpret_cast<std::atomic<uint8_t> *>(record + 20)->store(
+        static_cast<uint8_t>(kind), std::memory_order_release);
+    records_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// @brief 停止抓包，截断文件到实际长度并解除映射
+  /// @note 需在所有写入方停止后调用(如事件循环停止后)
+  void Close() {
+    if (!base_)
+      return;
+    enabled_.store(false, std::memory_order_relaxed);
+    size_t used = used_.load();
+    munmap(base_, capacity_);
+    base_ = nullptr;
+    if (ftruncate(fd_, static_cast<off_t>(used)) != 0)
+      LOGP_WARN("capture truncate failed,errno:%d", errno);
+    close(fd_);
+    fd_ = -1;
+  }
+
+  /// @brief 暂停或恢复抓包
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled && base_, std::memory_order_relaxed);
+  }
+
+  /// @brief 已写入的记录数
+  uint64_t Records() const { return records_.load(std::memory_order_relaxed); }
+
+  /// @brief 因文件写满丢弃的记录数
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  /// @brief 已使用的字节数(含文件头)
+  size_t Bytes() const {
+    return used_.load(std::memory_order_relaxed);
+  }
+
+private:
+  TrafficCapture(int fd, uint8_t *base, size_t capacity)
+      : fd_(fd), base_(base), capacity_(capacity),
+        start_ns_(MonotonicNs()) {
+    CaptureFormat::FileHeader header{};
+    header.magic = CaptureFormat::kMagic;
+    header.version = CaptureFormat::kVersion;
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    header.start_unix_ns =
+        static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+    memcpy(base_, &header, sizeof(header));
+  }
+
+  static uint64_t MonotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+  }
+
+  int fd_;
+  uint8_t *base_;
+  size_t capacity_;
+  uint64_t start_ns_;
+  std::atomic<bool> enabled_{true};
+  std::atomic<uint64_t> used_{CaptureFormat::kFileHeader};
+  std::atomic<uint64_t> records_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/// @brief 只读映射抓包文件并按写入顺序遍历记录
+class CaptureReader {
+public:
+  /// @brief 打开抓包文件
+  /// @param path
+  /// @return 失败或格式不符返回nullptr
+  static std::unique_ptr<CaptureReader> Open(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      LOGP_ERROR("capture reader open %s failed,errno:%d", path.c_str(),
+                 errno);
+      return nullptr;
+    }
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) >= CaptureFormat::kFileHeader)
+      base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      LOGP_ERROR("capture reader map %s failed", path.c_str());
+      return nullptr;
+    }
+    std::unique_ptr<CaptureReader> reader(new CaptureReader(
+        static_cast<const uint8_t *>(base), static_cast<size_t>(st.st_size)));
+    CaptureFormat::FileHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (header.magic != CaptureFormat::kMagic ||
+        header.version != CaptureFormat::kVersion) {
+      LOGP_ERROR("capture reader %s: bad header", path.c_str());
+      return nullptr;
+    }
+    reader->start_unix_ns_ = header.start_unix_ns;
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+    return reader;
+  }
+
+  CaptureReader(const CaptureReader &) = delete;
+  CaptureReader &operator=(const CaptureReader &) = delete;
+
+  ~CaptureReader() { munmap(const_cast<uint8_t *>(base_), size_); }
+
+  /// @brief 遍历全部记录
+  /// @param cb bool(const CaptureRecord &)，返回false停止
+  /// @return 遍历的记录数
+  template <typename F> size_t ForEach(F &&cb) const {
+    size_t offset = CaptureFormat::kFileHeader;
+    size_t count = 0;
+    CaptureRecord record;
+    while (Read(offset, record)) {
+      count++;
+      if (!cb(record))
+        break;
+    }
+    return count;
+  }
+
+  /// @brief 读取offset处的记录并前移offset
+  /// @param offset 首条记录位于CaptureFormat::kFileHeader
+  /// @param record
+  /// @return 已到末尾或记录未写完返回false
+  bool Read(size_t &offset, CaptureRecord &record) const {
+    if (offset + CaptureFormat::kRecordHeader > size_)
+      return false;
+    const uint8_t *p = base_ + offset;
+    uint8_t kind = p[20];
+    uint32_t length;
+    memcpy(&length, p + 16, sizeof(length));
+    if (kind == 0 ||
+        offset + CaptureFormat::kRecordHeader + length > size_)
+      return false;
+    memcpy(&record.time_ns, p, sizeof(record.time_ns));
+    memcpy(&record.conn_id, p + 8, sizeof(record.conn_id));
+    record.kind = static_cast<CaptureKind>(kind);
+    record.data = p + CaptureFormat::kRecordHeader;
+    record.size = length;
+    offset += CaptureFormat::RecordSize(length);
+    return true;
+  }
+
+  /// @brief 抓包开始的墙上时间(ns)
+  uint64_t StartUnixNs() const { return start_unix_ns_; }
+
+  /// @brief 文件字节数
+  size_t Size() const { return size_; }
+
+private:
+  CaptureReader(const uint8_t *base, size_t size) : base_(base), size_(size) {}
+
+  const uint8_t *base_;
+  size_t size_;
+  uint64_t start_unix_ns_ = 0;
+};
+
+} // namespace net
@@ -0,0 +1,242 @@
+#pragma once
+// 协程层需要C++20协程支持，低于C++20编译时本头文件为空
+#if defined(__cpp_impl_coroutine)
+#include "../core/reactor_core.hpp"
+#include "task.hpp"
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace net {
+namespace coro {
+
+/// @brief 挂起当前协程，定时器到期后在循环线程恢复
+/// @note 仅限循环线程co_await
+class SleepAwaiter {
+public:
+  SleepAwaiter(ReactorCore &reactor, uint64_t delay_ms)
+      : reactor_(reactor), delay_ms_(delay_ms) {}
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    reactor_.RunAfter(delay_ms_, [handle]() { handle.resume(); });
+  }
+  void await_resume() const noexcept {}
+
+private:
+  ReactorCore &reactor_;
+  uint64_t delay_ms_;
+};
+
+/// @brief co_await SleepFor(reactor, 100ms)
+inline SleepAwaiter SleepFor(ReactorCore &reactor,
+                             std::chrono::milliseconds delay) {
+  return SleepAwaiter(reactor, static_cast<uint64_t>(delay.count()));
+}
+
+/// @brief 主动连接结果
+struct ConnectResult {
+  ConnId conn_id = 0;
+  int error = 0; // 0为成功，否则为errno
+};
+
+/// @brief 发起非阻塞连接，建立或失败后在循环线程恢复
+class ConnectAwaiter {
+public:
+  ConnectAwaiter(ReactorCore &reactor, std::string host, uint16_t port,
+                 ConnectOptions options)
+      : reactor_(reactor), host_(std::move(host)), port_(port),
+        options_(std::move(options)) {}
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    // 结果总是异步回调，不会在await_suspend内恢复
+    reactor_.Connect(
+        host_, port_,
+        [this, handle](ConnId conn_id, int error) {
+          result_.conn_id = conn_id;
+          result_.error = error;
+          handle.resume();
+        },
+        std::move(options_));
+  }
+  ConnectResult await_resume() const noexcept { return result_; }
+
+private:
+  ReactorCore &reactor_;
+  std::string host_;
+  uint16_t port_;
+  ConnectOptions options_;
+  ConnectResult result_;
+};
+
+/// @brief co_await ConnectAsync(reactor, "127.0.0.1", 8080)
+inline ConnectAwaiter ConnectAsync(ReactorCore &reactor, std::string host,
+                                   uint16_t port,
+                                   ConnectOptions options = ConnectOptions()) {
+  return ConnectAwaiter(reactor, std::move(host), port, std::move(options));
+}
+
+/// @brief 协程化的连接
+/// 接管连接后，解析出的包不再派发给工作线程，而是在循环线程排队并直接恢复
+/// 等待中的ReadFrame；恢复放在本轮事件处理之后执行，不经eventfd与工作线程
+/// @note 仅限循环线程创建与使用；对象析构时关闭仍打开的连接，需保留连接时先Release
+class CoConnection {
+  struct State {
+    std::deque<std::vector<uint8_t>> frames;
+    std::coroutine_handle<> waiter;
+    bool closed = false;
+    bool resume_queued = false;
+    CloseCb previous_close_cb;
+  };
+
+public:
+  /// @brief 读取一个完整包
+  class FrameAwaiter {
+  public:
+    explicit FrameAwaiter(State &state) : state_(state) {}
+    bool await_ready() const noexcept {
+      return !state_.frames.empty() || state_.closed;
+    }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      state_.waiter = handle;
+    }
+    /// @return 连接关闭且无剩余包时为空
+    std::optional<std::vector<uint8_t>> await_resume() {
+      if (state_.frames.empty())
+        return std::nullopt;
+      std::vector<uint8_t> frame = std::move(state_.frames.front());
+      state_.frames.pop_front();
+      return frame;
+    }
+
+  private:
+    State &state_;
+  };
+
+  /// @brief 写入结果，数据已追加到发送队列
+  class WriteAwaiter {
+  public:
+    explicit WriteAwaiter(bool open) : open_(open) {}
+    bool await_ready() const noexcept { return true; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    /// @return 连接是否仍然打开
+    bool await_resume() const noexcept { return open_; }
+
+  private:
+    bool open_;
+  };
+
+  /// @brief 接管连接
+  /// @param reactor
+  /// @param conn_id 已建立的连接(accept回调或ConnectAsync的结果)
+  CoConnection(ReactorCore &reactor, ConnId conn_id)
+      : reactor_(&reactor), conn_id_(conn_id),
+        state_(std::make_shared<State>()) {
+    std::weak_ptr<State> weak = state_;
+    ReactorCore *r = reactor_;
+    bool attached = reactor_->SetConnInlineCallback(
+        conn_id_,
+        [weak, r](ConnId, std::vector<std::vector<uint8_t>> &packs) {
+          auto state = weak.lock();
+          if (!state)
+            return;
+          for (auto &pack : packs)
+            state->frames.push_back(std::move(pack));
+          Wake(*r, state);
+        });
+    attached = attached &&
+               reactor_->SetCloseCallback(
+                   conn_id_,
+                   [weak, r](ConnId conn_id) {
+                     auto state = weak.lock();
+                     if (!state)
+                       return;
+                     state->closed = true;
+                     if (state->previous_close_cb)
+                       state->previous_close_cb(conn_id);
+                     Wake(*r, state);
+                   },
+                   &state_->previous_close_cb);
+    if (!attached)
+      state_->closed = true;
+  }
+
+  CoConnection(CoConnection &&other) noexcept
+      : reactor_(other.reactor_), conn_id_(other.conn_id_),
+        state_(std::move(other.state_)) {}
+  CoConnection &operator=(CoConnection &&) = delete;
+  CoConnection(const CoConnection &) = delete;
+  CoConnection &operator=(const CoConnection &) = delete;
+
+  ~CoConnection() {
+    if (!state_)
+      return;
+    state_->waiter = {};
+    if (!state_->closed)
+      reactor_->Close(conn_id_);
+  }
+
+  /// @brief co_await conn.ReadFrame()
+  FrameAwaiter ReadFrame() { return FrameAwaiter(*state_); }
+
+  /// @brief co_await conn.Write(data)，追加到发送队列并尽量立即写出，不等待写完
+  /// @param data
+  WriteAwaiter Write(std::vector<uint8_t> data) {
+    if (state_->closed)
+      return WriteAwaiter(false);
+    reactor_->Send(conn_id_, std::move(data));
+    return WriteAwaiter(!state_->closed);
+  }
+
+  /// @brief 关闭连接，之后ReadFrame返回剩余包后返回空
+  void Close() {
+    if (!state_->closed)
+      reactor_->Close(conn_id_);
+  }
+
+  /// @brief 交还连接：恢复派发给工作线程与原关闭回调，对象不再管理该连接
+  /// @return
+  ConnId Release() {
+    if (state_ && !state_->closed) {
+      reactor_->SetConnInlineCallback(conn_id_, nullptr);
+      reactor_->SetCloseCallback(conn_id_,
+                                 std::move(state_->previous_close_cb));
+    }
+    state_.reset();
+    return conn_id_;
+  }
+
+  ConnId Id() const { return conn_id_; }
+  bool IsOpen() const { return state_ && !state_->closed; }
+
+private:
+  /// @brief 唤醒等待中的读取，恢复延后到本轮事件处理之后
+  static void Wake(ReactorCore &reactor, const std::shared_ptr<State> &state) {
+    if (!state->waiter || state->resume_queued)
+      return;
+    state->resume_queued = true;
+    std::weak_ptr<State> weak = state;
+    reactor.QueueInLoop([weak]() {
+      auto state = weak.lock();
+      if (!state)
+        return;
+      state->resume_queued = false;
+      std::coroutine_handle<> waiter = std::exchange(state->waiter, {});
+      if (waiter)
+        waiter.resume();
+    });
+  }
+
+  ReactorCore *reactor_;
+  ConnId conn_id_;
+  std::shared_ptr<State> state_;
+};
+
+} // namespace coro
+} // namespace net
+#endif
@@ -0,0 +1,239 @@
+#pragma once
+// 协程层需要C++20协程支持，低于C++20编译时本头文件为空
+#if defined(__cpp_impl_coroutine)
+#include "../../logger/logger.hpp"
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace net {
+namespace coro {
+
+/// @brief 协程帧内存池
+/// 按2的幂分级缓存释放的帧，同一线程内反复创建销毁的协程不再走全局分配器
+/// @note 空闲链表按线程独立，无锁；超过最大级别的帧直接使用operator new
+class FramePool {
+public:
+  static void *Allocate(size_t size) {
+    size_t level = Level(size);
+    if (level >= kLevels)
+      return ::operator new(size);
+    FreeList &list = Lists()[level];
+    if (list.head) {
+      Node *node = list.head;
+      list.head = node->next;
+      list.count--;
+      return node;
+    }
+    return ::operator new(kMinSize << level);
+  }
+
+  static void Deallocate(void *ptr, size_t size) {
+    size_t level = Level(size);
+    if (level >= kLevels) {
+      ::operator delete(ptr);
+      return;
+    }
+    FreeList &list = Lists()[level];
+    if (list.count >= kMaxCached) {
+      ::operator delete(ptr);
+      return;
+    }
+    Node *node = static_cast<Node *>(ptr);
+    node->next = list.head;
+    list.head = node;
+    list.count++;
+  }
+
+private:
+  static constexpr size_t kMinSize = 64;  // 最小级别(字节)
+  static constexpr size_t kLevels = 8;    // 64B ~ 8KB
+  static constexpr size_t kMaxCached = 256; // 每级最多缓存的帧数
+
+  struct Node {
+    Node *next;
+  };
+
+  struct FreeList {
+    Node *head = nullptr;
+    size_t count = 0;
+
+    ~FreeList() {
+      while (head) {
+        Node *next = head->next;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  };
+
+  static size_t Level(size_t size) {
+    size_t level = 0;
+    while ((kMinSize << level) < size && level < kLevels)
+      ++level;
+    return level;
+  }
+
+  static std::array<FreeList, kLevels> &Lists() {
+    thread_local std::array<FreeList, kLevels> lists;
+    return lists;
+  }
+};
+
+/// @brief 协程承诺类型公共部分：帧从内存池分配，结束时对称转移到等待者
+struct PromiseBase {
+  static void *operator new(size_t size) { return FramePool::Allocate(size); }
+  static void operator delete(void *ptr, size_t size) {
+    FramePool::Deallocate(ptr, size);
+  }
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      std::coroutine_handle<> continuation = handle.promise().continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() { exception = std::current_exception(); }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+};
+
+/// @brief 惰性协程任务，被co_await时才开始执行，结果与异常经co_await返回
+/// @tparam T 返回值类型
+template <typename T = void> class Task {
+public:
+  struct promise_type : PromiseBase {
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    template <typename U> void return_value(U &&value) {
+      result.emplace(std::forward<U>(value));
+    }
+    std::optional<T> result;
+  };
+
+  Task() = default;
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+  ~Task() { Reset(); }
+
+  bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+  T await_resume() {
+    if (handle_.promise().exception)
+      std::rethrow_exception(handle_.promise().exception);
+    return std::move(*handle_.promise().result);
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+  void Reset() {
+    if (handle_)
+      handle_.destroy();
+    handle_ = {};
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <> class Task<void> {
+public:
+  struct promise_type : PromiseBase {
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    void return_void() {}
+  };
+
+  Task() = default;
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+  ~Task() { Reset(); }
+
+  bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+  void await_resume() {
+    if (handle_.promise().exception)
+      std::rethrow_exception(handle_.promise().exception);
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+  void Reset() {
+    if (handle_)
+      handle_.destroy();
+    handle_ = {};
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+/// @brief 分离执行的顶层协程，立即开始，结束时自行销毁
+struct Detached {
+  struct promise_type : PromiseBase {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() {
+      try {
+        std::rethrow_exception(std::current_exception());
+      } catch (const std::exception &e) {
+        LOGP_ERROR("detached coroutine exception:%s", e.what());
+      } catch (...) {
+        LOGP_ERROR("detached coroutine unknown exception");
+      }
+    }
+  };
+};
+
+inline Detached RunDetached(Task<void> task) { co_await task; }
+
+} // namespace detail
+
+/// @brief 分离启动协程任务，在当前线程立即执行到第一个挂起点
+/// @note 一般在循环线程调用(如accept回调、RunInLoop内)，未捕获的异常记录日志后丢弃
+/// @param task
+inline void Spawn(Task<void> task) { detail::RunDetached(std::move(task)); }
+
+} // namespace coro
+} // namespace net
+#endif
@@ -0,0 +1,676 @@
+#pragma once
+#include "stream_handler.hpp"
+#include <array>
+#include <charconv>
+#include <ctime>
+#include <string>
+#include <string_view>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace net {
+
+/// @brief HTTP请求头字段，视图指向连接接收缓冲区
+struct HttpHeader {
+  std::string_view name;
+  std::string_view value;
+};
+
+/// @brief 原地解析的HTTP/1.x请求
+/// @note 所有视图指向连接接收缓冲区，仅在请求回调内有效，需保留时自行拷贝
+struct HttpRequest {
+  static constexpr size_t kMaxHeaders = 64;
+
+  ConnId conn_id = 0;
+  std::string_view method;
+  std::string_view target; // 请求目标原文(路径+查询)
+  std::string_view path;
+  std::string_view query; // 不含'?'
+  int minor_version = 1;  // HTTP/1.x
+  std::array<HttpHeader, kMaxHeaders> headers;
+  size_t header_count = 0;
+  std::string_view body; // 分块请求体已原地解码
+  bool keep_alive = true;
+
+  /// @brief 按名称查找请求头(不区分大小写)
+  /// @param name
+  /// @return 不存在返回空视图
+  std::string_view Header(std::string_view name) const;
+};
+
+/// @brief HTTP请求头解析
+/// @note 请求行与请求头原地切分为视图，不为单个字段分配内存；
+/// 请求头结束符的查找使用SSE2按16字节批量比较
+class HttpParser {
+public:
+  /// @brief 查找请求头结束符"\r\n\r\n"
+  /// @param data 请求起始
+  /// @param from 从该偏移继续查找(此前的部分已确认不含结束符)
+  /// @param len 已收到的字节数
+  /// @return 请求头长度(含结束符)，未收全返回0
+  static size_t FindHeadEnd(const char *data, size_t from, size_t len) {
+    const char *p = data + from;
+    const char *end = data + len;
+#if defined(__SSE2__)
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+      unsigned mask =
+          static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf)));
+      while (mask) {
+        const char *q = p + __builtin_ctz(mask);
+        if (IsHeadEnd(data, q))
+          return q + 1 - data;
+        mask &= mask - 1;
+      }
+      p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+      if (*p == '\n' && IsHeadEnd(data, p))
+        return p + 1 - data;
+    }
+    return 0;
+  }
+
+  /// @brief 解析请求行与请求头
+  /// @param data 请求起始
+  /// @param len 请求头长度(FindHeadEnd的结果)
+  /// @param request 输出，视图指向data
+  /// @return 0为成功，否则为应答的错误状态码
+  static int ParseHead(const char *data, size_t len, HttpRequest &request) {
+    const char *end = data + len;
+    const char *line_end = FindCr(data, end);
+    if (!line_end || line_end[1] != '\n')
+      return 400;
+
+    // 请求行: method SP target SP HTTP/1.x
+    const char *sp1 = static_cast<const char *>(memchr(data, ' ', line_end - data));
+    if (!sp1 || sp1 == data)
+      return 400;
+    const char *sp2 =
+        static_cast<const char *>(memchr(sp1 + 1, ' ', line_end - sp1 - 1));
+    if (!sp2 || sp2 == sp1 + 1)
+      return 400;
+    std::string_view version(sp2 + 1, line_end - sp2 - 1);
+    if (version.size() != 8 || version.compare(0, 5, "HTTP/") != 0)
+      return 400;
+    if (version[5] != '1' || version[6] != '.' || version[7] < '0' ||
+        version[7] > '9')
+      return 505;
+    request.method = std::string_view(data, sp1 - data);
+    request.target = std::string_view(sp1 + 1, sp2 - sp1 - 1);
+    request.minor_version = version[7] - '0';
+    size_t question = request.target.find('?');
+    request.path = request.target.substr(0, question);
+    request.query = question == std::string_view::npos
+                        ? std::string_view()
+                        : request.target.substr(question + 1);
+
+    // 请求头: name ":" OWS value OWS，以空行结束
+    request.header_count = 0;
+    request.keep_alive = request.minor_version >= 1;
+    const char *p = line_end + 2;
+    while (p < end) {
+      line_end = FindCr(p, end);
+      if (!line_end || line_end[1] != '\n')
+        return 400;
+      if (line_end == p)
+        break;
+      // 不支持已废弃的续行
+      if (*p == ' ' || *p == '\t')
+        return 400;
+      const char *colon =
+          static_cast<const char *>(memchr(p, ':', line_end - p));
+      if (!colon || colon == p)
+        return 400;
+      std::string_view name(p, colon - p);
+      if (name.find_first_of(" \t") != std::string_view::npos)
+        return 400;
+      if (request.header_count == HttpRequest::kMaxHeaders)
+        return 431;
+      HttpHeader &header = request.headers[request.header_count++];
+      header.name = name;
+      header.value = Trim(std::string_view(colon + 1, line_end - colon - 1));
+      if (EqualsIgnoreCase(name, "Connection")) {
+        if (HasToken(header.value, "close"))
+          request.keep_alive = false;
+        else if (HasToken(header.value, "keep-alive"))
+          request.keep_alive = true;
+      }
+      p = line_end + 2;
+    }
+    return 0;
+  }
+
+  /// @brief ASCII不区分大小写比较
+  static bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (ToLower(a[i]) != ToLower(b[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// @brief 逗号分隔的列表中是否包含指定标记(不区分大小写)
+  static bool HasToken(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+      size_t comma = list.find(',');
+      if (EqualsIgnoreCase(Trim(list.substr(0, comma)), token))
+        return true;
+      if (comma == std::string_view::npos)
+        break;
+      list.remove_prefix(comma + 1);
+    }
+    return false;
+  }
+
+  /// @brief 逗号分隔的列表中最后一个标记
+  static std::string_view LastToken(std::string_view list) {
+    size_t comma = list.rfind(',');
+    return Trim(comma == std::string_view::npos ? list
+                                                : list.substr(comma + 1));
+  }
+
+  /// @brief 严格解析十进制Content-Length
+  /// @return 非数字或溢出返回false
+  static bool ParseContentLength(std::string_view value, size_t &length) {
+    if (value.empty())
+      return false;
+    auto [ptr, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), length);
+    return ec == std::errc() && ptr == value.data() + value.size();
+  }
+
+  static std::string_view Trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+      s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+      s.remove_suffix(1);
+    return s;
+  }
+
+private:
+  static char ToLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+
+  /// @brief p处的'\n'是否为"\r\n\r\n"的结尾
+  static bool IsHeadEnd(const char *data, const char *p) {
+    return p - data >= 3 && p[-1] == '\r' && p[-2] == '\n' && p[-3] == '\r';
+  }
+
+  /// @brief 查找行尾'\r'，要求其后至少还有一个字节
+  /// @note glibc的memchr已按CPU特性向量化
+  static const char *FindCr(const char *p, const char *end) {
+    if (end - p < 2)
+      return nullptr;
+    return static_cast<const char *>(memchr(p, '\r', end - p - 1));
+  }
+};
+
+inline std::string_view HttpRequest::Header(std::string_view name) const {
+  for (size_t i = 0; i < header_count; ++i) {
+    if (HttpParser::EqualsIgnoreCase(headers[i].name, name))
+      return headers[i].value;
+  }
+  return std::string_view();
+}
+
+/// @brief 分块传输请求体的增量扫描，数据收全后原地解码
+/// @note 每次到达新数据只从上次停下的分块继续扫描，不重复扫描已完整的分块
+class ChunkedDecoder {
+public:
+  enum class Result { kComplete, kIncomplete, kError };
+
+  /// @brief 继续扫描请求体
+  /// @param body 请求体起始(请求头之后)
+  /// @param len 已收到的请求体字节数
+  /// @return kComplete时End()为请求体(含末尾分块与尾部字段)总长度
+  Result Scan(const char *body, size_t len) {
+    while (true) {
+      const char *line = body + offset_;
+      size_t avail = len - offset_;
+      const char *cr = avail >= 2 ? static_cast<const char *>(
+                                        memchr(line, '\r', avail - 1))
+                                  : nullptr;
+      if (!cr)
+        return avail > kMaxLineSize ? Result::kError : Result::kIncomplete;
+      if (cr[1] != '\n')
+        return Result::kError;
+      size_t line_size = cr + 2 - line;
+
+      // 末尾分块之后为尾部字段，以空行结束
+      if (last_chunk_) {
+        offset_ += line_size;
+        if (cr == line)
+          return Result::kComplete;
+        continue;
+      }
+
+      size_t size = 0;
+      if (!ParseChunkSize(line, cr, size))
+        return Result::kError;
+      if (size == 0) {
+        offset_ += line_size;
+        last_chunk_ = true;
+        continue;
+      }
+      if (avail < line_size + size + 2)
+        return Result::kIncomplete;
+      if (line[line_size + size] != '\r' || line[line_size + size + 1] != '\n')
+        return Result::kError;
+      offset_ += line_size + size + 2;
+      decoded_ += size;
+    }
+  }
+
+  /// @brief 原地解码已完整扫描的请求体，分块数据前移拼接到body起始
+  /// @return 解码后的长度
+  size_t DecodeInPlace(char *body) const {
+    const char *p = body;
+    const char *end = body + offset_;
+    char *out = body;
+    while (true) {
+      const char *cr = static_cast<const char *>(memchr(p, '\r', end - p));
+      size_t size = 0;
+      ParseChunkSize(p, cr, size);
+      p = cr + 2;
+      if (size == 0)
+        break;
+      memmove(out, p, size);
+      out += size;
+      p += size + 2;
+    }
+    return out - body;
+  }
+
+  size_t End() const { return offset_; }
+  size_t DecodedSize() const { return decoded_; }
+
+  void Reset() {
+    offset_ = 0;
+    decoded_ = 0;
+    last_chunk_ = false;
+  }
+
+private:
+  static constexpr size_t kMaxLineSize = 4096; // 分块长度行与尾部字段行上限
+  static constexpr size_t kMaxChunkSize = size_t(1) << 40;
+
+  /// @brief 解析十六进制分块长度，忽略分块扩展
+  static bool ParseChunkSize(const char *p, const char *end, size_t &size) {
+    const char *semi =
+        static_cast<const char *>(memchr(p, ';', end - p));
+    std::string_view digits =
+        HttpParser::Trim(std::string_view(p, (semi ? semi : end) - p));
+    if (digits.empty())
+      return false;
+    auto [ptr, ec] =
+        std::from_chars(digits.data(), digits.data() + digits.size(), size, 16);
+    return ec == std::errc() && ptr == digits.data() + digits.size() &&
+           size < kMaxChunkSize;
+  }
+
+  size_t offset_ = 0;  // 下一分块长度行(或尾部字段行)的偏移
+  size_t decoded_ = 0; // 已扫描分块的数据总长
+  bool last_chunk_ = false;
+};
+
+/// @brief HTTP响应，由请求回调填写，处理器负责序列化
+/// @note Date、Content-Length与Connection由处理器生成，回调无需添加
+class HttpResponse {
+public:
+  /// @brief 设置状态码，默认200
+  /// @param status
+  /// @param reason 为空时使用标准短语
+  void SetStatus(int status, std::string_view reason = std::string_view()) {
+    status_ = status;
+    reason_.assign(reason.data(), reason.size());
+  }
+
+  /// @brief 追加响应头
+  /// @param name
+  /// @param value
+  void AddHeader(std::string_view name, std::string_view value) {
+    headers_.append(name.data(), name.size());
+    headers_.append(": ", 2);
+    headers_.append(value.data(), value.size());
+    headers_.append("\r\n", 2);
+  }
+
+  /// @brief 设置响应体，拷贝到连接复用的缓冲中与响应头合并写出
+  /// @param body
+  void SetBody(std::string_view body) {
+    body_.assign(body.data(), body.size());
+    shared_body_.reset();
+  }
+
+  /// @brief 设置共享响应体，不经拷贝，与响应头一起经writev写出
+  /// @param body 写完前保持存活，调用方不得修改
+  void SetBody(std::shared_ptr<const std::vector<uint8_t>> body) {
+    body_.clear();
+    shared_body_ = std::move(body);
+  }
+
+  /// @brief 响应后关闭连接
+  void SetClose() { close_ = true; }
+
+  int Status() const { return status_; }
+
+private:
+  friend class HttpHandler;
+
+  void Reset() {
+    status_ = 200;
+    reason_.clear();
+    headers_.clear();
+    body_.clear();
+    shared_body_.reset();
+    close_ = false;
+  }
+
+  size_t BodySize() const {
+    return shared_body_ ? shared_body_->size() : body_.size();
+  }
+
+  int status_ = 200;
+  std::string reason_;
+  std::string headers_; // 已序列化的响应头，清空保留容量
+  std::string body_;
+  std::shared_ptr<const std::vector<uint8_t>> shared_body_;
+  bool close_ = false;
+};
+
+/// @brief HTTP请求回调，在循环线程执行，返回时响应即被序列化
+/// @note 回调不应阻塞；request的视图仅在回调内有效
+using HttpRequestCb =
+    std::function<void(const HttpRequest &request, HttpResponse &response)>;
+
+/// @brief HTTP连接限制
+struct HttpLimits {
+  size_t initial_buffer_size = 4096;       // 接收缓冲区初始容量
+  size_t max_request_size = 1024 * 1024;   // 单个请求(头+体)上限，亦为缓冲区上限
+  size_t max_pending_output = 4 << 20;     // 待发送响应超过该值时暂停读取
+};
+
+/// @brief HTTP/1.1服务端协议处理器
+/// @note 在接收环形缓冲区上原地解析，支持keep-alive、管线化与分块请求体；
+/// 一次读取解析出的所有请求在循环线程依次回调，响应按序合并后一次写出，
+/// 共享响应体作为独立块经writev与响应头一起发送
+class HttpHandler : public StreamHandler {
+public:
+  HttpHandler(int fd, std::shared_ptr<const HttpRequestCb> cb,
+              const HttpLimits &limits = HttpLimits())
+      : StreamHandler(fd, limits.initial_buffer_size, limits.max_request_size,
+                      limits.max_pending_output),
+        cb_(std::move(cb)), limits_(limits) {}
+
+  /// @brief 创建供ReactorCore::SetHandlerFactory使用的工厂，连接共享同一份回调
+  /// @param cb
+  /// @param limits
+  /// @return
+  static HandlerFactory Factory(HttpRequestCb cb,
+                                const HttpLimits &limits = HttpLimits()) {
+    auto shared = std::make_shared<const HttpRequestCb>(std::move(cb));
+    return [shared, limits](int conn_fd,
+                            int) -> std::unique_ptr<ProtocolHandler> {
+      return std::make_unique<HttpHandler>(conn_fd, shared, limits);
+    };
+  }
+
+protected:
+  /// @brief 解析并回调缓冲区中所有完整的请求
+  /// @return 处理的请求数
+  size_t ProcessBuffer(ConnId conn_id) override {
+    size_t handled = 0;
+    while (!close_after_flush_) {
+      auto [read_ptr, length] = buffer_.GetLinearReadSpace();
+      // 原地解码分块请求体需要写入接收缓冲区
+      char *data = reinterpret_cast<char *>(const_cast<uint8_t *>(read_ptr));
+      if (length == 0)
+        break;
+
+      if (head_size_ == 0) {
+        // 请求之间多余的空行
+        if (length >= 2 && data[0] == '\r' && data[1] == '\n') {
+          buffer_.CommitReadSize(2);
+          continue;
+        }
+        size_t head_size = HttpParser::FindHeadEnd(data, head_scanned_, length);
+        if (head_size == 0) {
+          head_scanned_ = length;
+          break;
+        }
+        head_scanned_ = 0;
+        int status = HttpParser::ParseHead(data, head_size, request_);
+        if (status == 0)
+          status = ResolveFraming(length - head_size);
+        if (status != 0) {
+          Reject(status);
+          break;
+        }
+        head_size_ = head_size;
+        head_parsed_ = true;
+      }
+
+      // 请求体收全
+      size_t body_size = body_size_;
+      size_t message_size = 0;
+      if (chunked_) {
+        ChunkedDecoder::Result result =
+            chunked_decoder_.Scan(data + head_size_, length - head_size_);
+        if (result == ChunkedDecoder::Result::kError) {
+          Reject(400);
+          break;
+        }
+        if (result == ChunkedDecoder::Result::kIncomplete) {
+          if (head_size_ + chunked_decoder_.End() >= limits_.max_request_size)
+            Reject(413);
+          break;
+        }
+        message_size = head_size_ + chunked_decoder_.End();
+        body_size = chunked_decoder_.DecodeInPlace(data + head_size_);
+      } else {
+        message_size = head_size_ + body_size;
+        if (length < message_size)
+          break;
+      }
+
+      // 请求头在更早的读取中解析，缓冲区可能已移动，视图需重新建立
+      if (!head_parsed_)
+        HttpParser::ParseHead(data, head_size_, request_);
+      request_.conn_id = conn_id;
+      request_.body = std::string_view(data + head_size_, body_size);
+      HandleRequest();
+      handled++;
+
+      buffer_.CommitReadSize(message_size);
+      head_size_ = 0;
+      body_size_ = 0;
+      chunked_ = false;
+      chunked_decoder_.Reset();
+    }
+    // 跨读取保留的只有偏移量
+    head_parsed_ = false;
+    return handled;
+  }
+
+  void OnBufferOverflow() override { Reject(head_size_ ? 413 : 431); }
+
+private:
+  /// @brief 按Transfer-Encoding与Content-Length确定请求体长度
+  /// @param received 已收到的请求体字节数
+  /// @return 0为成功，否则为应答的错误状态码
+  int ResolveFraming(size_t received) {
+    std::string_view transfer_encoding;
+    std::string_view content_length;
+    bool expect_continue = false;
+    for (size_t i = 0; i < request_.header_count; ++i) {
+      const HttpHeader &header = request_.headers[i];
+      if (HttpParser::EqualsIgnoreCase(header.name, "Transfer-Encoding")) {
+        transfer_encoding = header.value;
+      } else if (HttpParser::EqualsIgnoreCase(header.name, "Content-Length")) {
+        // 多个不一致的长度可被用于请求走私
+        if (!content_length.empty() && content_length != header.value)
+          return 400;
+        content_length = header.value;
+      } else if (HttpParser::EqualsIgnoreCase(header.name, "Expect")) {
+        expect_continue = HttpParser::EqualsIgnoreCase(header.value,
+                                                       "100-continue");
+      }
+    }
+
+    body_size_ = 0;
+    chunked_ = false;
+    if (!transfer_encoding.empty()) {
+      if (!content_length.empty() ||
+          !HttpParser::EqualsIgnoreCase(
+              HttpParser::LastToken(transfer_encoding), "chunked"))
+        return 400;
+      chunked_ = true;
+    } else if (!content_length.empty()) {
+      if (!HttpParser::ParseContentLength(content_length, body_size_))
+        return 400;
+      if (body_size_ > limits_.max_request_size)
+        return 413;
+    }
+
+    // 客户端等待确认后才发送请求体
+    bool body_pending = chunked_ ? received == 0 : received < body_size_;
+    if (expect_continue && request_.minor_version >= 1 && body_pending)
+      Append("HTTP/1.1 100 Continue\r\n\r\n");
+    return 0;
+  }
+
+  /// @brief 回调业务并序列化响应
+  void HandleRequest() {
+    response_.Reset();
+    try {
+      (*cb_)(request_, response_);
+    } catch (const std::exception &e) {
+      LOGP_ERROR("http callback exception on fd:%d:%s", fd_, e.what());
+      response_.Reset();
+      response_.SetStatus(500);
+      response_.SetClose();
+    }
+    bool keep_alive = request_.keep_alive && !response_.close_;
+    bool head = request_.method == "HEAD";
+    AppendResponse(response_, keep_alive, request_.minor_version, head);
+    if (!keep_alive)
+      CloseAfterFlush();
+  }
+
+  /// @brief 应答错误并在写完后关闭连接
+  void Reject(int status) {
+    LOGP_MSG("Reject http request on fd:%d,status:%d", fd_, status);
+    response_.Reset();
+    response_.SetStatus(status);
+    AppendResponse(response_, false, 1, false);
+    CloseAfterFlush();
+    buffer_.Clear();
+  }
+
+  /// @brief 序列化响应到待发送缓冲
+  void AppendResponse(const HttpResponse &response, bool keep_alive,
+                      int minor_version, bool head) {
+    char number[24];
+    Append("HTTP/1.1 ");
+    auto [status_end, ec] =
+        std::to_chars(number, number + sizeof(number), response.status_);
+    Append(std::string_view(number, status_end - number));
+    Append(" ");
+    Append(response.reason_.empty() ? ReasonPhrase(response.status_)
+                                    : std::string_view(response.reason_));
+    Append("\r\nDate: ");
+    Append(HttpDate());
+    Append("\r\n");
+    Append(response.headers_);
+
+    // 1xx、204与304不带响应体
+    bool no_body = response.status_ < 200 || response.status_ == 204 ||
+                   response.status_ == 304;
+    if (!no_body) {
+      Append("Content-Length: ");
+      auto [length_end, length_ec] =
+          std::to_chars(number, number + sizeof(number), response.BodySize());
+      Append(std::string_view(number, length_end - number));
+      Append("\r\n");
+    }
+    if (!keep_alive)
+      Append("Connection: close\r\n");
+    else if (minor_version == 0)
+      Append("Connection: keep-alive\r\n");
+    Append("\r\n");
+    if (no_body || head)
+      return;
+
+    if (response.shared_body_) {
+      // 共享响应体单独成块，与之前合并的响应一起经writev发出
+      PushPending();
+      output_.Push(OutputChunk::FromBuffer(response.shared_body_));
+    } else {
+      Append(response.body_);
+    }
+  }
+
+  /// @brief 按秒缓存的IMF-fixdate
+  static std::string_view HttpDate() {
+    thread_local char date[32];
+    thread_local time_t cached = 0;
+    time_t now = time(nullptr);
+    if (now != cached) {
+      cached = now;
+      tm utc;
+      gmtime_r(&now, &utc);
+      strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+    }
+    return std::string_view(date, 29);
+  }
+
+  static std::string_view ReasonPhrase(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Content Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
+  }
+
+  std::shared_ptr<const HttpRequestCb> cb_;
+  HttpLimits limits_;
+
+  // 当前请求的解析进度，仅保存偏移，缓冲区移动后仍然有效
+  size_t head_scanned_ = 0; // 已确认不含请求头结束符的字节数
+  size_t head_size_ = 0;    // 0为请求头未收全
+  size_t body_size_ = 0;
+  bool chunked_ = false;
+  bool head_parsed_ = false; // request_的视图是否指向当前缓冲区
+  ChunkedDecoder chunked_decoder_;
+  HttpRequest request_;
+  HttpResponse response_;
+};
+
+} // namespace net
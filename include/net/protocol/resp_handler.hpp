@@ -0,0 +1,434 @@
+#pragma once
+#include "stream_handler.hpp"
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <string_view>
+
+namespace net {
+
+/// @brief RESP命令，参数视图指向连接接收缓冲区，仅在批次回调内有效
+struct RespCommand {
+  const std::string_view *args = nullptr;
+  size_t argc = 0;
+
+  /// @brief 命令名(第一个参数)
+  std::string_view Name() const {
+    return argc ? args[0] : std::string_view();
+  }
+
+  /// @brief 第i个参数，0为命令名，越界返回空视图
+  std::string_view Arg(size_t i) const {
+    return i < argc ? args[i] : std::string_view();
+  }
+
+  /// @brief 命令名是否为name(不区分大小写)
+  bool Is(std::string_view name) const {
+    std::string_view cmd = Name();
+    if (cmd.size() != name.size())
+      return false;
+    for (size_t i = 0; i < cmd.size(); ++i) {
+      char c = cmd[i];
+      if (c >= 'a' && c <= 'z')
+        c = static_cast<char>(c - ('a' - 'A'));
+      char n = name[i];
+      if (n >= 'a' && n <= 'z')
+        n = static_cast<char>(n - ('a' - 'A'));
+      if (c != n)
+        return false;
+    }
+    return true;
+  }
+};
+
+/// @brief 一次读取解析出的命令批次
+/// @note 所有命令的参数视图存放在同一个连续数组中，连接内复用容量
+class RespBatch {
+public:
+  ConnId Conn() const { return conn_id_; }
+  size_t Size() const { return commands_.size(); }
+  bool Empty() const { return commands_.empty(); }
+
+  RespCommand operator[](size_t i) const {
+    const auto &[offset, argc] = commands_[i];
+    return RespCommand{args_.data() + offset, argc};
+  }
+
+private:
+  friend class RespHandler;
+
+  void Reset(ConnId conn_id) {
+    conn_id_ = conn_id;
+    args_.clear();
+    commands_.clear();
+  }
+
+  ConnId conn_id_ = 0;
+  std::vector<std::string_view> args_;
+  std::vector<std::pair<size_t, size_t>> commands_; // 参数偏移与个数
+};
+
+/// @brief RESP回复写入器，回复直接序列化到连接的待发送缓冲，批次结束后一次写出
+/// @note 协议版本为2时RESP3类型降级为RESP2的等价表示(如Null为$-1，Map为2N元素数组)
+class RespWriter {
+public:
+  /// @brief 协议版本，由业务在处理HELLO时设置，连接内保持
+  void SetProtocol(int protocol) { protocol_ = protocol == 3 ? 3 : 2; }
+  int Protocol() const { return protocol_; }
+
+  void SimpleString(std::string_view text) {
+    Prefix('+');
+    Append(text);
+    Crlf();
+  }
+
+  /// @brief 错误回复
+  /// @param message 以错误码开头，如"ERR unknown command"
+  void Error(std::string_view message) {
+    Prefix('-');
+    Append(message);
+    Crlf();
+  }
+
+  void Integer(int64_t value) { Header(':', value); }
+
+  void Bulk(std::string_view data) {
+    Header('$', static_cast<int64_t>(data.size()));
+    Append(data);
+    Crlf();
+  }
+
+  /// @brief 共享的大块值，不经拷贝，与前后回复一起经writev写出
+  /// @param data 写完前保持存活，调用方不得修改
+  void Bulk(std::shared_ptr<const std::vector<uint8_t>> data) {
+    Header('$', static_cast<int64_t>(data->size()));
+    if (!out_->empty()) {
+      output_->Push(OutputChunk::FromVector(std::move(*out_)));
+      out_->clear();
+    }
+    output_->Push(OutputChunk::FromBuffer(std::move(data)));
+    Crlf();
+  }
+
+  void Null() {
+    if (protocol_ == 3)
+      Append("_\r\n");
+    else
+      Append("$-1\r\n");
+  }
+
+  /// @brief 空数组(RESP2的*-1)
+  void NullArray() {
+    if (protocol_ == 3)
+      Append("_\r\n");
+    else
+      Append("*-1\r\n");
+  }
+
+  /// @brief 数组头，之后需写入count个元素
+  void ArrayHeader(size_t count) {
+    Header('*', static_cast<int64_t>(count));
+  }
+
+  /// @brief 映射头，之后需写入count对键值
+  void MapHeader(size_t count) {
+    if (protocol_ == 3)
+      Header('%', static_cast<int64_t>(count));
+    else
+      Header('*', static_cast<int64_t>(count * 2));
+  }
+
+  /// @brief 集合头，之后需写入count个元素
+  void SetHeader(size_t count) {
+    Header(protocol_ == 3 ? '~' : '*', static_cast<int64_t>(count));
+  }
+
+  /// @brief 推送头(RESP3带外消息，RESP2为数组)
+  void PushHeader(size_t count) {
+    Header(protocol_ == 3 ? '>' : '*', static_cast<int64_t>(count));
+  }
+
+  void Boolean(bool value) {
+    if (protocol_ == 3)
+      Append(value ? "#t\r\n" : "#f\r\n");
+    else
+      Append(value ? ":1\r\n" : ":0\r\n");
+  }
+
+  void Double(double value) {
+    char text[32];
+    std::string_view formatted;
+    if (std::isinf(value)) {
+      formatted = value > 0 ? "inf" : "-inf";
+    } else if (std::isnan(value)) {
+      formatted = "nan";
+    } else {
+      int n = snprintf(text, sizeof(text), "%.17g", value);
+      formatted = std::string_view(text, n);
+    }
+    if (protocol_ == 3) {
+      Prefix(',');
+      Append(formatted);
+      Crlf();
+    } else {
+      Bulk(formatted);
+    }
+  }
+
+  /// @brief 写出已序列化的原始回复
+  void Raw(std::string_view data) { Append(data); }
+
+  /// @brief 回复写完后关闭连接(如QUIT)
+  void CloseAfterReply() { close_ = true; }
+
+private:
+  friend class RespHandler;
+
+  void Prefix(char type) { out_->push_back(static_cast<uint8_t>(type)); }
+  void Crlf() { Append("\r\n"); }
+  void Append(std::string_view data) {
+    out_->insert(out_->end(), data.begin(), data.end());
+  }
+  void Header(char type, int64_t value) {
+    char text[24];
+    text[0] = type;
+    auto [end, ec] = std::to_chars(text + 1, text + sizeof(text) - 2, value);
+    end[0] = '\r';
+    end[1] = '\n';
+    out_->insert(out_->end(), text, end + 2);
+  }
+
+  std::vector<uint8_t> *out_ = nullptr;
+  OutputQueue *output_ = nullptr;
+  int protocol_ = 2;
+  bool close_ = false;
+};
+
+/// @brief RESP命令批次回调，在循环线程执行
+/// @note 需按顺序为批次中的每条命令写入恰好一个回复；
+/// 命令参数视图仅在回调内有效，需保留时自行拷贝
+using RespBatchCb =
+    std::function<void(const RespBatch &batch, RespWriter &writer)>;
+
+/// @brief RESP连接限制
+struct RespLimits {
+  size_t initial_buffer_size = 16 * 1024; // 接收缓冲区初始容量
+  size_t max_query_size = 64 << 20;       // 单条命令上限，亦为缓冲区上限
+  size_t max_args = 1024 * 1024;          // 单条命令的参数个数上限
+  size_t max_inline_size = 64 * 1024;     // 内联命令行长度上限
+  size_t max_pending_output = 16 << 20;   // 待发送回复超过该值时暂停读取
+};
+
+/// @brief RESP命令解析
+/// @note 支持多条批量字符串数组(客户端标准格式)与空格分隔的内联命令，
+/// 参数为指向输入的视图，不拷贝
+class RespParser {
+public:
+  enum class Result { kComplete, kIncomplete, kError };
+
+  /// @brief 解析一条命令，参数追加到args，未收全或出错时args不变
+  /// @param data
+  /// @param len
+  /// @param limits
+  /// @param args
+  /// @param consumed kComplete时为命令长度
+  /// @param error kError时为错误描述
+  /// @return 空命令(*0或空行)同样返回kComplete且不追加参数
+  static Result Parse(const char *data, size_t len, const RespLimits &limits,
+                      std::vector<std::string_view> &args, size_t &consumed,
+                      std::string_view &error) {
+    if (len == 0)
+      return Result::kIncomplete;
+    if (data[0] != '*')
+      return ParseInline(data, len, limits, args, consumed, error);
+
+    const char *end = data + len;
+    int64_t count = 0;
+    const char *p = data;
+    Result result = ParseLength(p, end, count);
+    if (result == Result::kError)
+      error = "invalid multibulk length";
+    if (result != Result::kComplete)
+      return result;
+    if (count <= 0) {
+      consumed = p - data;
+      return Result::kComplete;
+    }
+    if (static_cast<size_t>(count) > limits.max_args) {
+      error = "invalid multibulk length";
+      return Result::kError;
+    }
+
+    size_t base = args.size();
+    for (int64_t i = 0; i < count; ++i) {
+      if (p == end) {
+        args.resize(base);
+        return Result::kIncomplete;
+      }
+      if (*p != '$') {
+        args.resize(base);
+        error = "expected '$'";
+        return Result::kError;
+      }
+      int64_t size = 0;
+      result = ParseLength(p, end, size);
+      if (result == Result::kComplete &&
+          (size < 0 || static_cast<size_t>(size) > limits.max_query_size))
+        result = Result::kError;
+      if (result != Result::kComplete) {
+        args.resize(base);
+        if (result == Result::kError)
+          error = "invalid bulk length";
+        return result;
+      }
+      if (end - p < size + 2) {
+        args.resize(base);
+        return Result::kIncomplete;
+      }
+      if (p[size] != '\r' || p[size + 1] != '\n') {
+        args.resize(base);
+        error = "invalid bulk terminator";
+        return Result::kError;
+      }
+      args.emplace_back(p, static_cast<size_t>(size));
+      p += size + 2;
+    }
+    consumed = p - data;
+    return Result::kComplete;
+  }
+
+private:
+  static constexpr size_t kMaxLengthLine = 32; // "*N\r\n"/"$N\r\n"长度行上限
+
+  /// @brief 解析"*N\r\n"或"$N\r\n"，成功时p移到下一行
+  static Result ParseLength(const char *&p, const char *end, int64_t &value) {
+    size_t avail = std::min<size_t>(end - p, kMaxLengthLine);
+    const char *cr =
+        avail >= 2 ? static_cast<const char *>(memchr(p, '\r', avail - 1))
+                   : nullptr;
+    if (!cr)
+      return avail == kMaxLengthLine ? Result::kError : Result::kIncomplete;
+    auto [ptr, ec] = std::from_chars(p + 1, cr, value);
+    if (ec != std::errc() || ptr != cr || cr[1] != '\n')
+      return Result::kError;
+    p = cr + 2;
+    return Result::kComplete;
+  }
+
+  /// @brief 内联命令: 以空白分隔参数的一行，不支持引号
+  static Result ParseInline(const char *data, size_t len,
+                            const RespLimits &limits,
+                            std::vector<std::string_view> &args,
+                            size_t &consumed, std::string_view &error) {
+    const char *nl = static_cast<const char *>(memchr(data, '\n', len));
+    if (!nl) {
+      if (len > limits.max_inline_size) {
+        error = "too big inline request";
+        return Result::kError;
+      }
+      return Result::kIncomplete;
+    }
+    const char *line_end = nl > data && nl[-1] == '\r' ? nl - 1 : nl;
+    const char *p = data;
+    while (p < line_end) {
+      while (p < line_end && (*p == ' ' || *p == '\t'))
+        ++p;
+      const char *start = p;
+      while (p < line_end && *p != ' ' && *p != '\t')
+        ++p;
+      if (p > start)
+        args.emplace_back(start, p - start);
+    }
+    consumed = nl + 1 - data;
+    return Result::kComplete;
+  }
+};
+
+/// @brief RESP2/RESP3服务端协议处理器
+/// @note 一次读取中所有完整的命令解析为一个批次，参数为接收缓冲区上的视图；
+/// 批次整体回调一次，回复合并后一次写出。协议错误时回复错误并在写完后关闭
+class RespHandler : public StreamHandler {
+public:
+  RespHandler(int fd, std::shared_ptr<const RespBatchCb> cb,
+              const RespLimits &limits = RespLimits())
+      : StreamHandler(fd, limits.initial_buffer_size, limits.max_query_size,
+                      limits.max_pending_output),
+        cb_(std::move(cb)), limits_(limits) {
+    writer_.out_ = &pending_out_;
+    writer_.output_ = &output_;
+  }
+
+  /// @brief 创建供ReactorCore::SetHandlerFactory使用的工厂，连接共享同一份回调
+  /// @param cb
+  /// @param limits
+  /// @return
+  static HandlerFactory Factory(RespBatchCb cb,
+                                const RespLimits &limits = RespLimits()) {
+    auto shared = std::make_shared<const RespBatchCb>(std::move(cb));
+    return [shared, limits](int conn_fd,
+                            int) -> std::unique_ptr<ProtocolHandler> {
+      return std::make_unique<RespHandler>(conn_fd, shared, limits);
+    };
+  }
+
+protected:
+  size_t ProcessBuffer(ConnId conn_id) override {
+    auto [read_ptr, length] = buffer_.GetLinearReadSpace();
+    const char *data = reinterpret_cast<const char *>(read_ptr);
+    batch_.Reset(conn_id);
+
+    size_t offset = 0;
+    std::string_view error;
+    RespParser::Result result = RespParser::Result::kComplete;
+    while (offset < length) {
+      size_t consumed = 0;
+      size_t base = batch_.args_.size();
+      result = RespParser::Parse(data + offset, length - offset, limits_,
+                                 batch_.args_, consumed, error);
+      if (result != RespParser::Result::kComplete)
+        break;
+      if (batch_.args_.size() > base)
+        batch_.commands_.emplace_back(base, batch_.args_.size() - base);
+      offset += consumed;
+    }
+
+    // 出错前已解析的命令照常执行
+    if (!batch_.Empty()) {
+      try {
+        (*cb_)(batch_, writer_);
+      } catch (const std::exception &e) {
+        LOGP_ERROR("resp callback exception on fd:%d:%s", fd_, e.what());
+        writer_.Error("ERR internal error");
+        writer_.CloseAfterReply();
+      }
+    }
+    buffer_.CommitReadSize(offset);
+
+    if (result == RespParser::Result::kError) {
+      LOGP_MSG("Resp protocol error on fd:%d:%.*s", fd_,
+               static_cast<int>(error.size()), error.data());
+      std::string message = "ERR Protocol error: ";
+      message.append(error.data(), error.size());
+      writer_.Error(message);
+      writer_.CloseAfterReply();
+      buffer_.Clear();
+    }
+    if (writer_.close_)
+      CloseAfterFlush();
+    return batch_.Size();
+  }
+
+  void OnBufferOverflow() override {
+    writer_.Error("ERR Protocol error: too big request");
+    CloseAfterFlush();
+    buffer_.Clear();
+  }
+
+private:
+  std::shared_ptr<const RespBatchCb> cb_;
+  RespLimits limits_;
+  RespBatch batch_;
+  RespWriter writer_;
+};
+
+} // namespace net
@@ -0,0 +1,198 @@
+#pragma once
+#include "../transport/protocol_handler.hpp"
+
+namespace net {
+
+/// @brief 应用层流式协议处理器基类
+/// @note 负责读取、接收缓冲区扩缩容与响应写出，子类只需在线性化的接收缓冲区上
+/// 原地解析完整消息。一次读取解析出的所有消息在循环线程依次处理，期间产生的
+/// 响应追加到pending_out_，读取结束后合并为一个发送块写出；待发送数据超过
+/// 上限时暂停读取，对端开始接收后恢复
+class StreamHandler : public ProtocolHandler {
+public:
+  bool ShouldClose() const override {
+    return should_close_ || (close_after_flush_ && output_.Empty());
+  }
+  bool HasPendingOutput() const override { return !output_.Empty(); }
+
+  bool Send(OutputChunk &&chunk) override {
+    if (should_close_)
+      return false;
+    PushPending();
+    output_.Push(std::move(chunk));
+    FlushOutput();
+    return !should_close_;
+  }
+
+  bool ShrinkRecvBuffer() override {
+    if (buffer_.Capacity() <= initial_buffer_size_ ||
+        buffer_.Length() > initial_buffer_size_)
+      return false;
+    buffer_.Resize(initial_buffer_size_);
+    stats_.buffer_resizes.Add();
+    stats_.recv_buffer_bytes.Set(buffer_.Capacity());
+    return true;
+  }
+
+  void HandleEvent(int, const Event &event, PacketDispatcher &) override {
+    if (event.fd != fd_)
+      return;
+
+    if (event.event_flags & EventFlags::kError) {
+      LOGP_MSG("Connection error on fd:%d", fd_);
+      should_close_ = true;
+      return;
+    }
+    if (event.event_flags & EventFlags::kHangUp) {
+      LOGP_MSG("Connection closed by peer on fd:%d", fd_);
+      should_close_ = true;
+      return;
+    }
+
+    if (event.event_flags & EventFlags::kReadable)
+      ProcessReadableEvent(event.conn_id);
+
+    if (event.event_flags & EventFlags::kWritable) {
+      FlushOutput();
+      // 对端开始接收响应，回落到一半后恢复读取积压的请求
+      if (output_paused_ && output_.PendingBytes() <= max_pending_output_ / 2) {
+        output_paused_ = false;
+        ProcessReadableEvent(event.conn_id);
+      }
+    }
+  }
+
+protected:
+  /// @param fd
+  /// @param initial_buffer_size 接收缓冲区初始容量
+  /// @param max_buffer_size 接收缓冲区上限，即单条消息上限
+  /// @param max_pending_output 待发送数据超过该值时暂停读取
+  StreamHandler(int fd, size_t initial_buffer_size, size_t max_buffer_size,
+                size_t max_pending_output)
+      : fd_(fd), buffer_(initial_buffer_size),
+        initial_buffer_size_(initial_buffer_size),
+        max_buffer_size_(std::max(max_buffer_size, initial_buffer_size)),
+        max_pending_output_(max_pending_output) {
+    stats_.recv_buffer_bytes.Set(buffer_.Capacity());
+  }
+
+  /// @brief 解析并处理接收缓冲区中所有完整的消息，处理完的数据需CommitReadSize
+  /// @note 未读数据已线性化，可经GetLinearReadSpace一次取得
+  /// @param conn_id
+  /// @return 处理的消息数
+  virtual size_t ProcessBuffer(ConnId conn_id) = 0;
+
+  /// @brief 缓冲区已满且无法扩容(单条消息超过上限)，一般应答错误并关闭
+  virtual void OnBufferOverflow() = 0;
+
+  /// @brief 追加待发送数据，本次读取结束后合并写出
+  void Append(std::string_view data) {
+    pending_out_.insert(pending_out_.end(), data.begin(), data.end());
+  }
+
+  /// @brief 已合并的待发送数据入发送队列，需与其他发送块保持顺序时调用
+  void PushPending() {
+    if (pending_out_.empty())
+      return;
+    output_.Push(OutputChunk::FromVector(std::move(pending_out_)));
+    pending_out_.clear();
+  }
+
+  /// @brief 写出已合并的待发送数据
+  void FlushPending() {
+    PushPending();
+    if (!output_.Empty())
+      FlushOutput();
+  }
+
+  /// @brief 写完已有数据后关闭连接，之后不再读取
+  void CloseAfterFlush() { close_after_flush_ = true; }
+
+  void FlushOutput() {
+    size_t before = output_.PendingBytes();
+    OutputQueue::FlushResult result = output_.Flush(fd_);
+    stats_.bytes_written.Add(before - output_.PendingBytes());
+    if (result == OutputQueue::FlushResult::kError) {
+      if (errno != EPIPE && errno != ECONNRESET)
+        perror("send");
+      should_close_ = true;
+    }
+  }
+
+  const int fd_;
+  bool should_close_ = false;
+  bool close_after_flush_ = false;
+  containers::RingBuffer buffer_;
+  OutputQueue output_;
+  std::vector<uint8_t> pending_out_;
+
+private:
+  void ProcessReadableEvent(ConnId conn_id) {
+    BeginReadBudget();
+    while (!should_close_ && !close_after_flush_) {
+      if (ReadBudgetSpent())
+        break;
+      // 对端只发不收时停止读取，由EPOLLOUT恢复
+      if (output_.PendingBytes() >= max_pending_output_) {
+        output_paused_ = true;
+        break;
+      }
+
+      // 保持未处理数据线性，消息可原地解析
+      buffer_.Linearize();
+      auto [buffer, capacity] = buffer_.GetLinearWriteSpace();
+      if (capacity == 0) {
+        // 缓冲区中是未收全的单条消息
+        if (GrowBuffer())
+          continue;
+        stats_.unpack_failures.Add();
+        OnBufferOverflow();
+        FlushPending();
+        break;
+      }
+
+      ssize_t n = read(fd_, buffer, capacity);
+      stats_.read_calls.Add();
+      if (n > 0) {
+        Capture(conn_id, CaptureKind::kStream, buffer, n);
+        buffer_.CommitWriteSize(n);
+        stats_.bytes_read.Add(n);
+        size_t handled = ProcessBuffer(conn_id);
+        stats_.packets_read.Add(handled);
+        ChargeReadBudget(n, handled);
+        FlushPending();
+        // 未读满说明内核接收队列已空，之后到达的数据会产生新的边缘通知
+        if (static_cast<size_t>(n) < capacity)
+          break;
+      } else if (n == 0) { // 对端关闭连接，写完已有响应后关闭
+        close_after_flush_ = true;
+        break;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      } else {
+        perror("read");
+        should_close_ = true;
+        break;
+      }
+    }
+  }
+
+  /// @brief 扩容接收缓冲区，最多到上限
+  /// @return 是否扩容
+  bool GrowBuffer() {
+    size_t capacity = buffer_.Capacity();
+    if (capacity >= max_buffer_size_)
+      return false;
+    buffer_.Resize(std::min(capacity * 2, max_buffer_size_));
+    stats_.buffer_resizes.Add();
+    stats_.recv_buffer_bytes.Set(buffer_.Capacity());
+    return true;
+  }
+
+  size_t initial_buffer_size_;
+  size_t max_buffer_size_;
+  size_t max_pending_output_;
+  bool output_paused_ = false; // 因待发送数据过多暂停读取
+};
+
+} // namespace net
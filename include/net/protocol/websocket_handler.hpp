@@ -0,0 +1,770 @@
+#pragma once
+#include "http_handler.hpp"
+#include <array>
+#include <string>
+#include <string_view>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+// 未以-mavx2编译时，x86-64上经target属性单独生成AVX2版本并在运行时按CPU选择
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define NEBULA_WS_AVX2_DISPATCH
+#endif
+
+namespace net {
+
+/// @brief WebSocket帧操作码(RFC 6455)
+enum class WebSocketOpcode : uint8_t {
+  kContinuation = 0x0,
+  kText = 0x1,
+  kBinary = 0x2,
+  kClose = 0x8,
+  kPing = 0x9,
+  kPong = 0xA,
+};
+
+/// @brief WebSocket关闭状态码
+enum WebSocketCloseCode : uint16_t {
+  kWsCloseNormal = 1000,
+  kWsCloseGoingAway = 1001,
+  kWsCloseProtocolError = 1002,
+  kWsCloseUnsupportedData = 1003,
+  kWsCloseInvalidPayload = 1007,
+  kWsClosePolicyViolation = 1008,
+  kWsCloseMessageTooBig = 1009,
+  kWsCloseInternalError = 1011,
+};
+
+/// @brief 帧头
+struct WebSocketFrameHeader {
+  bool fin = true;
+  uint8_t rsv = 0; // RSV1-3，未协商扩展时必须为0
+  WebSocketOpcode opcode = WebSocketOpcode::kText;
+  bool masked = false;
+  uint8_t mask[4] = {0, 0, 0, 0};
+  uint64_t payload_size = 0;
+  size_t header_size = 0; // 帧头长度(含扩展长度与掩码)
+};
+
+/// @brief WebSocket帧编解码
+/// @note 客户端帧的掩码在接收缓冲区上原地异或，按AVX2(运行时检测)/SSE2/8字节批量处理；
+/// 服务端帧不带掩码，编码一次的帧可原样发送给任意多个连接
+class WebSocketCodec {
+public:
+  static constexpr size_t kMaxHeaderSize = 14;
+  static constexpr size_t kMaxControlPayload = 125;
+
+  /// @brief 解析帧头
+  /// @param data
+  /// @param len 已收到的字节数
+  /// @param header 输出
+  /// @return 1为成功，0为未收全，-1为长度字段非法
+  static int ParseHeader(const uint8_t *data, size_t len,
+                         WebSocketFrameHeader &header) {
+    if (len < 2)
+      return 0;
+    header.fin = (data[0] & 0x80) != 0;
+    header.rsv = (data[0] >> 4) & 0x07;
+    header.opcode = static_cast<WebSocketOpcode>(data[0] & 0x0F);
+    header.masked = (data[1] & 0x80) != 0;
+    uint64_t size = data[1] & 0x7F;
+    size_t offset = 2;
+    if (size == 126) {
+      if (len < 4)
+        return 0;
+      size = (uint64_t(data[2]) << 8) | data[3];
+      offset = 4;
+    } else if (size == 127) {
+      if (len < 10)
+        return 0;
+      size = 0;
+      for (int i = 0; i < 8; ++i)
+        size = (size << 8) | data[2 + i];
+      // 最高位必须为0
+      if (size >> 63)
+        return -1;
+      offset = 10;
+    }
+    if (header.masked) {
+      if (len < offset + 4)
+        return 0;
+      memcpy(header.mask, data + offset, 4);
+      offset += 4;
+    }
+    header.payload_size = size;
+    header.header_size = offset;
+    return 1;
+  }
+
+  /// @brief 原地去掩码，payload从掩码相位0开始
+  /// @param data
+  /// @param len
+  /// @param mask
+  static void Unmask(uint8_t *data, size_t len, const uint8_t mask[4]) {
+    uint32_t key;
+    memcpy(&key, mask, 4);
+    size_t i = 0;
+    // 每批长度均为4的倍数，掩码相位保持不变
+#if defined(__AVX2__)
+    i = UnmaskAvx2(data, len, key);
+#elif defined(NEBULA_WS_AVX2_DISPATCH)
+    if (HasAvx2())
+      i = UnmaskAvx2(data, len, key);
+#endif
+#if defined(__SSE2__)
+    const __m128i key128 = _mm_set1_epi32(static_cast<int>(key));
+    for (; i + 16 <= len; i += 16) {
+      __m128i *p = reinterpret_cast<__m128i *>(data + i);
+      _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), key128));
+    }
+#endif
+    const uint64_t key64 = uint64_t(key) | (uint64_t(key) << 32);
+    for (; i + 8 <= len; i += 8) {
+      uint64_t word;
+      memcpy(&word, data + i, 8);
+      word ^= key64;
+      memcpy(data + i, &word, 8);
+    }
+    for (; i < len; ++i)
+      data[i] ^= mask[i & 3];
+  }
+
+  /// @brief 当前CPU是否走AVX2去掩码路径
+  static bool HasAvx2() {
+#if defined(__AVX2__)
+    return true;
+#elif defined(NEBULA_WS_AVX2_DISPATCH)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+  }
+
+  /// @brief 编码不带掩码的帧头
+  /// @param out 至少kMaxHeaderSize字节
+  /// @param opcode
+  /// @param payload_size
+  /// @param fin
+  /// @return 帧头长度
+  static size_t EncodeHeader(uint8_t *out, WebSocketOpcode opcode,
+                             uint64_t payload_size, bool fin = true) {
+    out[0] = static_cast<uint8_t>((fin ? 0x80 : 0x00) |
+                                  static_cast<uint8_t>(opcode));
+    if (payload_size < 126) {
+      out[1] = static_cast<uint8_t>(payload_size);
+      return 2;
+    }
+    if (payload_size <= 0xFFFF) {
+      out[1] = 126;
+      out[2] = static_cast<uint8_t>(payload_size >> 8);
+      out[3] = static_cast<uint8_t>(payload_size);
+      return 4;
+    }
+    out[1] = 127;
+    for (int i = 0; i < 8; ++i)
+      out[2 + i] = static_cast<uint8_t>(payload_size >> (56 - 8 * i));
+    return 10;
+  }
+
+  /// @brief 编码完整的服务端帧，供广播时各连接共享同一份
+  /// @param opcode
+  /// @param payload
+  /// @return 可直接交给ReactorCore::Send或WebSocketWriter::Frame
+  static std::shared_ptr<const std::vector<uint8_t>>
+  EncodeFrame(WebSocketOpcode opcode, std::string_view payload) {
+    uint8_t header[kMaxHeaderSize];
+    size_t header_size = EncodeHeader(header, opcode, payload.size());
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    frame->reserve(header_size + payload.size());
+    frame->insert(frame->end(), header, header + header_size);
+    frame->insert(frame->end(), payload.begin(), payload.end());
+    return frame;
+  }
+
+  /// @brief 严格校验UTF-8(拒绝超长编码、代理区与超出U+10FFFF的码点)
+  /// @note ASCII部分按16字节批量跳过
+  static bool IsValidUtf8(const uint8_t *p, size_t len) {
+    const uint8_t *end = p + len;
+    while (p < end) {
+#if defined(__SSE2__)
+      while (end - p >= 16 &&
+             _mm_movemask_epi8(_mm_loadu_si128(
+                 reinterpret_cast<const __m128i *>(p))) == 0)
+        p += 16;
+#endif
+      while (p < end && *p < 0x80)
+        ++p;
+      if (p == end)
+        break;
+
+      uint8_t c = *p;
+      size_t n = 0;
+      uint32_t code_point = 0;
+      if (c >= 0xC2 && c <= 0xDF) {
+        n = 1;
+        code_point = c & 0x1F;
+      } else if ((c & 0xF0) == 0xE0) {
+        n = 2;
+        code_point = c & 0x0F;
+      } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 3;
+        code_point = c & 0x07;
+      } else {
+        return false;
+      }
+      if (static_cast<size_t>(end - p) <= n)
+        return false;
+      for (size_t i = 1; i <= n; ++i) {
+        if ((p[i] & 0xC0) != 0x80)
+          return false;
+        code_point = (code_point << 6) | (p[i] & 0x3F);
+      }
+      if (n == 2 && (code_point < 0x800 ||
+                     (code_point >= 0xD800 && code_point <= 0xDFFF)))
+        return false;
+      if (n == 3 && (code_point < 0x10000 || code_point > 0x10FFFF))
+        return false;
+      p += n + 1;
+    }
+    return true;
+  }
+
+  /// @brief 由客户端Sec-WebSocket-Key计算Sec-WebSocket-Accept
+  static std::string AcceptKey(std::string_view client_key) {
+    static constexpr std::string_view kGuid =
+        "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::string input;
+    input.reserve(client_key.size() + kGuid.size());
+    input.append(client_key.data(), client_key.size());
+    input.append(kGuid.data(), kGuid.size());
+    std::array<uint8_t, 20> digest = Sha1(input);
+    return Base64(digest.data(), digest.size());
+  }
+
+  /// @brief SHA-1摘要，仅用于握手
+  static std::array<uint8_t, 20> Sha1(std::string_view input) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                     0xC3D2E1F0};
+    // 追加0x80、补零与64位长度，按64字节分组
+    std::string message(input.data(), input.size());
+    uint64_t bit_size = uint64_t(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56)
+      message.push_back('\0');
+    for (int i = 7; i >= 0; --i)
+      message.push_back(static_cast<char>(bit_size >> (8 * i)));
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+      const uint8_t *p =
+          reinterpret_cast<const uint8_t *>(message.data() + block);
+      uint32_t w[80];
+      for (int i = 0; i < 16; ++i)
+        w[i] = (uint32_t(p[4 * i]) << 24) | (uint32_t(p[4 * i + 1]) << 16) |
+               (uint32_t(p[4 * i + 2]) << 8) | p[4 * i + 3];
+      for (int i = 16; i < 80; ++i)
+        w[i] = Rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+      for (int i = 0; i < 80; ++i) {
+        uint32_t f, k;
+        if (i < 20) {
+          f = (b & c) | (~b & d);
+          k = 0x5A827999;
+        } else if (i < 40) {
+          f = b ^ c ^ d;
+          k = 0x6ED9EBA1;
+        } else if (i < 60) {
+          f = (b & c) | (b & d) | (c & d);
+          k = 0x8F1BBCDC;
+        } else {
+          f = b ^ c ^ d;
+          k = 0xCA62C1D6;
+        }
+        uint32_t temp = Rotl(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = Rotl(b, 30);
+        b = a;
+        a = temp;
+      }
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 5; ++i) {
+      digest[4 * i] = static_cast<uint8_t>(h[i] >> 24);
+      digest[4 * i + 1] = static_cast<uint8_t>(h[i] >> 16);
+      digest[4 * i + 2] = static_cast<uint8_t>(h[i] >> 8);
+      digest[4 * i + 3] = static_cast<uint8_t>(h[i]);
+    }
+    return digest;
+  }
+
+  /// @brief 标准Base64编码(带填充)
+  static std::string Base64(const uint8_t *data, size_t len) {
+    static constexpr char kTable[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+      uint32_t v = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) |
+                   data[i + 2];
+      out.push_back(kTable[v >> 18]);
+      out.push_back(kTable[(v >> 12) & 0x3F]);
+      out.push_back(kTable[(v >> 6) & 0x3F]);
+      out.push_back(kTable[v & 0x3F]);
+    }
+    if (i < len) {
+      uint32_t v = uint32_t(data[i]) << 16;
+      if (i + 1 < len)
+        v |= uint32_t(data[i + 1]) << 8;
+      out.push_back(kTable[v >> 18]);
+      out.push_back(kTable[(v >> 12) & 0x3F]);
+      out.push_back(i + 1 < len ? kTable[(v >> 6) & 0x3F] : '=');
+      out.push_back('=');
+    }
+    return out;
+  }
+
+private:
+  static uint32_t Rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+#if defined(__AVX2__) || defined(NEBULA_WS_AVX2_DISPATCH)
+  /// @brief 按32字节批量异或
+  /// @return 已处理的字节数
+#if !defined(__AVX2__)
+  __attribute__((target("avx2")))
+#endif
+  static size_t UnmaskAvx2(uint8_t *data, size_t len, uint32_t key) {
+    const __m256i key256 = _mm256_set1_epi32(static_cast<int>(key));
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+      __m256i *p = reinterpret_cast<__m256i *>(data + i);
+      _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), key256));
+    }
+    return i;
+  }
+#endif
+};
+
+/// @brief 收到的完整消息(分片已拼接)，payload视图指向连接接收缓冲区，
+/// 仅在回调内有效
+struct WebSocketMessage {
+  ConnId conn_id = 0;
+  WebSocketOpcode opcode = WebSocketOpcode::kText; // kText或kBinary
+  std::string_view payload;
+
+  bool IsText() const { return opcode == WebSocketOpcode::kText; }
+};
+
+/// @brief WebSocket帧写入器，帧直接序列化到连接的待发送缓冲，本次读取结束后一次写出
+class WebSocketWriter {
+public:
+  void Text(std::string_view payload) {
+    Write(WebSocketOpcode::kText, payload);
+  }
+
+  void Binary(std::string_view payload) {
+    Write(WebSocketOpcode::kBinary, payload);
+  }
+
+  /// @brief 发送已编码的帧(WebSocketCodec::EncodeFrame)，不经拷贝经writev写出
+  /// @param frame 写完前保持存活，调用方不得修改
+  void Frame(std::shared_ptr<const std::vector<uint8_t>> frame) {
+    if (closed_)
+      return;
+    if (!out_->empty()) {
+      output_->Push(OutputChunk::FromVector(std::move(*out_)));
+      out_->clear();
+    }
+    output_->Push(OutputChunk::FromBuffer(std::move(frame)));
+  }
+
+  /// @brief 发送Ping，payload不超过125字节
+  void Ping(std::string_view payload = std::string_view()) {
+    Write(WebSocketOpcode::kPing,
+          payload.substr(0, WebSocketCodec::kMaxControlPayload));
+  }
+
+  /// @brief 发送关闭帧，写完后关闭连接，之后的写入被忽略
+  /// @param code
+  /// @param reason 不超过123字节
+  void Close(uint16_t code = kWsCloseNormal,
+             std::string_view reason = std::string_view()) {
+    if (closed_)
+      return;
+    char payload[WebSocketCodec::kMaxControlPayload];
+    payload[0] = static_cast<char>(code >> 8);
+    payload[1] = static_cast<char>(code);
+    reason = reason.substr(0, sizeof(payload) - 2);
+    if (!reason.empty())
+      memcpy(payload + 2, reason.data(), reason.size());
+    Write(WebSocketOpcode::kClose,
+          std::string_view(payload, reason.size() + 2));
+    closed_ = true;
+  }
+
+  /// @brief 是否已发送关闭帧
+  bool Closed() const { return closed_; }
+
+private:
+  friend class WebSocketHandler;
+
+  void Write(WebSocketOpcode opcode, std::string_view payload) {
+    if (closed_)
+      return;
+    uint8_t header[WebSocketCodec::kMaxHeaderSize];
+    size_t header_size =
+        WebSocketCodec::EncodeHeader(header, opcode, payload.size());
+    out_->insert(out_->end(), header, header + header_size);
+    out_->insert(out_->end(), payload.begin(), payload.end());
+  }
+
+  std::vector<uint8_t> *out_ = nullptr;
+  OutputQueue *output_ = nullptr;
+  bool closed_ = false;
+};
+
+/// @brief WebSocket回调，均在循环线程执行，不应阻塞
+/// @note 连接断开(含关闭握手完成)经ReactorCore::SetCloseCallback通知
+struct WebSocketCallbacks {
+  /// @brief 校验升级请求，返回false时以403拒绝；为空时全部接受
+  std::function<bool(const HttpRequest &request)> on_upgrade;
+  /// @brief 握手完成，可保存conn_id用于之后经ReactorCore::Send推送
+  std::function<void(ConnId conn_id, WebSocketWriter &writer)> on_open;
+  /// @brief 收到完整的文本或二进制消息
+  std::function<void(const WebSocketMessage &message, WebSocketWriter &writer)>
+      on_message;
+};
+
+/// @brief WebSocket连接限制
+struct WebSocketLimits {
+  size_t initial_buffer_size = 4096;   // 接收缓冲区初始容量
+  size_t max_handshake_size = 8192;    // 升级请求头上限
+  size_t max_message_size = 16 << 20;  // 单条消息(分片拼接后)上限
+  size_t max_pending_output = 4 << 20; // 待发送数据超过该值时暂停读取
+  bool validate_utf8 = true;           // 校验文本消息的UTF-8
+};
+
+/// @brief WebSocket服务端协议处理器(RFC 6455)
+/// @note 先在接收缓冲区上原地解析HTTP升级请求，握手完成后解析帧：
+/// 掩码原地向量化异或，单帧消息直接以缓冲区视图回调，分片消息的各片负载
+/// 原地前移拼接，控制帧可穿插在分片之间。Ping自动回Pong，收到关闭帧回显
+/// 状态码后关闭；协议错误时发送对应状态码的关闭帧并关闭。不支持扩展
+/// (permessage-deflate等)，RSV位非0视为协议错误
+class WebSocketHandler : public StreamHandler {
+public:
+  WebSocketHandler(int fd, std::shared_ptr<const WebSocketCallbacks> callbacks,
+                   const WebSocketLimits &limits = WebSocketLimits())
+      : StreamHandler(fd, limits.initial_buffer_size,
+                      std::max(limits.max_message_size,
+                               limits.max_handshake_size) +
+                          WebSocketCodec::kMaxHeaderSize,
+                      limits.max_pending_output),
+        callbacks_(std::move(callbacks)), limits_(limits) {
+    writer_.out_ = &pending_out_;
+    writer_.output_ = &output_;
+  }
+
+  /// @brief 创建供ReactorCore::SetHandlerFactory使用的工厂，连接共享同一份回调
+  /// @param callbacks
+  /// @param limits
+  /// @return
+  static HandlerFactory
+  Factory(WebSocketCallbacks callbacks,
+          const WebSocketLimits &limits = WebSocketLimits()) {
+    auto shared =
+        std::make_shared<const WebSocketCallbacks>(std::move(callbacks));
+    return [shared, limits](int conn_fd,
+                            int) -> std::unique_ptr<ProtocolHandler> {
+      return std::make_unique<WebSocketHandler>(conn_fd, shared, limits);
+    };
+  }
+
+protected:
+  /// @brief 处理升级请求与缓冲区中所有完整的帧
+  /// @return 回调的消息数
+  size_t ProcessBuffer(ConnId conn_id) override {
+    if (!upgraded_ && !ProcessHandshake(conn_id))
+      return 0;
+
+    size_t handled = 0;
+    while (!close_after_flush_ && !writer_.closed_) {
+      auto [read_ptr, length] = buffer_.GetLinearReadSpace();
+      // 去掩码与分片拼接需要写入接收缓冲区
+      uint8_t *data = const_cast<uint8_t *>(read_ptr);
+      if (length <= scan_offset_)
+        break;
+
+      WebSocketFrameHeader header;
+      int parsed = WebSocketCodec::ParseHeader(data + scan_offset_,
+                                               length - scan_offset_, header);
+      if (parsed == 0)
+        break;
+      if (parsed < 0) {
+        Fail(kWsCloseProtocolError, "invalid payload length");
+        break;
+      }
+      if (!CheckFrame(header))
+        break;
+      size_t frame_size = header.header_size + header.payload_size;
+      if (length - scan_offset_ < frame_size)
+        break;
+
+      uint8_t *payload = data + scan_offset_ + header.header_size;
+      size_t payload_size = header.payload_size;
+      WebSocketCodec::Unmask(payload, payload_size, header.mask);
+
+      if (static_cast<uint8_t>(header.opcode) & 0x08) {
+        HandleControl(header.opcode, payload, payload_size);
+        ConsumeFrame(frame_size);
+        continue;
+      }
+
+      if (header.fin && !in_message_) {
+        // 单帧消息，直接以缓冲区视图回调
+        if (Deliver(conn_id, header.opcode, payload, payload_size))
+          handled++;
+        buffer_.CommitReadSize(frame_size);
+        continue;
+      }
+
+      // 分片负载前移拼接到未读数据起始处，之后的帧位置不变
+      if (!in_message_) {
+        in_message_ = true;
+        message_opcode_ = header.opcode;
+      }
+      memmove(data + assembled_, payload, payload_size);
+      assembled_ += payload_size;
+      scan_offset_ += frame_size;
+      if (header.fin) {
+        if (Deliver(conn_id, message_opcode_, data, assembled_))
+          handled++;
+        buffer_.CommitReadSize(scan_offset_);
+        in_message_ = false;
+        assembled_ = 0;
+        scan_offset_ = 0;
+      }
+    }
+    if (writer_.closed_)
+      CloseAfterFlush();
+    return handled;
+  }
+
+  void OnBufferOverflow() override {
+    if (!upgraded_)
+      RejectHandshake(431);
+    else
+      Fail(kWsCloseMessageTooBig, "message too big");
+  }
+
+private:
+  /// @brief 解析升级请求并应答101
+  /// @return 是否已完成握手
+  bool ProcessHandshake(ConnId conn_id) {
+    auto [read_ptr, length] = buffer_.GetLinearReadSpace();
+    const char *data = reinterpret_cast<const char *>(read_ptr);
+    size_t head_size = HttpParser::FindHeadEnd(data, head_scanned_, length);
+    if (head_size == 0) {
+      head_scanned_ = length;
+      if (length > limits_.max_handshake_size)
+        RejectHandshake(431);
+      return false;
+    }
+
+    HttpRequest request;
+    int status = HttpParser::ParseHead(data, head_size, request);
+    if (status == 0)
+      status = CheckUpgrade(request);
+    if (status == 0 && callbacks_->on_upgrade &&
+        !callbacks_->on_upgrade(request))
+      status = 403;
+    if (status != 0) {
+      RejectHandshake(status);
+      return false;
+    }
+
+    Append("HTTP/1.1 101 Switching Protocols\r\n"
+           "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+           "Sec-WebSocket-Accept: ");
+    Append(WebSocketCodec::AcceptKey(request.Header("Sec-WebSocket-Key")));
+    Append("\r\n\r\n");
+    buffer_.CommitReadSize(head_size);
+    upgraded_ = true;
+    if (callbacks_->on_open)
+      callbacks_->on_open(conn_id, writer_);
+    return true;
+  }
+
+  /// @brief 校验升级请求头
+  /// @return 0为成功，否则为应答的错误状态码
+  static int CheckUpgrade(const HttpRequest &request) {
+    if (request.method != "GET" || request.minor_version < 1)
+      return 400;
+    if (!HttpParser::HasToken(request.Header("Upgrade"), "websocket") ||
+        !HttpParser::HasToken(request.Header("Connection"), "upgrade"))
+      return 400;
+    if (request.Header("Sec-WebSocket-Version") != "13")
+      return 426;
+    // 16字节随机数的Base64编码
+    if (request.Header("Sec-WebSocket-Key").size() != 24)
+      return 400;
+    return 0;
+  }
+
+  /// @brief 拒绝升级请求并在写完后关闭
+  void RejectHandshake(int status) {
+    LOGP_MSG("Reject websocket upgrade on fd:%d,status:%d", fd_, status);
+    switch (status) {
+    case 403: Append("HTTP/1.1 403 Forbidden\r\n"); break;
+    case 426:
+      Append("HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\n");
+      break;
+    case 431: Append("HTTP/1.1 431 Request Header Fields Too Large\r\n"); break;
+    case 505: Append("HTTP/1.1 505 HTTP Version Not Supported\r\n"); break;
+    default: Append("HTTP/1.1 400 Bad Request\r\n"); break;
+    }
+    Append("Content-Length: 0\r\nConnection: close\r\n\r\n");
+    CloseAfterFlush();
+    buffer_.Clear();
+  }
+
+  /// @brief 校验帧头
+  /// @return 不合法时已发送关闭帧
+  bool CheckFrame(const WebSocketFrameHeader &header) {
+    if (header.rsv != 0) {
+      Fail(kWsCloseProtocolError, "reserved bits set");
+      return false;
+    }
+    if (!header.masked) {
+      Fail(kWsCloseProtocolError, "client frame not masked");
+      return false;
+    }
+    switch (header.opcode) {
+    case WebSocketOpcode::kClose:
+    case WebSocketOpcode::kPing:
+    case WebSocketOpcode::kPong:
+      if (!header.fin ||
+          header.payload_size > WebSocketCodec::kMaxControlPayload) {
+        Fail(kWsCloseProtocolError, "invalid control frame");
+        return false;
+      }
+      return true;
+    case WebSocketOpcode::kContinuation:
+      if (!in_message_) {
+        Fail(kWsCloseProtocolError, "unexpected continuation frame");
+        return false;
+      }
+      break;
+    case WebSocketOpcode::kText:
+    case WebSocketOpcode::kBinary:
+      if (in_message_) {
+        Fail(kWsCloseProtocolError, "expected continuation frame");
+        return false;
+      }
+      break;
+    default:
+      Fail(kWsCloseProtocolError, "unknown opcode");
+      return false;
+    }
+    if (header.payload_size > limits_.max_message_size - assembled_) {
+      Fail(kWsCloseMessageTooBig, "message too big");
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief 处理控制帧
+  void HandleControl(WebSocketOpcode opcode, const uint8_t *payload,
+                     size_t size) {
+    std::string_view text(reinterpret_cast<const char *>(payload), size);
+    if (opcode == WebSocketOpcode::kPing) {
+      writer_.Write(WebSocketOpcode::kPong, text);
+    } else if (opcode == WebSocketOpcode::kClose) {
+      // 回显对端的状态码后关闭
+      if (size == 0) {
+        writer_.Close(kWsCloseNormal);
+      } else if (size == 1 || !IsValidCloseCode((payload[0] << 8) | payload[1])) {
+        Fail(kWsCloseProtocolError, "invalid close code");
+      } else if (limits_.validate_utf8 &&
+                 !WebSocketCodec::IsValidUtf8(payload + 2, size - 2)) {
+        Fail(kWsCloseInvalidPayload, "invalid utf-8 close reason");
+      } else {
+        writer_.Close(static_cast<uint16_t>((payload[0] << 8) | payload[1]));
+      }
+    }
+  }
+
+  /// @brief 回调完整消息
+  /// @return 是否回调(文本校验失败时已发送关闭帧)
+  bool Deliver(ConnId conn_id, WebSocketOpcode opcode, const uint8_t *payload,
+               size_t size) {
+    if (opcode == WebSocketOpcode::kText && limits_.validate_utf8 &&
+        !WebSocketCodec::IsValidUtf8(payload, size)) {
+      Fail(kWsCloseInvalidPayload, "invalid utf-8");
+      return false;
+    }
+    message_.conn_id = conn_id;
+    message_.opcode = opcode;
+    message_.payload =
+        std::string_view(reinterpret_cast<const char *>(payload), size);
+    if (!callbacks_->on_message)
+      return true;
+    try {
+      callbacks_->on_message(message_, writer_);
+    } catch (const std::exception &e) {
+      LOGP_ERROR("websocket callback exception on fd:%d:%s", fd_, e.what());
+      writer_.Close(kWsCloseInternalError);
+    }
+    return true;
+  }
+
+  /// @brief 跳过已处理的控制帧；分片消息未完成时保留在缓冲区中
+  void ConsumeFrame(size_t frame_size) {
+    if (in_message_)
+      scan_offset_ += frame_size;
+    else
+      buffer_.CommitReadSize(frame_size);
+  }
+
+  /// @brief 发送关闭帧并在写完后关闭连接
+  void Fail(uint16_t code, std::string_view reason) {
+    LOGP_MSG("Websocket protocol error on fd:%d,code:%u:%.*s", fd_, code,
+             static_cast<int>(reason.size()), reason.data());
+    writer_.Close(code, reason);
+    CloseAfterFlush();
+    buffer_.Clear();
+  }
+
+  /// @brief 对端可发送的关闭状态码
+  static bool IsValidCloseCode(int code) {
+    if (code >= 3000 && code <= 4999)
+      return true;
+    return code >= 1000 && code <= 1014 && code != 1004 && code != 1005 &&
+           code != 1006;
+  }
+
+  std::shared_ptr<const WebSocketCallbacks> callbacks_;
+  WebSocketLimits limits_;
+  WebSocketWriter writer_;
+  WebSocketMessage message_;
+
+  bool upgraded_ = false;
+  size_t head_scanned_ = 0; // 已确认不含请求头结束符的字节数
+  // 分片消息的拼接进度，均为相对未读数据起始的偏移，缓冲区移动后仍然有效
+  bool in_message_ = false;
+  WebSocketOpcode message_opcode_ = WebSocketOpcode::kText;
+  size_t assembled_ = 0;   // 已拼接的负载长度
+  size_t scan_offset_ = 0; // 下一帧的偏移
+};
+
+} // namespace net
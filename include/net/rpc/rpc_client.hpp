@@ -0,0 +1,198 @@
+#pragma once
+#include "rpc_codec.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace net {
+
+/// @brief RPC调用完成回调，在循环线程执行，不应阻塞
+/// @param status
+/// @param payload 响应负载(或错误描述)，仅在回调内有效
+using RpcCallback =
+    std::function<void(RpcStatus status, std::string_view payload)>;
+
+/// @brief RPC客户端参数
+struct RpcClientOptions {
+  size_t buffer_size = 64 * 1024;       // 连接接收缓冲区初始容量
+  uint64_t default_timeout_ms = 5000;   // Call未指定截止时间时使用，0为不限
+  ConnectOptions connect;               // 建连参数，exec_cb与on_close由客户端接管
+};
+
+/// @brief 单连接多路复用的RPC客户端
+/// @note 一个连接上可同时有任意多个未完成的调用，响应按请求ID匹配，可乱序到达。
+/// 调用状态只在循环线程访问：响应帧在循环线程内联解析并回调，不经派发器；
+/// 截止时间由事件循环的时间轮计时；同一轮循环中发起的调用合并为一次发送，
+/// 便于深度流水线。Connect之后、建连完成前发起的调用排队，建连后发出。
+/// 公开接口线程安全；客户端需在事件循环停止后析构
+class RpcClient {
+public:
+  /// @brief 构造并设置事件循环的连接分包参数(仅限Run之前)
+  /// @param reactor
+  /// @param options
+  RpcClient(ReactorCore &reactor,
+            RpcClientOptions options = RpcClientOptions())
+      : reactor_(reactor), options_(std::move(options)) {
+    RpcCodec::ApplyFraming(reactor_, options_.buffer_size);
+  }
+
+  RpcClient(const RpcClient &) = delete;
+  RpcClient &operator=(const RpcClient &) = delete;
+
+  /// @brief 连接服务端，结果在循环线程回调
+  /// @param host 数字地址
+  /// @param port
+  /// @param cb 可为空
+  void Connect(const std::string &host, uint16_t port, ConnectCb cb = nullptr) {
+    ConnectOptions options = options_.connect;
+    options.on_close = [this](ConnId conn_id) { OnClosed(conn_id); };
+    reactor_.RunInLoop([this, host, port, cb = std::move(cb),
+                        options = std::move(options)]() mutable {
+      state_ = State::kConnecting;
+      reactor_.Connect(
+          host, port,
+          [this, cb = std::move(cb)](ConnId conn_id, int error) {
+            OnConnected(conn_id, error);
+            if (cb)
+              cb(conn_id, error);
+          },
+          std::move(options));
+    });
+  }
+
+  /// @brief 发起调用
+  /// @param method_id
+  /// @param payload
+  /// @param cb 完成、超时或断开时恰好回调一次
+  /// @param timeout_ms 截止时间，0为options中的默认值
+  void Call(uint16_t method_id, std::string payload, RpcCallback cb,
+            uint64_t timeout_ms = 0) {
+    reactor_.RunInLoop([this, method_id, payload = std::move(payload),
+                        cb = std::move(cb), timeout_ms]() mutable {
+      CallInLoop(method_id, payload, std::move(cb), timeout_ms);
+    });
+  }
+
+  /// @brief 未完成的调用数，仅限循环线程调用
+  size_t Pending() const { return pending_.size(); }
+
+private:
+  enum class State { kIdle, kConnecting, kConnected, kClosed };
+
+  struct PendingCall {
+    RpcCallback cb;
+    threading::TimerId timer = 0;
+    bool timer_armed = false;
+  };
+
+  void CallInLoop(uint16_t method_id, std::string_view payload,
+                  RpcCallback cb, uint64_t timeout_ms) {
+    if (state_ == State::kClosed || state_ == State::kIdle) {
+      cb(RpcStatus::kDisconnected, "not connected");
+      return;
+    }
+
+    uint32_t request_id = next_request_id_++;
+    PendingCall &call = pending_[request_id];
+    call.cb = std::move(cb);
+    if (timeout_ms == 0)
+      timeout_ms = options_.default_timeout_ms;
+    if (timeout_ms) {
+      call.timer = reactor_.RunAfter(
+          timeout_ms, [this, request_id]() { OnTimeout(request_id); });
+      call.timer_armed = true;
+    }
+
+    RpcFrameHeader header;
+    header.type = RpcFrameType::kRequest;
+    header.request_id = request_id;
+    header.method_id = method_id;
+    // 本轮循环末尾统一发出
+    bool schedule = out_.empty() && state_ == State::kConnected;
+    RpcCodec::Encode(header, payload, out_);
+    if (schedule)
+      reactor_.QueueInLoop([this]() { Flush(); });
+  }
+
+  void Flush() {
+    if (state_ != State::kConnected || out_.empty())
+      return;
+    reactor_.Send(conn_id_, std::move(out_));
+    out_.clear();
+  }
+
+  void OnConnected(ConnId conn_id, int error) {
+    if (error != 0) {
+      LOGP_WARN("rpc connect failed,errno:%d", error);
+      state_ = State::kClosed;
+      out_.clear();
+      FailAll("connect failed");
+      return;
+    }
+    state_ = State::kConnected;
+    conn_id_ = conn_id;
+    // 响应在循环线程内联处理，调用状态无需加锁
+    reactor_.SetConnInlineCallback(
+        conn_id, [this](ConnId, std::vector<std::vector<uint8_t>> &packs) {
+          OnResponses(packs);
+        });
+    Flush();
+  }
+
+  void OnResponses(std::vector<std::vector<uint8_t>> &packs) {
+    for (const auto &pack : packs) {
+      RpcFrameHeader header;
+      std::string_view payload;
+      if (!RpcCodec::Decode(pack, header, payload) ||
+          header.type != RpcFrameType::kResponse)
+        continue;
+      auto it = pending_.find(header.request_id);
+      if (it == pending_.end())
+        continue; // 已超时
+      PendingCall call = std::move(it->second);
+      pending_.erase(it);
+      if (call.timer_armed)
+        reactor_.CancelTimer(call.timer);
+      call.cb(header.status, payload);
+    }
+  }
+
+  void OnTimeout(uint32_t request_id) {
+    auto it = pending_.find(request_id);
+    if (it == pending_.end())
+      return;
+    PendingCall call = std::move(it->second);
+    pending_.erase(it);
+    call.cb(RpcStatus::kTimeout, "deadline exceeded");
+  }
+
+  void OnClosed(ConnId conn_id) {
+    if (conn_id != conn_id_)
+      return;
+    state_ = State::kClosed;
+    out_.clear();
+    FailAll("connection closed");
+  }
+
+  /// @brief 以kDisconnected完成所有未完成的调用
+  void FailAll(std::string_view reason) {
+    std::unordered_map<uint32_t, PendingCall> pending;
+    pending.swap(pending_);
+    for (auto &[request_id, call] : pending) {
+      if (call.timer_armed)
+        reactor_.CancelTimer(call.timer);
+      call.cb(RpcStatus::kDisconnected, reason);
+    }
+  }
+
+  ReactorCore &reactor_;
+  RpcClientOptions options_;
+
+  // 以下只在循环线程访问
+  State state_ = State::kIdle;
+  ConnId conn_id_ = 0;
+  uint32_t next_request_id_ = 1;
+  std::unordered_map<uint32_t, PendingCall> pending_;
+  std::vector<uint8_t> out_; // 本轮循环待发送的请求帧
+};
+
+} // namespace net
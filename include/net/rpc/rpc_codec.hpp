@@ -0,0 +1,118 @@
+#pragma once
+#include "../core/reactor_core.hpp"
+#include <string_view>
+
+namespace net {
+
+/// @brief RPC帧类型
+enum class RpcFrameType : uint8_t { kRequest = 0, kResponse = 1 };
+
+/// @brief RPC调用状态，响应帧携带前三种，其余由客户端本地产生
+enum class RpcStatus : uint8_t {
+  kOk = 0,
+  kMethodNotFound = 1, // 服务端未注册该方法
+  kMethodError = 2,    // 方法抛出异常，负载为异常描述
+  kOverloaded = 3,     // 服务端在途请求已达上限
+  kTimeout = 4,        // 截止时间前未收到响应
+  kDisconnected = 5,   // 连接失败或在响应前断开
+};
+
+/// @brief RPC帧头(网络字节序)
+struct RpcFrameHeader {
+  RpcFrameType type = RpcFrameType::kRequest;
+  RpcStatus status = RpcStatus::kOk;
+  uint32_t request_id = 0;
+  uint16_t method_id = 0;
+  uint32_t payload_size = 0;
+};
+
+/// @brief RPC帧编解码
+/// @note 帧格式: 魔数'N''R' 类型1 状态1 请求ID4 方法ID2 负载长度4 负载 尾0x0A，
+/// 由UnPacker回调模式分包(头定位符为魔数，尾定位符为0x0A)
+class RpcCodec {
+public:
+  static constexpr size_t kHeaderSize = 14;
+  static constexpr uint8_t kMagic0 = 'N';
+  static constexpr uint8_t kMagic1 = 'R';
+  static constexpr uint8_t kTail = 0x0A;
+  // 长度回调依赖UnPacker在头部收全后才判定包长
+  static_assert(kHeaderSize <= containers::UnPacker::kMaxHeadPeek,
+                "RPC header must fit in the UnPacker head peek window");
+
+  /// @brief 设置事件循环的连接分包参数为RPC帧格式
+  /// @note SetConnHandlerParams对事件循环的所有TCP连接生效，RPC服务端与客户端
+  /// 可共用同一个事件循环；仅限Run之前调用
+  /// @param reactor
+  /// @param buffer_size 接收缓冲区初始容量，需容纳最大的帧或配合RecvBufferPolicy扩容
+  static void ApplyFraming(ReactorCore &reactor, size_t buffer_size) {
+    reactor.SetConnHandlerParams(
+        containers::HeadKey{kMagic0, kMagic1}, containers::TailKey{kTail},
+        [](const uint8_t *head, size_t &head_size, size_t &data_size,
+           size_t &tail_size) {
+          head_size = kHeaderSize;
+          data_size = ReadU32(head + 10);
+          tail_size = 1;
+        },
+        [](const uint8_t *frame) { return frame[2] <= 1; }, nullptr,
+        buffer_size);
+  }
+
+  /// @brief 追加编码一帧
+  /// @param header payload_size由payload决定
+  /// @param payload
+  /// @param out
+  static void Encode(const RpcFrameHeader &header, std::string_view payload,
+                     std::vector<uint8_t> &out) {
+    size_t offset = out.size();
+    out.resize(offset + kHeaderSize + payload.size() + 1);
+    uint8_t *p = out.data() + offset;
+    p[0] = kMagic0;
+    p[1] = kMagic1;
+    p[2] = static_cast<uint8_t>(header.type);
+    p[3] = static_cast<uint8_t>(header.status);
+    WriteU32(p + 4, header.request_id);
+    p[8] = static_cast<uint8_t>(header.method_id >> 8);
+    p[9] = static_cast<uint8_t>(header.method_id);
+    WriteU32(p + 10, static_cast<uint32_t>(payload.size()));
+    if (!payload.empty())
+      memcpy(p + kHeaderSize, payload.data(), payload.size());
+    p[kHeaderSize + payload.size()] = kTail;
+  }
+
+  /// @brief 解码UnPacker分出的完整帧
+  /// @param frame
+  /// @param header 输出
+  /// @param payload 输出，指向frame
+  /// @return 长度不一致返回false
+  static bool Decode(const std::vector<uint8_t> &frame, RpcFrameHeader &header,
+                     std::string_view &payload) {
+    if (frame.size() < kHeaderSize + 1)
+      return false;
+    const uint8_t *p = frame.data();
+    header.type = static_cast<RpcFrameType>(p[2]);
+    header.status = static_cast<RpcStatus>(p[3]);
+    header.request_id = ReadU32(p + 4);
+    header.method_id = static_cast<uint16_t>((p[8] << 8) | p[9]);
+    header.payload_size = ReadU32(p + 10);
+    if (frame.size() != kHeaderSize + header.payload_size + 1)
+      return false;
+    payload = std::string_view(reinterpret_cast<const char *>(p + kHeaderSize),
+                               header.payload_size);
+    return true;
+  }
+
+private:
+  static uint32_t ReadU32(const uint8_t *p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+           (uint32_t(p[2]) << 8) | p[3];
+  }
+
+  static void WriteU32(uint8_t *p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+  }
+};
+
+} // namespace net
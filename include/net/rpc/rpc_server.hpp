@@ -0,0 +1,143 @@
+#pragma once
+#include "../../threading/thread_pool.hpp"
+#include "rpc_codec.hpp"
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+namespace net {
+
+/// @brief 服务端收到的请求，payload仅在方法执行期间有效
+struct RpcRequest {
+  ConnId conn_id = 0;
+  uint32_t request_id = 0;
+  uint16_t method_id = 0;
+  std::string_view payload;
+};
+
+/// @brief RPC方法，在工作线程执行，向response写入响应负载
+/// @note 抛出异常时以kMethodError响应，负载为异常描述
+using RpcMethod =
+    std::function<void(const RpcRequest &request, std::string &response)>;
+
+/// @brief RPC服务端参数
+struct RpcServerOptions {
+  size_t buffer_size = 64 * 1024; // 连接接收缓冲区初始容量
+  size_t max_inflight = 65536;    // 已接收未响应的请求上限，超过时以kOverloaded拒绝
+};
+
+/// @brief 请求多路复用的RPC服务端
+/// @note 请求帧由UnPacker回调模式分包，每个请求作为独立任务投递到线程池，
+/// 同一连接上的请求并发执行，响应完成即经ReactorCore::Send写回(可乱序)，
+/// 客户端按请求ID匹配。未提供线程池时在派发器工作线程依次执行，
+/// 同一批次的响应合并为一次发送。
+/// 方法需在Run之前注册；服务端需在事件循环与线程池停止后析构
+class RpcServer {
+public:
+  /// @brief 构造并接管事件循环的连接分包参数与业务回调
+  /// @param reactor
+  /// @param pool 方法执行的线程池，为空时在派发器工作线程执行
+  /// @param options
+  RpcServer(ReactorCore &reactor, ThreadPool *pool = nullptr,
+            const RpcServerOptions &options = RpcServerOptions())
+      : reactor_(reactor), pool_(pool), options_(options) {
+    RpcCodec::ApplyFraming(reactor_, options_.buffer_size);
+    reactor_.SetConnExecCallback(
+        [this](ConnId conn_id, std::vector<std::vector<uint8_t>> &packs) {
+          OnPackets(conn_id, packs);
+        });
+  }
+
+  RpcServer(const RpcServer &) = delete;
+  RpcServer &operator=(const RpcServer &) = delete;
+
+  /// @brief 注册方法，仅限Run之前调用
+  /// @param method_id
+  /// @param method
+  void Register(uint16_t method_id, RpcMethod method) {
+    methods_[method_id] = std::move(method);
+  }
+
+  /// @brief 已接收未响应的请求数
+  size_t Inflight() const { return inflight_.load(std::memory_order_relaxed); }
+
+private:
+  /// @brief 派发器工作线程上处理一批请求帧
+  void OnPackets(ConnId conn_id, std::vector<std::vector<uint8_t>> &packs) {
+    std::vector<uint8_t> out;
+    std::vector<CallBack> tasks;
+    for (auto &pack : packs) {
+      RpcFrameHeader header;
+      std::string_view payload;
+      if (!RpcCodec::Decode(pack, header, payload) ||
+          header.type != RpcFrameType::kRequest)
+        continue;
+
+      if (inflight_.fetch_add(1, std::memory_order_relaxed) >=
+          options_.max_inflight) {
+        inflight_.fetch_sub(1, std::memory_order_relaxed);
+        Reply(header, RpcStatus::kOverloaded, std::string_view(), out);
+        continue;
+      }
+      if (!pool_) {
+        Execute(conn_id, header, payload, out);
+        continue;
+      }
+      tasks.emplace_back([this, conn_id, header,
+                          pack = std::move(pack)]() -> size_t {
+        std::string_view payload(
+            reinterpret_cast<const char *>(pack.data()) + RpcCodec::kHeaderSize,
+            header.payload_size);
+        std::vector<uint8_t> response;
+        Execute(conn_id, header, payload, response);
+        reactor_.Send(conn_id, std::move(response));
+        return 0;
+      });
+    }
+    if (!tasks.empty())
+      pool_->PostTask(std::move(tasks));
+    if (!out.empty())
+      reactor_.Send(conn_id, std::move(out));
+  }
+
+  /// @brief 执行方法并追加编码响应
+  void Execute(ConnId conn_id, const RpcFrameHeader &header,
+               std::string_view payload, std::vector<uint8_t> &out) {
+    auto it = methods_.find(header.method_id);
+    if (it == methods_.end()) {
+      Reply(header, RpcStatus::kMethodNotFound, std::string_view(), out);
+    } else {
+      RpcRequest request{conn_id, header.request_id, header.method_id,
+                         payload};
+      // 线程局部的响应缓冲，复用容量
+      thread_local std::string response;
+      response.clear();
+      try {
+        it->second(request, response);
+        Reply(header, RpcStatus::kOk, response, out);
+      } catch (const std::exception &e) {
+        LOGP_ERROR("rpc method %u exception:%s", header.method_id, e.what());
+        Reply(header, RpcStatus::kMethodError, e.what(), out);
+      }
+    }
+    inflight_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  static void Reply(const RpcFrameHeader &request, RpcStatus status,
+                    std::string_view payload, std::vector<uint8_t> &out) {
+    RpcFrameHeader header;
+    header.type = RpcFrameType::kResponse;
+    header.status = status;
+    header.request_id = request.request_id;
+    header.method_id = request.method_id;
+    RpcCodec::Encode(header, payload, out);
+  }
+
+  ReactorCore &reactor_;
+  ThreadPool *pool_;
+  RpcServerOptions options_;
+  std::unordered_map<uint16_t, RpcMethod> methods_; // Run之后只读
+  std::atomic<size_t> inflight_{0};
+};
+
+} // namespace net
@@ -1,20 +1,39 @@
 #pragma once
+#include <cstdint>
+#include <sys/epoll.h>
 namespace net {
 
+/// @brief 事件标志，取值与epoll事件位一致，转换时只需按位与
 enum EventFlags {
-  kNone = 0,     // 无事件标志
-  kReadable = 1, // 可读事件
-  kWritable = 2, // 可写事件
-  kError = 4,    // 错误事件
-  kHangUp = 8    // 连接挂起
+  kNone = 0,            // 无事件标志
+  kReadable = EPOLLIN,  // 可读事件
+  kWritable = EPOLLOUT, // 可写事件
+  kError = EPOLLERR,    // 错误事件
+  kHangUp = EPOLLHUP    // 连接挂起
 };
 
+constexpr uint32_t kEventFlagsMask = kReadable | kWritable | kError | kHangUp;
+
 enum TriggerMode { kEt, kLt };
 
+/// @brief 连接ID:高32位为fd槽位代数，低32位为fd，fd关闭复用后旧ID失效
+using ConnId = uint64_t;
+
+inline ConnId MakeConnId(int fd, uint32_t generation) {
+  return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+inline int ConnIdToFd(ConnId conn_id) {
+  return static_cast<int>(conn_id & 0xFFFFFFFFu);
+}
+inline uint32_t ConnIdToGeneration(ConnId conn_id) {
+  return static_cast<uint32_t>(conn_id >> 32);
+}
+
 // 事件结构
 struct Event {
   int fd;
   EventFlags event_flags;
+  ConnId conn_id = 0;
 };
 
-} // namespace net
\ No newline at end of file
+} // namespace net
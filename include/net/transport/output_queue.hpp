@@ -0,0 +1,392 @@
+#pragma once
+#include "../../logger/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <memory>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+/// @brief 作用域内屏蔽本线程的SIGPIPE
+/// @note sendfile/splice没有MSG_NOSIGNAL等价选项，向已重置的对端写入会触发
+/// SIGPIPE并默认终止进程。屏蔽期间写入只返回EPIPE，析构时取走本次产生的
+/// 挂起信号并恢复原掩码，不修改进程级的信号处置
+class SigPipeGuard {
+public:
+  SigPipeGuard() {
+    sigemptyset(&sigpipe_);
+    sigaddset(&sigpipe_, SIGPIPE);
+    sigset_t pending;
+    sigpending(&pending);
+    was_pending_ = sigismember(&pending, SIGPIPE) == 1;
+    blocked_ = pthread_sigmask(SIG_BLOCK, &sigpipe_, &old_mask_) == 0;
+  }
+
+  ~SigPipeGuard() {
+    if (!blocked_)
+      return;
+    const int saved_errno = errno; // 调用方随后据errno判断写入结果
+    if (!was_pending_) {
+      const timespec zero{0, 0};
+      while (sigtimedwait(&sigpipe_, nullptr, &zero) == SIGPIPE ||
+             errno == EINTR) {
+      }
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask_, nullptr);
+    errno = saved_errno;
+  }
+
+  SigPipeGuard(const SigPipeGuard &) = delete;
+  SigPipeGuard &operator=(const SigPipeGuard &) = delete;
+
+private:
+  sigset_t sigpipe_;
+  sigset_t old_mask_;
+  bool was_pending_ = false;
+  bool blocked_ = false;
+};
+
+/// @brief 随数据发送的文件描述符(SCM_RIGHTS，仅AF_UNIX)
+/// @note owned为true时析构关闭，内核在发送时已复制描述符
+struct FdList {
+  FdList(std::vector<int> fds, bool owned) : fds(std::move(fds)), owned(owned) {}
+  ~FdList() {
+    if (owned)
+      for (int fd : fds)
+        close(fd);
+  }
+  FdList(const FdList &) = delete;
+  FdList &operator=(const FdList &) = delete;
+
+  std::vector<int> fds;
+  bool owned;
+};
+
+/// @brief 单条消息可携带的最大描述符数(内核SCM_MAX_FD)
+constexpr size_t kMaxPassFds = 253;
+
+/// @brief 待发送数据块
+/// @note owner持有底层缓冲或文件，直到数据发送完成(零拷贝时直到内核完成通知)
+struct OutputChunk {
+  enum class Kind : uint8_t {
+    kBuffer, // 用户内存
+    kFile,   // 文件区间，使用sendfile
+    kPipe,   // 管道中的数据，使用splice
+  };
+
+  Kind kind = Kind::kBuffer;
+  std::shared_ptr<const void> owner;
+  const uint8_t *data = nullptr; // kBuffer
+  int fd = -1;                   // kFile/kPipe
+  off_t offset = 0;              // kFile文件偏移
+  size_t length = 0;             // 剩余长度
+  std::shared_ptr<const FdList> fds; // 随本块首字节发送的描述符
+
+  /// @brief 移入数据构造
+  /// @param data
+  /// @return
+  static OutputChunk FromVector(std::vector<uint8_t> &&data) {
+    return FromBuffer(
+        std::make_shared<const std::vector<uint8_t>>(std::move(data)));
+  }
+
+  /// @brief 移入数据并附带文件描述符构造(AF_UNIX)
+  /// @param data 至少1字节
+  /// @param fds 不超过kMaxPassFds个
+  /// @param take_ownership 为true时发送完成或连接关闭后关闭fds
+  /// @return
+  static OutputChunk FromVectorWithFds(std::vector<uint8_t> &&data,
+                                       std::vector<int> fds,
+                                       bool take_ownership = true) {
+    OutputChunk chunk = FromVector(std::move(data));
+    if (!fds.empty())
+      chunk.fds = std::make_shared<const FdList>(std::move(fds), take_ownership);
+    return chunk;
+  }
+
+  /// @brief 共享缓冲构造，多个连接可发送同一份数据
+  /// @param buffer
+  /// @return
+  static OutputChunk FromBuffer(std::shared_ptr<const std::vector<uint8_t>> buffer) {
+    OutputChunk chunk;
+    chunk.kind = Kind::kBuffer;
+    chunk.data = buffer ? buffer->data() : nullptr;
+    chunk.length = buffer ? buffer->size() : 0;
+    chunk.owner = std::move(buffer);
+    return chunk;
+  }
+
+  /// @brief 文件区间构造
+  /// @param file_fd
+  /// @param offset
+  /// @param length
+  /// @param take_ownership 为true时发送完成后关闭file_fd
+  /// @return
+  static OutputChunk FromFile(int file_fd, off_t offset, size_t length,
+                              bool take_ownership = false) {
+    OutputChunk chunk;
+    chunk.kind = Kind::kFile;
+    chunk.fd = file_fd;
+    chunk.offset = offset;
+    chunk.length = length;
+    if (take_ownership)
+      chunk.owner = std::make_shared<const FdHolder>(file_fd);
+    return chunk;
+  }
+
+  /// @brief 管道构造，管道中需已有length字节(如由vmsplice或splice填充)
+  /// @param pipe_fd
+  /// @param length
+  /// @param take_ownership 为true时发送完成后关闭pipe_fd
+  /// @return
+  static OutputChunk FromPipe(int pipe_fd, size_t length,
+                              bool take_ownership = false) {
+    OutputChunk chunk = FromFile(pipe_fd, 0, length, take_ownership);
+    chunk.kind = Kind::kPipe;
+    return chunk;
+  }
+
+private:
+  struct FdHolder {
+    explicit FdHolder(int fd) : fd(fd) {}
+    ~FdHolder() { close(fd); }
+    int fd;
+  };
+};
+
+/// @brief 连接发送队列
+/// 内存块合并为一次sendmsg；大块可使用MSG_ZEROCOPY，内核完成通知前保持
+/// 缓冲存活；文件与管道分别使用sendfile、splice，数据不经过用户态
+/// @note 单线程使用(由事件循环独占)
+class OutputQueue {
+public:
+  enum class FlushResult : uint8_t {
+    kDone,    // 已全部写入
+    kBlocked, // 发送缓冲区满，等待可写
+    kError,   // 连接错误
+  };
+
+  /// @brief 开启MSG_ZEROCOPY
+  /// @param sock_fd
+  /// @param threshold 不小于该长度的内存块使用零拷贝发送
+  /// @return 内核是否支持
+  bool EnableZeroCopy(int sock_fd, size_t threshold) {
+    int on = 1;
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) != 0)
+      return false;
+    zerocopy_threshold_ = std::max<size_t>(threshold, 1);
+    zerocopy_enabled_ = true;
+    return true;
+  }
+
+  void Push(OutputChunk &&chunk) {
+    if (chunk.length == 0)
+      return;
+    pending_bytes_ += chunk.length;
+    chunks_.push_back(std::move(chunk));
+  }
+
+  /// @brief 尽可能多地写入套接字
+  /// @param sock_fd
+  /// @return
+  FlushResult Flush(int sock_fd) {
+    bool copy_front = false; // 队首块本次改用普通发送
+    while (!chunks_.empty()) {
+      OutputChunk &front = chunks_.front();
+      ssize_t n = 0;
+      switch (front.kind) {
+      case OutputChunk::Kind::kBuffer:
+        n = UseZeroCopy(front) && !copy_front ? SendZeroCopy(sock_fd, front)
+                                              : SendBuffers(sock_fd);
+        copy_front = false;
+        break;
+      case OutputChunk::Kind::kFile: {
+        SigPipeGuard guard;
+        n = sendfile(sock_fd, front.fd, &front.offset,
+                     std::min<size_t>(front.length, kMaxTransfer));
+        if (n > 0)
+          Consume(static_cast<size_t>(n));
+        break;
+      }
+      case OutputChunk::Kind::kPipe: {
+        SigPipeGuard guard;
+        n = splice(front.fd, nullptr, sock_fd, nullptr,
+                   std::min<size_t>(front.length, kMaxTransfer),
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK |
+                       (chunks_.size() > 1 ? SPLICE_F_MORE : 0));
+        if (n > 0)
+          Consume(static_cast<size_t>(n));
+        break;
+      }
+      }
+
+      if (n > 0)
+        continue;
+      if (n == 0) {
+        // 文件被截断或管道写端关闭，丢弃剩余部分
+        LOGP_WARN("output source exhausted on fd:%d,dropped:%lu", sock_fd,
+                  front.length);
+        Consume(front.length);
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return FlushResult::kBlocked;
+      if (errno == ENOBUFS && UseZeroCopy(front)) {
+        // 零拷贝锁定内存超出限制，本块退回普通发送，后续块仍尝试零拷贝
+        copy_front = true;
+        continue;
+      }
+      return FlushResult::kError;
+    }
+    return FlushResult::kDone;
+  }
+
+  /// @brief 读取套接字错误队列中的零拷贝完成通知并释放对应缓冲
+  /// @param sock_fd
+  /// @return 释放的缓冲个数
+  size_t ReapCompletions(int sock_fd) {
+    size_t released = 0;
+    while (!zc_inflight_.empty()) {
+      alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(sock_extended_err)) + 64];
+      msghdr msg{};
+      msg.msg_control = ctrl;
+      msg.msg_controllen = sizeof(ctrl);
+      if (recvmsg(sock_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        break;
+
+      for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+           cm = CMSG_NXTHDR(&msg, cm)) {
+        auto *err = reinterpret_cast<sock_extended_err *>(CMSG_DATA(cm));
+        if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+          continue;
+        // 内核回退为拷贝(如回环设备)时零拷贝无收益，后续直接普通发送
+        if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+          zerocopy_threshold_ = 0;
+        // [ee_info, ee_data]为已完成的发送序号区间，按序到达
+        uint32_t hi = err->ee_data;
+        while (!zc_inflight_.empty() &&
+               static_cast<int32_t>(zc_inflight_.front().first - hi) <= 0) {
+          zc_inflight_.pop_front();
+          ++released;
+        }
+      }
+    }
+    return released;
+  }
+
+  /// @brief 是否还有未写入套接字的数据
+  /// @return
+  bool Empty() const { return chunks_.empty(); }
+
+  /// @brief 未写入的字节数
+  /// @return
+  size_t PendingBytes() const { return pending_bytes_; }
+
+  /// @brief 已写入但尚未收到完成通知的零拷贝发送个数
+  /// @return
+  size_t ZeroCopyInflight() const { return zc_inflight_.size(); }
+
+  /// @brief 是否曾开启零拷贝(开启后错误事件可能只是完成通知)
+  /// @return
+  bool ZeroCopyEnabled() const { return zerocopy_enabled_; }
+
+private:
+  static constexpr size_t kMaxIov = 64;
+  static constexpr size_t kMaxTransfer = 1u << 30;
+
+  bool UseZeroCopy(const OutputChunk &chunk) const {
+    return zerocopy_threshold_ != 0 && chunk.kind == OutputChunk::Kind::kBuffer &&
+           !chunk.fds && chunk.length >= zerocopy_threshold_;
+  }
+
+  /// @brief 合并队首连续的普通内存块为一次sendmsg
+  /// @note 携带描述符的块只能作为一次sendmsg的首块，描述符随其首字节送达
+  ssize_t SendBuffers(int sock_fd) {
+    iovec iovs[kMaxIov];
+    size_t count = 0;
+    for (auto it = chunks_.begin(); it != chunks_.end() && count < kMaxIov;
+         ++it) {
+      if (it->kind != OutputChunk::Kind::kBuffer ||
+          (count > 0 && (UseZeroCopy(*it) || it->fds)))
+        break;
+      iovs[count].iov_base = const_cast<uint8_t *>(it->data);
+      iovs[count].iov_len = it->length;
+      ++count;
+    }
+    msghdr msg{};
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = count;
+
+    std::vector<uint8_t> ctrl;
+    const std::shared_ptr<const FdList> &fds = chunks_.front().fds;
+    if (fds) {
+      size_t fd_bytes = sizeof(int) * fds->fds.size();
+      ctrl.assign(CMSG_SPACE(fd_bytes), 0);
+      msg.msg_control = ctrl.data();
+      msg.msg_controllen = ctrl.size();
+      cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+      cm->cmsg_level = SOL_SOCKET;
+      cm->cmsg_type = SCM_RIGHTS;
+      cm->cmsg_len = CMSG_LEN(fd_bytes);
+      memcpy(CMSG_DATA(cm), fds->fds.data(), fd_bytes);
+    }
+
+    ssize_t n = sendmsg(sock_fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n > 0) {
+      chunks_.front().fds.reset(); // 已随首字节送达，剩余部分不再携带
+      Consume(static_cast<size_t>(n));
+    }
+    return n;
+  }
+
+  /// @brief 零拷贝发送队首块，每次成功调用占用一个完成序号
+  ssize_t SendZeroCopy(int sock_fd, OutputChunk &chunk) {
+    ssize_t n = send(sock_fd, chunk.data, chunk.length,
+                     MSG_NOSIGNAL | MSG_DONTWAIT | MSG_ZEROCOPY);
+    if (n > 0) {
+      zc_inflight_.emplace_back(zc_next_seq_++, chunk.owner);
+      Consume(static_cast<size_t>(n));
+    }
+    return n;
+  }
+
+  /// @brief 从队首推进n字节
+  /// @note sendfile已自行推进文件偏移
+  void Consume(size_t n) {
+    pending_bytes_ -= n;
+    while (n > 0) {
+      OutputChunk &front = chunks_.front();
+      size_t step = std::min(n, front.length);
+      if (front.kind == OutputChunk::Kind::kBuffer)
+        front.data += step;
+      front.length -= step;
+      n -= step;
+      if (front.length == 0)
+        chunks_.pop_front();
+    }
+  }
+
+  std::deque<OutputChunk> chunks_;
+  size_t pending_bytes_ = 0;
+
+  // 零拷贝：序号与缓冲持有者，完成通知到达前保持缓冲存活
+  bool zerocopy_enabled_ = false;
+  size_t zerocopy_threshold_ = 0; // 0表示不再使用零拷贝
+  uint32_t zc_next_seq_ = 0;
+  std::deque<std::pair<uint32_t, std::shared_ptr<const void>>> zc_inflight_;
+};
+
+} // namespace net
@@ -1,17 +1,37 @@
 #pragma once
 #include "../../containers/unpacker.hpp"
+#include "../core/flow_control.hpp"
+#include "../core/packet_dispatcher.hpp"
+#include "../core/reactor_metrics.hpp"
+#include "../core/traffic_capture.hpp"
 #include "enums.hpp"
+#include "output_queue.hpp"
 #include <functional>
 #include <memory>
+#include <netinet/udp.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 namespace net {
 
-/// @brief 业务执行回调类型定义
-/// @param packs 解析后的数据包
-using ExecCb = std::function<void(std::vector<std::vector<uint8_t>> &packs)>;
+/// @brief 单次可读事件的读取预算，0表示不限
+/// @note 边缘触发下一个高速发送方可能长时间独占循环，用尽预算的连接
+/// 由ReactorCore放入就绪列表，在下一次阻塞等待前轮转补读
+struct ReadBudget {
+  size_t max_bytes = 0;
+  size_t max_packets = 0;
+};
+
+/// @brief 连接接收缓冲区(解包器)容量策略
+/// @note 从初始容量起步，一次可读事件中连续读满缓冲区或回调模式下待收的包
+/// 超过容量时翻倍扩容，最多到上限；空闲超过shrink_idle_ms后收缩回下限
+struct RecvBufferPolicy {
+  size_t initial_size = 0;     // 初始容量，0为SetConnHandlerParams的buffer_size
+  size_t max_size = 0;         // 容量上限，不大于初始容量时固定大小
+  size_t min_size = 0;         // 收缩下限，0为初始容量
+  uint64_t shrink_idle_ms = 0; // 收缩所需的空闲时长，0为不收缩
+};
 
 /// @brief 协议处理器基类
 /// 处理不同协议的事件，提供统一接口
@@ -19,36 +39,223 @@ using ExecCb = std::function<void(std::vector<std::vector<uint8_t>> &packs)>;
 /// 通过继承此类实现具体协议的处理逻辑
 class ProtocolHandler {
 public:
-  virtual void
-  HandleEvent(int epoll_fd, const Event &event,
-              std::shared_ptr<threading::TimerScheduler> timer_shceduler) = 0;
+  virtual void HandleEvent(int epoll_fd, const Event &event,
+                           PacketDispatcher &dispatcher) = 0;
   virtual bool ShouldClose() const { return false; }
+  /// @brief 是否有待发送数据，用于写超时判定与EPOLLOUT注册
+  virtual bool HasPendingOutput() const { return false; }
+  /// @brief 追加待发送数据并尝试立即写出，不支持发送的协议返回false
+  /// @note 仅在事件循环线程调用，其他线程经ReactorCore::Send投递
+  virtual bool Send(OutputChunk &&) { return false; }
+  /// @brief 读取零拷贝完成通知，返回仍被内核引用的发送个数
+  /// @note 非0时关闭连接需保留fd与缓冲，直到完成通知全部到达
+  virtual size_t ReapZeroCopy() { return 0; }
+  /// @brief 空闲时收缩接收缓冲区，不支持或无需收缩返回false
+  virtual bool ShrinkRecvBuffer() { return false; }
   virtual ~ProtocolHandler() = default;
+
+  /// @brief 注入流控状态(由ReactorCore在注册时调用)
+  /// @param flow
+  void SetFlow(std::shared_ptr<FlowControl::ConnFlow> flow) {
+    flow_ = std::move(flow);
+  }
+
+  /// @brief 连接统计，循环线程更新，任意线程可读
+  /// @return
+  const ConnStats &Stats() const { return stats_; }
+
+  /// @brief 上次事件处理是否因流控提前停止读取(读取后清除)
+  /// @return
+  bool ConsumeReadThrottled() {
+    bool throttled = read_throttled_;
+    read_throttled_ = false;
+    return throttled;
+  }
+
+  /// @brief 设置循环线程内联回调，设置后解析出的包不再派发给工作线程
+  /// @note 回调在HandleEvent内执行，不得同步关闭本连接(应经QueueInLoop延后)
+  /// @param cb 为空时恢复派发
+  void SetInlineCallback(std::shared_ptr<const ConnExecCb> cb) {
+    inline_cb_ = std::move(cb);
+  }
+
+  /// @brief 设置单次可读事件的读取预算(由ReactorCore在注册时调用)
+  /// @param budget
+  void SetReadBudget(const ReadBudget &budget) { read_budget_ = budget; }
+
+  /// @brief 设置抓包写入器(由ReactorCore在注册时调用)，为空时关闭抓包
+  /// @param capture
+  void SetCapture(std::shared_ptr<TrafficCapture> capture) {
+    capture_ = std::move(capture);
+  }
+
+  /// @brief 上次事件处理是否因预算用尽提前停止读取(读取后清除)
+  /// @note 为true时套接字可能仍有数据，边缘触发不会再次通知
+  /// @return
+  bool ConsumeBudgetExhausted() {
+    bool exhausted = budget_exhausted_;
+    budget_exhausted_ = false;
+    return exhausted;
+  }
+
+protected:
+  /// @brief 开始一次可读事件的预算计量
+  void BeginReadBudget() { budget_bytes_ = budget_packets_ = 0; }
+
+  /// @brief 计入本次事件已读取的字节与包数
+  void ChargeReadBudget(size_t bytes, size_t packets) {
+    budget_bytes_ += bytes;
+    budget_packets_ += packets;
+  }
+
+  /// @brief 本次事件的读取预算已用尽，应让出循环
+  /// @return
+  bool ReadBudgetSpent() {
+    if ((read_budget_.max_bytes && budget_bytes_ >= read_budget_.max_bytes) ||
+        (read_budget_.max_packets &&
+         budget_packets_ >= read_budget_.max_packets))
+      budget_exhausted_ = true;
+    return budget_exhausted_;
+  }
+
+  /// @brief 在途批次已达上限，应停止读取
+  /// @return
+  bool ReadThrottled() {
+    if (flow_ && flow_->Saturated())
+      read_throttled_ = true;
+    return read_throttled_;
+  }
+
+  /// @brief 抓包开启时记录一次接收
+  void Capture(ConnId conn_id, CaptureKind kind, const uint8_t *data,
+               size_t size) {
+    if (capture_)
+      capture_->Append(conn_id, kind, data, size);
+  }
+
+  /// @brief 派发批次并计入流控
+  /// @param dispatcher
+  /// @param batch
+  void DispatchBatch(PacketDispatcher &dispatcher, PacketBatch &&batch) {
+    if (inline_cb_ && !batch.packs.empty()) {
+      (*inline_cb_)(batch.conn_id, batch.packs);
+      batch.packs.clear();
+    }
+    if (batch.Empty())
+      return;
+    if (flow_) {
+      flow_->OnDispatch();
+      batch.tracker = flow_;
+    }
+    dispatcher.Dispatch(std::move(batch));
+  }
+
+  std::shared_ptr<FlowControl::ConnFlow> flow_;
+  std::shared_ptr<const ConnExecCb> inline_cb_;
+  std::shared_ptr<TrafficCapture> capture_;
+  bool read_throttled_ = false;
+  ConnStats stats_;
+
+  ReadBudget read_budget_;
+  size_t budget_bytes_ = 0;
+  size_t budget_packets_ = 0;
+  bool budget_exhausted_ = false;
 };
 
+/// @brief 连接处理器工厂，为监听fd accept的连接创建自定义协议处理器
+/// @param conn_fd 已设置非阻塞的连接fd
+/// @param family 连接的地址族
+/// @return 为空时关闭该连接
+using HandlerFactory = std::function<std::unique_ptr<ProtocolHandler>(
+    int conn_fd, int family)>;
+
 /// @brief TCP协议处理器
 class TcpHandler : public ProtocolHandler {
 public:
   TcpHandler(int fd, std::unique_ptr<containers::UnPacker> unpacker)
       : fd_(fd), unpacker_(std::move(unpacker)), should_close_(false) {}
 
-  void SetCallback(ExecCb cb) { cb_ = std::move(cb); }
+  void SetCallback(ExecCb cb) {
+    cb_ = std::make_shared<const ExecCb>(std::move(cb));
+  }
+  /// @brief 设置共享的业务回调，多个连接复用同一份回调对象
+  /// @param cb
+  void SetCallback(std::shared_ptr<const ExecCb> cb) { cb_ = std::move(cb); }
+  /// @brief 设置携带连接ID的共享业务回调
+  /// @param cb
+  void SetConnCallback(std::shared_ptr<const ConnExecCb> cb) {
+    conn_cb_ = std::move(cb);
+  }
+  /// @brief 开启SCM_RIGHTS描述符接收(仅AF_UNIX流式连接)，读取改用recvmsg
+  /// @note 未开启时内核会丢弃对端发来的描述符
+  /// @param cb 收到的描述符随同一次读取解析出的数据包一起派发
+  void SetFdCallback(std::shared_ptr<const FdRecvCb> cb) {
+    fd_cb_ = std::move(cb);
+  }
   bool ShouldClose() const override { return should_close_; }
+  bool HasPendingOutput() const override { return !output_.Empty(); }
+
+  /// @brief 设置接收缓冲区容量策略(各尺寸已由ReactorCore解析为具体值)
+  /// @param policy
+  void SetRecvBufferPolicy(const RecvBufferPolicy &policy) {
+    buffer_policy_ = policy;
+    // 回调模式下允许声明长度超过当前容量的包，收包过程中扩容
+    if (policy.max_size > unpacker_->Capacity())
+      unpacker_->SetMaxPacketSize(policy.max_size);
+    stats_.recv_buffer_bytes.Set(unpacker_->Capacity());
+  }
+
+  bool ShrinkRecvBuffer() override {
+    size_t min_size = buffer_policy_.min_size;
+    if (min_size == 0 || unpacker_->Capacity() <= min_size ||
+        unpacker_->Length() > min_size)
+      return false;
+    unpacker_->Resize(min_size);
+    stats_.buffer_resizes.Add();
+    stats_.recv_buffer_bytes.Set(unpacker_->Capacity());
+    return true;
+  }
+
+  ~TcpHandler() override {
+    for (int fd : received_fds_)
+      close(fd);
+  }
+
+  /// @brief 开启MSG_ZEROCOPY发送大块内存
+  /// @note 回环等会回退为拷贝的设备上，首次收到回退通知后自动停用
+  /// @param threshold 不小于该长度的缓冲使用零拷贝，过小时页锁定开销大于拷贝
+  /// @return 内核是否支持
+  bool EnableZeroCopy(size_t threshold = 64 * 1024) {
+    return output_.EnableZeroCopy(fd_, threshold);
+  }
 
-  void HandleEvent(
-      int epoll_fd, const Event &event,
-      std::shared_ptr<threading::TimerScheduler> timer_shceduler) override {
+  bool Send(OutputChunk &&chunk) override {
+    if (should_close_)
+      return false;
+    output_.Push(std::move(chunk));
+    FlushOutput();
+    return !should_close_;
+  }
 
-    timer_shceduler_ = std::move(timer_shceduler);
+  size_t ReapZeroCopy() override {
+    if (output_.ZeroCopyInflight() != 0)
+      output_.ReapCompletions(fd_);
+    return output_.ZeroCopyInflight();
+  }
 
+  void HandleEvent(int epoll_fd, const Event &event,
+                   PacketDispatcher &dispatcher) override {
     if (event.fd != fd_)
       return;
 
-    // 处理错误事件
+    // 处理错误事件，零拷贝完成通知同样以错误事件送达
     if (event.event_flags & EventFlags::kError) {
-      LOGP_MSG("Connection error on fd:%d", fd_);
-      should_close_ = true;
-      return;
+      if (!output_.ZeroCopyEnabled() || SocketError() != 0) {
+        LOGP_MSG("Connection error on fd:%d", fd_);
+        should_close_ = true;
+        return;
+      }
+      output_.ReapCompletions(fd_);
     }
 
     // 处理连接挂起
@@ -60,43 +267,155 @@ public:
 
     // 处理可读事件（边缘触发模式）
     if (event.event_flags & EventFlags::kReadable) {
-      ProcessReadableEvent();
+      ProcessReadableEvent(event.conn_id, dispatcher);
+    }
+
+    // 发送缓冲区腾出空间，继续写出
+    if (event.event_flags & EventFlags::kWritable) {
+      FlushOutput();
     }
   }
 
 private:
   const int fd_;
   bool should_close_;
-  ExecCb cb_;
+  std::shared_ptr<const ExecCb> cb_;
+  std::shared_ptr<const ConnExecCb> conn_cb_;
+  std::shared_ptr<const FdRecvCb> fd_cb_;
   std::unique_ptr<containers::UnPacker> unpacker_;
-  std::vector<std::vector<uint8_t>> packs_;
-  std::shared_ptr<threading::TimerScheduler> timer_shceduler_;
+  OutputQueue output_;
+  std::vector<int> received_fds_; // 尚未派发的描述符
+  RecvBufferPolicy buffer_policy_;
+  size_t full_reads_ = 0; // 本次可读事件中读满可写空间的次数
+
+  /// @brief 扩容接收缓冲区，至少翻倍且不小于needed，不超过上限
+  /// @return 是否扩容
+  bool GrowRecvBuffer(size_t needed) {
+    size_t capacity = unpacker_->Capacity();
+    if (capacity >= buffer_policy_.max_size)
+      return false;
+    size_t target = std::max<size_t>(capacity * 2, 1);
+    while (target < needed)
+      target *= 2;
+    unpacker_->Resize(std::min(target, buffer_policy_.max_size));
+    stats_.buffer_resizes.Add();
+    stats_.recv_buffer_bytes.Set(unpacker_->Capacity());
+    return true;
+  }
+
+  /// @brief 按本次读取量与待收包长调整接收缓冲区
+  /// @param read_bytes 本次读取字节数
+  /// @param read_space 本次提供的可写空间
+  void AdaptRecvBuffer(size_t read_bytes, size_t read_space) {
+    size_t pending = unpacker_->PendingPacketSize();
+    if (pending > unpacker_->Capacity()) {
+      GrowRecvBuffer(pending);
+      return;
+    }
+    // 一次读不完已是常态：连续读满时扩容以减少系统调用
+    if (read_bytes == read_space && ++full_reads_ >= 2) {
+      full_reads_ = 0;
+      GrowRecvBuffer(0);
+    }
+  }
+
+  /// @brief recvmsg读取数据并收集SCM_RIGHTS描述符
+  ssize_t RecvWithFds(uint8_t *buffer, size_t capacity) {
+    iovec iov{buffer, capacity};
+    alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(int) * kMaxPassFds)];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    ssize_t n = recvmsg(fd_, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (n < 0)
+      return n;
+    if (msg.msg_flags & MSG_CTRUNC)
+      LOGP_WARN("fd passing truncated on fd:%d", fd_);
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+         cm = CMSG_NXTHDR(&msg, cm)) {
+      if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS)
+        continue;
+      size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      const uint8_t *data = CMSG_DATA(cm);
+      for (size_t i = 0; i < count; ++i) {
+        int fd;
+        memcpy(&fd, data + i * sizeof(int), sizeof(int));
+        received_fds_.push_back(fd);
+      }
+    }
+    return n;
+  }
 
-  void ProcessReadableEvent() {
+  void FlushOutput() {
+    size_t before = output_.PendingBytes();
+    OutputQueue::FlushResult result = output_.Flush(fd_);
+    stats_.bytes_written.Add(before - output_.PendingBytes());
+    if (result == OutputQueue::FlushResult::kError) {
+      if (errno != EPIPE && errno != ECONNRESET)
+        perror("send");
+      should_close_ = true;
+    }
+  }
+
+  int SocketError() const {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &len) == -1)
+      return errno;
+    return err;
+  }
+
+  void ProcessReadableEvent(ConnId conn_id, PacketDispatcher &dispatcher) {
+    BeginReadBudget();
+    full_reads_ = 0;
     while (true) {
+      // 下游饱和时停止读取，由ReactorCore暂停EPOLLIN
+      if (ReadThrottled())
+        break;
+      // 预算用尽时让出循环，由ReactorCore稍后轮转补读
+      if (ReadBudgetSpent())
+        break;
+
       auto [buffer, capacity] = unpacker_->GetLinearWriteSpace();
       if (capacity == 0) {
+        // 缓冲区中是未收全的包，扩容后继续读取
+        if (GrowRecvBuffer(0))
+          continue;
         LOGP_MSG("Buffer full on fd:%d,wirte space:%d,read space:%d", fd_,
                  unpacker_->AvailableToWrite(), unpacker_->AvailableToRead());
+        stats_.unpack_failures.Add();
         break;
       }
 
-      ssize_t n = read(fd_, buffer, capacity);
+      ssize_t n =
+          fd_cb_ ? RecvWithFds(buffer, capacity) : read(fd_, buffer, capacity);
+      stats_.read_calls.Add();
 
       if (n > 0) {
+        Capture(conn_id, CaptureKind::kStream, buffer, n);
         // 提交写入数据
         unpacker_->CommitWriteSize(n);
+        stats_.bytes_read.Add(n);
 
-        // 解析数据包
-        unpacker_->Get(packs_);
+        // 解析数据包，批次连同所有权一起交给工作线程
+        PacketBatch batch;
+        uint64_t invalid = unpacker_->InvalidCount();
+        unpacker_->Get(batch.packs);
+        stats_.packets_read.Add(batch.packs.size());
+        stats_.unpack_failures.Add(unpacker_->InvalidCount() - invalid);
+        ChargeReadBudget(n, batch.packs.size());
+        AdaptRecvBuffer(n, capacity);
 
-        if (!packs_.empty() && cb_) {
-          auto timer_task = [this]() {
-            cb_(packs_);
-            return 0;
-          };
-          timer_shceduler_->ScheduleOnce(0, timer_task);
+        batch.conn_id = conn_id;
+        batch.cb = cb_;
+        batch.conn_cb = conn_cb_;
+        if (!received_fds_.empty()) {
+          batch.fd_cb = fd_cb_;
+          batch.fds.swap(received_fds_);
         }
+        DispatchBatch(dispatcher, std::move(batch));
       } else if (n == 0) { // 对端关闭连接
         should_close_ = true;
         break;
@@ -111,63 +430,328 @@ private:
   }
 };
 
+/// @brief UDP协议处理器
+/// @note 使用recvmmsg批量接收，每个数据报独立成槽，保留对端地址与边界；
+/// 可选开启UDP_GRO，将内核合并的报文按段长拆回原始数据报
 class UdpHandler : public ProtocolHandler {
 public:
+  static constexpr size_t kDefaultBatchSize = 32;
+  static constexpr size_t kDefaultSlotSize = 2048;
+  static constexpr size_t kGroSlotSize = 65535;
+
+  /// @brief 构造
+  /// @param fd
+  /// @param unpacker 可为空，为空时每个数据报作为一个完整包
   UdpHandler(int fd, std::unique_ptr<containers::UnPacker> unpacker)
-      : fd_(fd), unpacker_(std::move(unpacker)), should_close_(false) {}
+      : fd_(fd), should_close_(false), unpacker_(std::move(unpacker)) {
+    SetBatchOptions(kDefaultBatchSize, kDefaultSlotSize, false);
+  }
+
+  /// @brief 设置批量接收参数
+  /// @param batch_size 单次recvmmsg的最大数据报数
+  /// @param slot_size 单个数据报槽位大小，开启GRO时至少为64KB
+  /// @param enable_gro 是否开启UDP_GRO
+  /// @return GRO是否开启成功(未请求时返回true)
+  bool SetBatchOptions(size_t batch_size, size_t slot_size, bool enable_gro) {
+    bool ok = true;
+    gro_enabled_ = false;
+    if (enable_gro) {
+      int on = 1;
+      gro_enabled_ =
+          setsockopt(fd_, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+      ok = gro_enabled_;
+      if (gro_enabled_)
+        slot_size = std::max(slot_size, kGroSlotSize);
+    }
 
-  void HandleEvent(
-      int epoll_fd, const Event &event,
-      std::shared_ptr<threading::TimerScheduler> timer_shceduler) override {
-    timer_shceduler_ = std::move(timer_shceduler);
+    batch_size_ = batch_size == 0 ? 1 : batch_size;
+    slot_size_ = slot_size;
+    recv_buffer_.assign(batch_size_ * slot_size_, 0);
+    iovs_.assign(batch_size_, iovec{});
+    addrs_.assign(batch_size_, sockaddr_storage{});
+    msgs_.assign(batch_size_, mmsghdr{});
+    ResizeCtrls();
+    return ok;
+  }
+
+  /// @brief 开启SCM_RIGHTS描述符接收(仅AF_UNIX数据报套接字)
+  /// @note 描述符放入所属数据报的Datagram::fds，未设置数据报回调时直接关闭
+  /// @param max_fds 单个数据报可接收的最大描述符数，0为关闭
+  void SetFdPassing(size_t max_fds) {
+    max_fds_ = std::min(max_fds, kMaxPassFds);
+    ResizeCtrls();
+  }
 
+  void HandleEvent(int epoll_fd, const Event &event,
+                   PacketDispatcher &dispatcher) override {
     if (event.event_flags & EventFlags::kError) {
       should_close_ = true;
       return;
     }
     if (event.event_flags & EventFlags::kReadable) {
-      while (true) {
-        auto [buffer, capacity] = unpacker_->GetLinearWriteSpace();
-        if (capacity == 0) {
-          LOGP_MSG("Buffer full on fd:%d,wirte space:%d,read space:%d", fd_,
-                   unpacker_->AvailableToWrite(), unpacker_->AvailableToRead());
-          break;
-        }
-        ssize_t len = recvfrom(event.fd, buffer, capacity, 0, nullptr, 0);
-
-        if (len == -1) {
+      BeginReadBudget();
+      while (!ReadThrottled() && !ReadBudgetSpent()) {
+        PrepareSlots();
+        int n = recvmmsg(fd_, msgs_.data(), batch_size_,
+                         MSG_DONTWAIT | (max_fds_ ? MSG_CMSG_CLOEXEC : 0),
+                         nullptr);
+        stats_.read_calls.Add();
+        if (n < 0) {
           // 读取完毕
-          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
             break;
-          }
           // 发生错误
-          else {
-            LOGP_ERROR("udp error ECONNREFUSED on fd:%d,errno:%d", fd_, errno);
-            should_close_ = true;
-          }
+          LOGP_ERROR("udp error on fd:%d,errno:%d", fd_, errno);
+          should_close_ = true;
+          break;
+        }
+
+        PacketBatch batch;
+        batch.conn_id = event.conn_id;
+        size_t bytes = 0;
+        for (int i = 0; i < n; ++i) {
+          bytes += msgs_[i].msg_len;
+          CollectSlot(i, batch);
         }
+        ChargeReadBudget(bytes, n);
 
-        unpacker_->CommitWriteSize(len);
-        unpacker_->Get(packs_);
+        if (udp_cb_)
+          batch.udp_cb = udp_cb_;
+        if (cb_)
+          batch.cb = cb_;
+        DispatchBatch(dispatcher, std::move(batch));
 
-        auto timer_task = [this]() {
-          cb_(packs_);
-          return 0;
-        };
-        timer_shceduler_->ScheduleOnce(0, timer_task);
+        // 未填满说明内核队列已取空
+        if (static_cast<size_t>(n) < batch_size_)
+          break;
       }
     }
   };
   bool ShouldClose() const override { return should_close_; }
-  void SetCallback(ExecCb cb) { cb_ = std::move(cb); }
+
+  /// @brief 设置按包回调，数据报经解包器(若有)拆包后投递，包不跨数据报
+  /// @param cb
+  void SetCallback(ExecCb cb) {
+    cb_ = std::make_shared<const ExecCb>(std::move(cb));
+  }
+
+  /// @brief 设置数据报回调，投递原始数据报及对端地址
+  /// @param cb
+  void SetDatagramCallback(UdpExecCb cb) {
+    udp_cb_ = std::make_shared<const UdpExecCb>(std::move(cb));
+  }
+
+  /// @brief 使用sendmmsg批量发送，线程安全(仅使用栈上结构)
+  /// @note Datagram::fds非空时以SCM_RIGHTS附带(仅AF_UNIX)，调用方保留其所有权
+  /// @param fd
+  /// @param datagrams 每个数据报发往各自的peer
+  /// @return 成功发送的数据报个数，出错返回-1
+  static int SendBatch(int fd, const std::vector<Datagram> &datagrams) {
+    static constexpr size_t kMaxBatch = 64;
+    mmsghdr msgs[kMaxBatch];
+    iovec iovs[kMaxBatch];
+    std::vector<uint8_t> ctrl;
+    size_t sent = 0;
+    while (sent < datagrams.size()) {
+      size_t count = std::min(kMaxBatch, datagrams.size() - sent);
+      size_t ctrl_size = 0;
+      for (size_t i = 0; i < count; ++i) {
+        const Datagram &dg = datagrams[sent + i];
+        if (!dg.fds.empty())
+          ctrl_size += CMSG_SPACE(sizeof(int) * dg.fds.size());
+      }
+      ctrl.assign(ctrl_size, 0);
+      size_t ctrl_off = 0;
+      for (size_t i = 0; i < count; ++i) {
+        const Datagram &dg = datagrams[sent + i];
+        iovs[i].iov_base = const_cast<uint8_t *>(dg.payload.data());
+        iovs[i].iov_len = dg.payload.size();
+        msgs[i] = mmsghdr{};
+        msgs[i].msg_hdr.msg_name =
+            const_cast<sockaddr_storage *>(&dg.peer);
+        msgs[i].msg_hdr.msg_namelen = dg.peer_len;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (!dg.fds.empty()) {
+          size_t fd_bytes = sizeof(int) * dg.fds.size();
+          msghdr &hdr = msgs[i].msg_hdr;
+          hdr.msg_control = ctrl.data() + ctrl_off;
+          hdr.msg_controllen = CMSG_SPACE(fd_bytes);
+          cmsghdr *cm = CMSG_FIRSTHDR(&hdr);
+          cm->cmsg_level = SOL_SOCKET;
+          cm->cmsg_type = SCM_RIGHTS;
+          cm->cmsg_len = CMSG_LEN(fd_bytes);
+          memcpy(CMSG_DATA(cm), dg.fds.data(), fd_bytes);
+          ctrl_off += CMSG_SPACE(fd_bytes);
+        }
+      }
+      int n = sendmmsg(fd, msgs, count, MSG_DONTWAIT);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return sent > 0 ? static_cast<int>(sent) : -1;
+      }
+      sent += n;
+      if (static_cast<size_t>(n) < count)
+        break; // 发送缓冲区满
+    }
+    return static_cast<int>(sent);
+  }
+
+  /// @brief 使用UDP_SEGMENT(GSO)发送，内核按segment_size切分为多个数据报
+  /// @note 一次系统调用发送多个等长数据报(末段可更短)，线程安全
+  /// @param fd
+  /// @param peer
+  /// @param peer_len
+  /// @param data
+  /// @param len
+  /// @param segment_size
+  /// @return 发送字节数，出错返回-1
+  static ssize_t SendSegmented(int fd, const sockaddr *peer,
+                               socklen_t peer_len, const uint8_t *data,
+                               size_t len, uint16_t segment_size) {
+    iovec iov{const_cast<uint8_t *>(data), len};
+    msghdr msg{};
+    msg.msg_name = const_cast<sockaddr *>(peer);
+    msg.msg_namelen = peer_len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(uint16_t))] = {};
+    if (segment_size > 0 && len > segment_size) {
+      msg.msg_control = ctrl;
+      msg.msg_controllen = sizeof(ctrl);
+      cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+      cm->cmsg_level = SOL_UDP;
+      cm->cmsg_type = UDP_SEGMENT;
+      cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      memcpy(CMSG_DATA(cm), &segment_size, sizeof(segment_size));
+    }
+    return sendmsg(fd, &msg, MSG_DONTWAIT);
+  }
 
 private:
+  /// @brief 按GRO与描述符接收需要分配控制消息缓冲
+  void ResizeCtrls() {
+    ctrl_size_ = CMSG_SPACE(sizeof(int));
+    if (max_fds_)
+      ctrl_size_ += CMSG_SPACE(sizeof(int) * max_fds_);
+    ctrls_.assign(batch_size_ * ctrl_size_, 0);
+  }
+
+  /// @brief 每次接收前重置槽位(内核会改写长度字段)
+  void PrepareSlots() {
+    for (size_t i = 0; i < batch_size_; ++i) {
+      iovs_[i].iov_base = recv_buffer_.data() + i * slot_size_;
+      iovs_[i].iov_len = slot_size_;
+      msghdr &hdr = msgs_[i].msg_hdr;
+      hdr.msg_name = &addrs_[i];
+      hdr.msg_namelen = sizeof(sockaddr_storage);
+      hdr.msg_iov = &iovs_[i];
+      hdr.msg_iovlen = 1;
+      bool use_ctrl = gro_enabled_ || max_fds_;
+      hdr.msg_control = use_ctrl ? ctrls_.data() + i * ctrl_size_ : nullptr;
+      hdr.msg_controllen = use_ctrl ? ctrl_size_ : 0;
+      hdr.msg_flags = 0;
+      msgs_[i].msg_len = 0;
+    }
+  }
+
+  /// @brief 将第i个槽位的数据转换为数据报或包
+  void CollectSlot(int i, PacketBatch &batch) {
+    const msghdr &hdr = msgs_[i].msg_hdr;
+    const uint8_t *data = recv_buffer_.data() + i * slot_size_;
+    size_t len = msgs_[i].msg_len;
+    stats_.bytes_read.Add(len);
+    if (hdr.msg_flags & MSG_TRUNC)
+      LOGP_WARN("udp datagram truncated on fd:%d,slot size:%d", fd_,
+                slot_size_);
+
+    if (hdr.msg_flags & MSG_CTRUNC)
+      LOGP_WARN("udp control message truncated on fd:%d", fd_);
+
+    // GRO合并的报文按段长拆分，AF_UNIX数据报可能携带描述符
+    size_t segment = len;
+    std::vector<int> fds;
+    if (gro_enabled_ || max_fds_) {
+      for (cmsghdr *cm = CMSG_FIRSTHDR(const_cast<msghdr *>(&hdr));
+           cm != nullptr; cm = CMSG_NXTHDR(const_cast<msghdr *>(&hdr), cm)) {
+        if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+          int gso_size = 0;
+          memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+          if (gso_size > 0)
+            segment = static_cast<size_t>(gso_size);
+        } else if (cm->cmsg_level == SOL_SOCKET &&
+                   cm->cmsg_type == SCM_RIGHTS) {
+          size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+          size_t base = fds.size();
+          fds.resize(base + count);
+          memcpy(fds.data() + base, CMSG_DATA(cm), count * sizeof(int));
+        }
+      }
+    }
+
+    size_t first = batch.datagrams.size();
+    for (size_t off = 0; off < len || (len == 0 && off == 0);) {
+      size_t seg_len = std::min(segment, len - off);
+      Capture(batch.conn_id, CaptureKind::kDatagram, data + off, seg_len);
+      CollectDatagram(addrs_[i], hdr.msg_namelen, data + off, seg_len, batch);
+      if (seg_len == 0)
+        break;
+      off += seg_len;
+    }
+
+    if (fds.empty())
+      return;
+    if (first < batch.datagrams.size()) {
+      batch.datagrams[first].fds = std::move(fds);
+      return;
+    }
+    for (int fd : fds)
+      close(fd); // 无数据报回调，无人接管
+  }
+
+  void CollectDatagram(const sockaddr_storage &peer, socklen_t peer_len,
+                       const uint8_t *data, size_t len, PacketBatch &batch) {
+    stats_.packets_read.Add();
+    if (udp_cb_) {
+      Datagram dg;
+      dg.peer = peer;
+      dg.peer_len = peer_len;
+      dg.payload.assign(data, data + len);
+      batch.datagrams.push_back(std::move(dg));
+    }
+    if (!cb_ || len == 0)
+      return;
+    if (!unpacker_) {
+      batch.packs.emplace_back(data, data + len);
+      return;
+    }
+    // 每个数据报独立解包，残余字节不与下一个数据报拼接
+    std::vector<std::vector<uint8_t>> packs;
+    unpacker_->Clear();
+    unpacker_->PushAndGet(data, len, packs);
+    for (auto &pack : packs)
+      batch.packs.push_back(std::move(pack));
+  }
+
   const int fd_;
   bool should_close_;
-  ExecCb cb_;
+  std::shared_ptr<const ExecCb> cb_;
+  std::shared_ptr<const UdpExecCb> udp_cb_;
   std::unique_ptr<containers::UnPacker> unpacker_;
-  std::vector<std::vector<uint8_t>> packs_;
-  std::shared_ptr<threading::TimerScheduler> timer_shceduler_;
+
+  // recvmmsg批量接收槽位
+  size_t batch_size_ = kDefaultBatchSize;
+  size_t slot_size_ = kDefaultSlotSize;
+  bool gro_enabled_ = false;
+  size_t max_fds_ = 0;
+  size_t ctrl_size_ = 0;
+  std::vector<uint8_t> recv_buffer_;
+  std::vector<iovec> iovs_;
+  std::vector<sockaddr_storage> addrs_;
+  std::vector<uint8_t> ctrls_;
+  std::vector<mmsghdr> msgs_;
 };
 
 } // namespace net
\ No newline at end of file
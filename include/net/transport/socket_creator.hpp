@@ -2,8 +2,11 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <cstddef>
+#include <cstring>
 #include <string>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 namespace net {
@@ -77,5 +80,81 @@ public:
 
     return fd;
   }
+
+  /// @brief 填充AF_UNIX地址
+  /// @param path 以'@'开头为抽象命名空间(不落文件系统)，为空时绑定由内核自动命名
+  /// @param addr
+  /// @param len 输出地址长度，抽象地址不含结尾'\0'
+  /// @return 路径过长返回false
+  static bool MakeUnixAddress(const std::string &path, sockaddr_un &addr,
+                              socklen_t &len) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty()) {
+      len = sizeof(sa_family_t);
+      return true;
+    }
+    bool abstract = path[0] == '@';
+    if (path.size() + (abstract ? 0 : 1) > sizeof(addr.sun_path))
+      return false;
+    memcpy(addr.sun_path, path.data(), path.size());
+    if (abstract)
+      addr.sun_path[0] = '\0';
+    len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() +
+                                 (abstract ? 0 : 1));
+    return true;
+  }
+
+  /// @brief 创建AF_UNIX流式套接字，文件路径已存在时先删除残留
+  /// @param path 见MakeUnixAddress
+  /// @param non_block
+  /// @param listen_backlog
+  /// @return
+  static int CreateUnixStreamSocket(const std::string &path,
+                                    bool non_block = true,
+                                    int listen_backlog = 0) {
+    return CreateUnixSocket(SOCK_STREAM, path, non_block, listen_backlog);
+  }
+
+  /// @brief 创建AF_UNIX数据报套接字
+  /// @param path 见MakeUnixAddress，客户端传空以便对端回包
+  /// @param non_block
+  /// @return
+  static int CreateUnixDgramSocket(const std::string &path,
+                                   bool non_block = true) {
+    return CreateUnixSocket(SOCK_DGRAM, path, non_block, 0);
+  }
+
+private:
+  static int CreateUnixSocket(int type, const std::string &path,
+                              bool non_block, int listen_backlog) {
+    sockaddr_un addr;
+    socklen_t len;
+    if (!MakeUnixAddress(path, addr, len))
+      return -1;
+
+    int flags = type;
+    if (non_block)
+      flags |= SOCK_NONBLOCK;
+
+    int fd = socket(AF_UNIX, flags, 0);
+    if (fd == -1)
+      return -1;
+
+    if (!path.empty() && path[0] != '@')
+      unlink(path.c_str());
+
+    if (bind(fd, (sockaddr *)&addr, len) < 0) {
+      close(fd);
+      return -1;
+    }
+
+    if (listen_backlog > 0 && listen(fd, listen_backlog) < 0) {
+      close(fd);
+      return -1;
+    }
+
+    return fd;
+  }
 };
 } // namespace net
\ No newline at end of file
@@ -0,0 +1,309 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T> class TaskFuture;
+
+/// @brief 任务结果的共享状态，侵入式引用计数
+/// @note 完成时只加一次锁；阻塞等待方才使用条件变量，续体在完成线程上执行
+/// @tparam T 结果类型，可为void
+template <typename T> class FutureState {
+  using Storage = std::conditional_t<std::is_void<T>::value, bool, T>;
+
+  /// @brief 类型擦除的续体，支持只可移动的可调用对象
+  struct Continuation {
+    virtual void Run() = 0;
+    virtual ~Continuation() = default;
+  };
+
+  template <typename F> struct ContinuationImpl : Continuation {
+    explicit ContinuationImpl(F &&fn) : fn(std::move(fn)) {}
+    void Run() override { fn(); }
+    F fn;
+  };
+
+public:
+  FutureState() = default;
+  virtual ~FutureState() = default;
+
+  FutureState(const FutureState &) = delete;
+  FutureState &operator=(const FutureState &) = delete;
+
+  void AddRef() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Release() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  /// @brief 执行fn并以其返回值或抛出的异常完成
+  /// @param fn
+  template <typename Fn> void Complete(Fn &&fn) {
+    try {
+      if constexpr (std::is_void<T>::value) {
+        fn();
+        value_.emplace(true);
+      } else {
+        value_.emplace(fn());
+      }
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    Finish();
+  }
+
+  /// @brief 以异常完成
+  /// @param error
+  void Fail(std::exception_ptr error) {
+    error_ = std::move(error);
+    Finish();
+  }
+
+  bool Ready() const { return ready_.load(std::memory_order_acquire); }
+
+  void Wait() {
+    if (Ready())
+      return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return ready_.load(std::memory_order_relaxed); });
+  }
+
+  template <typename Rep, typename Period>
+  bool WaitFor(const std::chrono::duration<Rep, Period> &timeout) {
+    if (Ready())
+      return true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [this] {
+      return ready_.load(std::memory_order_relaxed);
+    });
+  }
+
+  /// @brief 取出结果，有异常时重新抛出
+  /// @note 需已完成，只能调用一次
+  T Take() {
+    if (error_)
+      std::rethrow_exception(error_);
+    if constexpr (std::is_void<T>::value)
+      return;
+    else
+      return std::move(*value_);
+  }
+
+  const std::exception_ptr &Error() const { return error_; }
+
+  /// @brief 注册续体，已完成时立即在调用线程执行，否则由完成线程执行
+  /// @note 每个状态只能注册一个续体
+  /// @param fn void()
+  template <typename F> void OnReady(F &&fn) {
+    std::unique_ptr<Continuation> continuation(
+        new ContinuationImpl<std::decay_t<F>>(std::forward<F>(fn)));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!ready_.load(std::memory_order_relaxed)) {
+        continuation_ = std::move(continuation);
+        return;
+      }
+    }
+    continuation->Run();
+  }
+
+private:
+  void Finish() {
+    std::unique_ptr<Continuation> continuation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.store(true, std::memory_order_release);
+      continuation = std::move(continuation_);
+    }
+    cv_.notify_all();
+    if (continuation)
+      continuation->Run();
+  }
+
+  std::atomic<uint32_t> refs_{1};
+  std::atomic<bool> ready_{false};
+  std::optional<Storage> value_;
+  std::exception_ptr error_;
+  std::unique_ptr<Continuation> continuation_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+/// @brief 续体的返回类型：T为void时续体无参数，否则以T为参数
+template <typename F, typename T, typename = void> struct ContinuationResult {
+  using type = std::invoke_result_t<std::decay_t<F>, T>;
+};
+
+template <typename F, typename T>
+struct ContinuationResult<F, T, std::enable_if_t<std::is_void<T>::value>> {
+  using type = std::invoke_result_t<std::decay_t<F>>;
+};
+
+/// @brief 轻量的任务结果句柄，只可移动
+/// @note 结果经Get取出(异常在此重新抛出)，或经Then/WhenAll交给续体，
+/// 避免每个任务一次阻塞等待。不要在同一线程池的工作线程上阻塞Get，
+/// 应使用Then
+/// @tparam T 结果类型，可为void
+template <typename T> class TaskFuture {
+public:
+  TaskFuture() = default;
+
+  /// @brief 接管state的一个引用
+  explicit TaskFuture(FutureState<T> *state) : state_(state) {}
+
+  TaskFuture(TaskFuture &&other) noexcept
+      : state_(std::exchange(other.state_, nullptr)) {}
+
+  TaskFuture &operator=(TaskFuture &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+  }
+
+  TaskFuture(const TaskFuture &) = delete;
+  TaskFuture &operator=(const TaskFuture &) = delete;
+
+  ~TaskFuture() { Reset(); }
+
+  /// @brief 是否持有结果(Get或Then之后失效)
+  bool Valid() const { return state_ != nullptr; }
+
+  /// @brief 结果是否已就绪
+  bool Ready() const { return state_ && state_->Ready(); }
+
+  /// @brief 阻塞等待结果就绪
+  void Wait() const { state_->Wait(); }
+
+  /// @brief 限时等待
+  /// @param timeout
+  /// @return 超时返回false
+  template <typename Rep, typename Period>
+  bool WaitFor(const std::chrono::duration<Rep, Period> &timeout) const {
+    return state_->WaitFor(timeout);
+  }
+
+  /// @brief 阻塞取出结果，任务抛出的异常在此重新抛出
+  /// @return
+  T Get() {
+    FutureState<T> *state = std::exchange(state_, nullptr);
+    state->Wait();
+    struct Releaser {
+      FutureState<T> *state;
+      ~Releaser() { state->Release(); }
+    } releaser{state};
+    return state->Take();
+  }
+
+  /// @brief 结果就绪后以其调用fn，返回fn结果的句柄
+  /// @note fn在完成本任务的线程上执行(已就绪时在调用线程执行)，
+  /// 本任务异常时跳过fn并把异常传给返回的句柄。调用后本句柄失效
+  /// @param fn U(T) 或 T为void时 U()
+  /// @return
+  template <typename F>
+  TaskFuture<typename ContinuationResult<F, T>::type> Then(F &&fn) {
+    using U = typename ContinuationResult<F, T>::type;
+    FutureState<T> *prev = std::exchange(state_, nullptr);
+    auto *next = new FutureState<U>();
+    next->AddRef(); // 续体持有
+    prev->OnReady([prev, next, fn = std::forward<F>(fn)]() mutable {
+      if (prev->Error()) {
+        next->Fail(prev->Error());
+      } else if constexpr (std::is_void<T>::value) {
+        next->Complete([&] { return fn(); });
+      } else {
+        next->Complete([&] { return fn(prev->Take()); });
+      }
+      prev->Release();
+      next->Release();
+    });
+    return TaskFuture<U>(next);
+  }
+
+private:
+  template <typename U> friend class TaskFuture;
+  template <typename U> friend auto WhenAll(std::vector<TaskFuture<U>> futures);
+
+  void Reset() {
+    if (state_)
+      std::exchange(state_, nullptr)->Release();
+  }
+
+  FutureState<T> *state_ = nullptr;
+};
+
+/// @brief 全部任务完成后就绪，按输入顺序汇总结果
+/// @note 不阻塞任何线程；任一任务异常时在全部完成后传出首个异常
+/// @param futures 调用后全部失效
+/// @return T为void时为TaskFuture<void>，否则为TaskFuture<std::vector<T>>
+template <typename T> auto WhenAll(std::vector<TaskFuture<T>> futures) {
+  using R = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+  using Slot = std::conditional_t<std::is_void<T>::value, bool, T>;
+
+  struct Join {
+    std::atomic<size_t> remaining;
+    std::vector<std::optional<Slot>> values;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    FutureState<R> *result;
+
+    void Finish() {
+      if (failed.load(std::memory_order_acquire)) {
+        result->Fail(error);
+      } else if constexpr (std::is_void<T>::value) {
+        result->Complete([] {});
+      } else {
+        result->Complete([this] {
+          std::vector<T> out;
+          out.reserve(values.size());
+          for (auto &value : values)
+            out.push_back(std::move(*value));
+          return out;
+        });
+      }
+      result->Release();
+    }
+  };
+
+  auto *result = new FutureState<R>();
+  if (futures.empty()) {
+    if constexpr (std::is_void<T>::value)
+      result->Complete([] {});
+    else
+      result->Complete([] { return std::vector<T>(); });
+    return TaskFuture<R>(result);
+  }
+
+  result->AddRef(); // 汇总对象持有
+  auto join = std::make_shared<Join>();
+  join->remaining.store(futures.size(), std::memory_order_relaxed);
+  join->values.resize(futures.size());
+  join->result = result;
+  for (size_t i = 0; i < futures.size(); ++i) {
+    FutureState<T> *state = std::exchange(futures[i].state_, nullptr);
+    state->OnReady([state, join, i] {
+      if (state->Error()) {
+        if (!join->failed.exchange(true, std::memory_order_acq_rel))
+          join->error = state->Error();
+      } else if constexpr (std::is_void<T>::value) {
+        join->values[i].emplace(true);
+      } else {
+        join->values[i].emplace(state->Take());
+      }
+      state->Release();
+      if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        join->Finish();
+    });
+  }
+  return TaskFuture<R>(result);
+}
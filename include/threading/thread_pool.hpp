@@ -1,85 +1,329 @@
 #pragma once
+#include "../containers/mpmc_queue.hpp"
+#include "../containers/work_steal_deque.hpp"
+#include "task_future.hpp"
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 using CallBack = std::function<size_t(void)>;
 
+/// @brief 工作窃取线程池
+/// @note 每个工作线程持有一个Chase-Lev双端队列：工作线程内提交的任务进入
+/// 自身队列底部并优先执行，外部线程提交的任务进入全局注入队列，空闲线程
+/// 依次尝试自身队列、注入队列、随机选取的其他线程队列顶部。只有存在休眠
+/// 线程时提交方才加锁唤醒，任务之间不保证先后顺序
 class ThreadPool {
+  static constexpr size_t kCacheLine = 64;
+
+  /// @brief 本地队列中的任务节点，Run执行后自行释放
+  /// @note 双端队列只能存放指针；Submit的任务本身即节点，不再额外分配
+  class TaskNode {
+  public:
+    virtual void Run() = 0;
+
+  protected:
+    ~TaskNode() = default;
+  };
+
+  /// @brief 工作线程内PostTask的回调节点
+  class CallBackNode final : public TaskNode {
+  public:
+    explicit CallBackNode(CallBack &&cb) : cb_(std::move(cb)) {}
+    void Run() override {
+      std::unique_ptr<CallBackNode> owned(this);
+      cb_();
+    }
+
+  private:
+    CallBack cb_;
+  };
+
+  struct alignas(kCacheLine) Worker {
+    containers::WorkStealDeque<TaskNode *> deque;
+    uint64_t rng = 0;                 // 选取窃取目标，仅所有者线程使用
+    std::atomic<uint64_t> steals{0};  // 成功窃取次数，仅所有者线程写入
+    std::thread thread;
+  };
+
 public:
   /// @brief 指定线程数构造线程
   /// @param thread_count
   explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency())
-      : running_(true) {
+      : injector_(kInjectorCapacity), running_(true) {
+    if (thread_count == 0)
+      thread_count = 1;
     for (size_t i = 0; i < thread_count; ++i) {
-      workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+      workers_.emplace_back(std::make_unique<Worker>());
+      workers_.back()->rng = 0x9e3779b97f4a7c15ULL * (i + 1);
     }
+    for (size_t i = 0; i < thread_count; ++i)
+      workers_[i]->thread = std::thread(&ThreadPool::WorkerLoop, this, i);
   }
 
   /// @brief 提交回调任务
+  /// @note 在本池工作线程内调用时进入该线程的本地队列
   /// @param cb_task
   void PostTask(CallBack cb_task) {
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      task_queue_.push(std::move(cb_task));
-    }
-    cv_.notify_one(); // 唤醒一个线程
+    Push(std::move(cb_task));
+    Notify(1);
   }
 
   /// @brief 批量提交回调任务，适用于高频小任务提交
+  /// @note 只唤醒与任务数相当的休眠线程
   /// @param cb_tasks
   void PostTask(std::vector<CallBack> &&cb_tasks) {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    for (const auto &cb_task : cb_tasks) {
-      task_queue_.push(std::move(cb_task));
-    }
-    cv_.notify_all(); // 唤醒所有线程
+    for (auto &cb_task : cb_tasks)
+      Push(std::move(cb_task));
+    Notify(cb_tasks.size());
+  }
+
+  /// @brief 提交任意可调用对象，返回其结果的句柄
+  /// @note 参数按值保存，可调用对象与参数可只可移动；任务抛出的异常经
+  /// TaskFuture::Get重新抛出或沿Then/WhenAll传递
+  /// @param fn
+  /// @param args
+  /// @return
+  template <typename F, typename... Args>
+  auto Submit(F &&fn, Args &&...args)
+      -> TaskFuture<std::invoke_result_t<std::decay_t<F>,
+                                         std::decay_t<Args>...>> {
+    using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+    using Task = SubmitTask<R, std::decay_t<F>,
+                            std::tuple<std::decay_t<Args>...>>;
+    auto *task = new Task(std::forward<F>(fn),
+                          std::make_tuple(std::forward<Args>(args)...));
+    task->AddRef(); // 线程池持有，另一个引用归返回的句柄
+    Push(static_cast<TaskNode *>(task));
+    Notify(1);
+    return TaskFuture<R>(task);
+  }
+
+  /// @brief 工作线程数
+  /// @return
+  size_t ThreadCount() const { return workers_.size(); }
+
+  /// @brief 累计窃取次数(近似)
+  /// @return
+  uint64_t StealCount() const {
+    uint64_t steals = 0;
+    for (const auto &worker : workers_)
+      steals += worker->steals.load(std::memory_order_relaxed);
+    return steals;
   }
 
   /// @brief 析构线程池
+  /// @note 等待已提交(包括执行中派生)的任务全部完成
   ~ThreadPool() {
     {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
       running_.store(false, std::memory_order_release);
+      wake_epoch_++;
     }
     cv_.notify_all();
     for (auto &worker : workers_) {
-      if (worker.joinable())
-        worker.join();
+      if (worker->thread.joinable())
+        worker->thread.join();
     }
   }
 
 private:
-  /// @brief 被动任务消费循环
-  /// @note 根据条件变量决定是否从任务队列中取出任务并执行
-  void WorkerLoop() {
+  static constexpr size_t kInjectorCapacity = 4096;
+  static constexpr int kSpinRounds = 64;
+
+  /// @brief 当前线程所属的池与工作线程下标
+  struct WorkerContext {
+    const ThreadPool *pool = nullptr;
+    size_t index = 0;
+  };
+
+  static WorkerContext &Context() {
+    thread_local WorkerContext context;
+    return context;
+  }
+
+  /// @brief 工作线程内提交进入本地队列(需分配节点)，外部提交的回调直接
+  /// 移入注入队列槽位
+  void Push(CallBack &&task) {
+    const WorkerContext &context = Context();
+    if (context.pool == this) {
+      workers_[context.index]->deque.Push(new CallBackNode(std::move(task)));
+      return;
+    }
+    Inject(std::move(task));
+  }
+
+  void Push(TaskNode *node) {
+    const WorkerContext &context = Context();
+    if (context.pool == this) {
+      workers_[context.index]->deque.Push(node);
+      return;
+    }
+    // 只捕获裸指针，CallBack无需额外分配
+    Inject([node]() -> size_t {
+      node->Run();
+      return 0;
+    });
+  }
+
+  void Inject(CallBack &&task) {
+    if (injector_.TryPush(std::move(task)))
+      return;
+    // 注入队列满时退化到加锁的溢出队列
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    overflow_.push_back(std::move(task));
+    overflow_size_.fetch_add(1, std::memory_order_release);
+  }
+
+  bool TakeInjected(CallBack &task) {
+    if (injector_.TryPop(task))
+      return true;
+    if (overflow_size_.load(std::memory_order_acquire) == 0)
+      return false;
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    if (overflow_.empty())
+      return false;
+    task = std::move(overflow_.front());
+    overflow_.pop_front();
+    overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool Steal(size_t index, TaskNode *&task) {
+    Worker &self = *workers_[index];
+    size_t count = workers_.size();
+    if (count < 2)
+      return false;
+    self.rng ^= self.rng << 13;
+    self.rng ^= self.rng >> 7;
+    self.rng ^= self.rng << 17;
+    size_t start = static_cast<size_t>(self.rng % count);
+    for (size_t i = 0; i < count; ++i) {
+      size_t victim = (start + i) % count;
+      if (victim != index && workers_[victim]->deque.Steal(task)) {
+        self.steals.store(self.steals.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief 依次从本地队列、注入队列、其他线程队列取一个任务执行
+  bool RunOne(size_t index, CallBack &injected) {
+    TaskNode *node = nullptr;
+    if (workers_[index]->deque.Pop(node)) {
+      node->Run();
+      return true;
+    }
+    if (TakeInjected(injected)) {
+      injected();
+      injected = nullptr; // 及时释放捕获的状态
+      return true;
+    }
+    if (Steal(index, node)) {
+      node->Run();
+      return true;
+    }
+    return false;
+  }
+
+  bool HasPending() const {
+    if (!injector_.IsEmpty() ||
+        overflow_size_.load(std::memory_order_acquire) > 0)
+      return true;
+    for (const auto &worker : workers_) {
+      if (!worker->deque.IsEmpty())
+        return true;
+    }
+    return false;
+  }
+
+  /// @brief 唤醒至多count个休眠线程
+  void Notify(size_t count) {
+    // 与WorkerLoop中的sleepers_/队列检查构成Dekker式配对，防止丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (count == 0 || sleepers_.load(std::memory_order_relaxed) == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      wake_epoch_++;
+    }
+    if (count >= workers_.size()) {
+      cv_.notify_all();
+      return;
+    }
+    for (size_t i = 0; i < count; ++i)
+      cv_.notify_one();
+  }
+
+  /// @brief Submit的任务与结果共用一次分配，执行后立即释放可调用对象与参数
+  template <typename R, typename Fn, typename Tuple>
+  class SubmitTask final : public FutureState<R>, public TaskNode {
+  public:
+    /// @note 左值可调用对象按拷贝保存，右值按移动保存
+    template <typename G>
+    SubmitTask(G &&fn, Tuple &&args)
+        : fn_(std::in_place, std::forward<G>(fn)), args_(std::move(args)) {}
+
+    /// @brief 执行并释放线程池持有的引用
+    void Run() override {
+      this->Complete(
+          [this] { return std::apply(std::move(*fn_), std::move(*args_)); });
+      fn_.reset();
+      args_.reset();
+      this->Release();
+    }
+
+  private:
+    std::optional<Fn> fn_;
+    std::optional<Tuple> args_;
+  };
+
+  /// @brief 工作线程主循环：本地队列、注入队列、窃取，均无任务时先自旋后休眠
+  void WorkerLoop(size_t index) {
+    Context() = WorkerContext{this, index};
+    CallBack injected;
     while (true) {
-      CallBack cb_task;
-      {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        cv_.wait(lock, [this] {
-          return !running_.load(std::memory_order_acquire) ||
-                 !task_queue_.empty();
-        });
-
-        if (!running_ && task_queue_.empty())
-          return;
+      bool found = false;
+      for (int i = 0; i < kSpinRounds && !found; ++i) {
+        found = RunOne(index, injected);
+        if (!found && i > 0)
+          std::this_thread::yield();
+      }
+      if (found)
+        continue;
 
-        cb_task = std::move(task_queue_.front());
-        task_queue_.pop();
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      uint64_t epoch = wake_epoch_;
+      sleepers_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!HasPending()) {
+        if (!running_.load(std::memory_order_acquire)) {
+          sleepers_.fetch_sub(1, std::memory_order_relaxed);
+          return;
+        }
+        cv_.wait(lock, [&] { return wake_epoch_ != epoch; });
       }
-      cb_task();
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
     }
   }
 
-  std::vector<std::thread> workers_;
-  std::queue<CallBack> task_queue_; // 任务队列（FIFO）
+  std::vector<std::unique_ptr<Worker>> workers_;
+  containers::MpmcQueue<CallBack> injector_; // 外部提交的全局注入队列
+  std::mutex overflow_mutex_;
+  std::deque<CallBack> overflow_;
+  std::atomic<size_t> overflow_size_{0};
 
-  std::mutex queue_mutex_;
+  std::mutex sleep_mutex_;
   std::condition_variable cv_;
+  uint64_t wake_epoch_ = 0; // 受sleep_mutex_保护
+  std::atomic<size_t> sleepers_{0};
   std::atomic<bool> running_;
-};
\ No newline at end of file
+};
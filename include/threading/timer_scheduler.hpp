@@ -1,7 +1,8 @@
 #pragma once
 #include "thread_pool.hpp"
+#include <queue>
 #include <unordered_set>
-#include "../logkit/logkit.hpp"
+#include "../logger/logger.hpp"
 
 namespace threading {
 struct TimerTask {
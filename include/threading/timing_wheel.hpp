@@ -0,0 +1,341 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace threading {
+
+/// @brief 时间轮定时回调类型
+using TimerCb = std::function<void(void)>;
+
+/// @brief 定时器ID:高32位为代数，低32位为槽位下标，用于识别过期ID
+using TimerId = uint64_t;
+
+/// @brief 分层时间轮
+/// @note 单线程使用(由事件循环独占)，无锁；插入/取消O(1)，推进按tick摊还O(1)
+/// 层级划分与内核定时器一致：第0层256槽，第1~3层各64槽
+class TimingWheel {
+  static constexpr uint32_t kNil = UINT32_MAX;
+  static constexpr uint32_t kLevel0Bits = 8;
+  static constexpr uint32_t kLevelNBits = 6;
+  static constexpr uint32_t kLevel0Size = 1u << kLevel0Bits;
+  static constexpr uint32_t kLevelNSize = 1u << kLevelNBits;
+  static constexpr uint32_t kLevels = 4;
+  // 可直接表示的最大tick跨度，超出部分在级联时重新定位
+  static constexpr uint64_t kMaxSpan =
+      1ull << (kLevel0Bits + kLevelNBits * (kLevels - 1));
+
+  struct Node {
+    TimerCb cb;
+    uint64_t expire = 0;   // 到期tick
+    uint64_t interval = 0; // 周期tick，0为单次
+    uint32_t prev = kNil;
+    uint32_t next = kNil;
+    uint32_t gen = 0;
+    uint16_t level = 0;
+    uint16_t slot = 0;
+    bool linked = false;   // 是否挂在某个槽位链表上
+    bool pending = false;  // 已摘下等待执行
+    bool running = false;  // 回调执行中
+    bool canceled = false; // 等待或执行中被取消
+  };
+
+public:
+  /// @brief 指定tick精度构造
+  /// @param tick_ms 每个tick的毫秒数
+  explicit TimingWheel(uint64_t tick_ms = 1)
+      : tick_ms_(tick_ms == 0 ? 1 : tick_ms),
+        start_(std::chrono::steady_clock::now()) {
+    for (uint32_t l = 0; l < kLevels; ++l) {
+      heads_[l].assign(l == 0 ? kLevel0Size : kLevelNSize, kNil);
+    }
+  }
+
+  /// @brief 添加定时器
+  /// @param delay_ms 首次触发延迟
+  /// @param cb 回调
+  /// @param interval_ms 周期，0为单次
+  /// @return 定时器ID
+  TimerId Add(uint64_t delay_ms, TimerCb cb, uint64_t interval_ms = 0) {
+    uint32_t idx = AllocNode();
+    Node &node = nodes_[idx];
+    node.cb = std::move(cb);
+    node.expire = std::max(CurrentTick(), now_tick_) + ToTicks(delay_ms);
+    node.interval = interval_ms ? ToTicks(interval_ms) : 0;
+    node.canceled = false;
+    Link(idx);
+    ++size_;
+    return (static_cast<uint64_t>(node.gen) << 32) | idx;
+  }
+
+  /// @brief 取消定时器，过期或已执行的ID返回false
+  /// @param id
+  /// @return
+  bool Cancel(TimerId id) {
+    uint32_t idx = static_cast<uint32_t>(id);
+    if (idx >= nodes_.size())
+      return false;
+    Node &node = nodes_[idx];
+    if (node.gen != static_cast<uint32_t>(id >> 32))
+      return false;
+    if (node.pending || node.running) {
+      // 已摘下或回调内取消：由执行流程负责回收
+      if (node.canceled)
+        return false;
+      node.canceled = true;
+      return true;
+    }
+    if (!node.linked)
+      return false;
+    Unlink(idx);
+    FreeNode(idx);
+    --size_;
+    return true;
+  }
+
+  /// @brief 推进到当前时刻并执行所有到期回调
+  /// @return 执行的回调个数
+  size_t Advance() { return AdvanceTo(CurrentTick()); }
+
+  /// @brief 距下一次需要推进的毫秒数
+  /// @note 第0层为精确到期时间，更高层返回级联边界，无定时器返回-1
+  /// @return
+  int64_t NextTimeoutMs() const {
+    if (size_ == 0)
+      return -1;
+    uint64_t next = NextTick();
+    uint64_t cur = CurrentTick();
+    return next <= cur ? 0 : static_cast<int64_t>((next - cur) * tick_ms_);
+  }
+
+  /// @brief 下一次需要推进的tick(绝对值)，推进或增删定时器前保持不变
+  /// @return 无定时器返回-1
+  int64_t NextExpireTick() const {
+    return size_ == 0 ? -1 : static_cast<int64_t>(NextTick());
+  }
+
+  /// @brief 活跃定时器个数
+  /// @return
+  size_t Size() const { return size_; }
+
+  /// @brief tick精度(ms)
+  /// @return
+  uint64_t TickMs() const { return tick_ms_; }
+
+private:
+  uint64_t CurrentTick() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    return static_cast<uint64_t>(elapsed) / tick_ms_;
+  }
+
+  uint64_t ToTicks(uint64_t ms) const { return (ms + tick_ms_ - 1) / tick_ms_; }
+
+  uint32_t AllocNode() {
+    if (free_head_ != kNil) {
+      uint32_t idx = free_head_;
+      free_head_ = nodes_[idx].next;
+      nodes_[idx].next = kNil;
+      return idx;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+  }
+
+  void FreeNode(uint32_t idx) {
+    Node &node = nodes_[idx];
+    node.cb = nullptr;
+    node.gen++; // 使旧ID失效
+    node.pending = false;
+    node.running = false;
+    node.canceled = false;
+    node.prev = kNil;
+    node.next = free_head_;
+    free_head_ = idx;
+  }
+
+  /// @brief 根据到期tick挂到对应层级槽位
+  void Link(uint32_t idx) {
+    Node &node = nodes_[idx];
+    // 执行当前tick期间新增的定时器顺延到下一个tick，避免落入已摘下的槽位
+    uint64_t earliest = now_tick_ + (firing_ ? 1 : 0);
+    if (node.expire < earliest)
+      node.expire = earliest;
+    uint64_t delta = node.expire - now_tick_;
+    uint64_t expire = delta >= kMaxSpan ? now_tick_ + kMaxSpan - 1 : node.expire;
+
+    uint16_t level = 0;
+    uint16_t slot = 0;
+    if (delta < kLevel0Size) {
+      slot = expire & (kLevel0Size - 1);
+    } else {
+      level = 1;
+      uint32_t shift = kLevel0Bits;
+      while (level < kLevels - 1 &&
+             delta >= (1ull << (shift + kLevelNBits))) {
+        ++level;
+        shift += kLevelNBits;
+      }
+      slot = (expire >> shift) & (kLevelNSize - 1);
+    }
+
+    node.level = level;
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = heads_[level][slot];
+    if (node.next != kNil)
+      nodes_[node.next].prev = idx;
+    heads_[level][slot] = idx;
+    node.linked = true;
+    if (level == 0)
+      level0_bitmap_[slot >> 6] |= 1ull << (slot & 63);
+  }
+
+  void Unlink(uint32_t idx) {
+    Node &node = nodes_[idx];
+    if (node.prev != kNil)
+      nodes_[node.prev].next = node.next;
+    else
+      heads_[node.level][node.slot] = node.next;
+    if (node.next != kNil)
+      nodes_[node.next].prev = node.prev;
+    if (node.level == 0 && heads_[0][node.slot] == kNil)
+      level0_bitmap_[node.slot >> 6] &= ~(1ull << (node.slot & 63));
+    node.prev = node.next = kNil;
+    node.linked = false;
+  }
+
+  /// @brief 摘下整个槽位链表
+  uint32_t TakeSlot(uint16_t level, uint16_t slot) {
+    uint32_t head = heads_[level][slot];
+    heads_[level][slot] = kNil;
+    if (level == 0)
+      level0_bitmap_[slot >> 6] &= ~(1ull << (slot & 63));
+    for (uint32_t i = head; i != kNil; i = nodes_[i].next) {
+      nodes_[i].linked = false;
+      nodes_[i].pending = level == 0;
+    }
+    return head;
+  }
+
+  /// @brief 将高层槽位重新分布到低层
+  void Cascade(uint16_t level) {
+    uint32_t shift = kLevel0Bits + kLevelNBits * (level - 1);
+    uint16_t slot = (now_tick_ >> shift) & (kLevelNSize - 1);
+    uint32_t i = TakeSlot(level, slot);
+    while (i != kNil) {
+      uint32_t next = nodes_[i].next;
+      Link(i);
+      i = next;
+    }
+    // 本层转完一圈则继续级联上一层
+    if (slot == 0 && level + 1u < kLevels)
+      Cascade(level + 1);
+  }
+
+  size_t AdvanceTo(uint64_t target) {
+    size_t fired = 0;
+    while (now_tick_ <= target) {
+      uint16_t idx = now_tick_ & (kLevel0Size - 1);
+      if (idx == 0)
+        Cascade(1);
+
+      // 跳过第0层的空槽位，剩余槽位全空时直接跳到下一个级联边界
+      int32_t slot = NextLevel0Slot(idx);
+      if (slot < 0) {
+        uint64_t boundary = (now_tick_ | (kLevel0Size - 1)) + 1;
+        if (size_ == 0 || boundary > target) {
+          now_tick_ = target + 1;
+          break;
+        }
+        now_tick_ = boundary;
+        continue;
+      }
+      if (now_tick_ + (slot - idx) > target) {
+        now_tick_ = target + 1;
+        break;
+      }
+      now_tick_ += slot - idx;
+      idx = static_cast<uint16_t>(slot);
+
+      // 先把链表摘到本地，回调中增删定时器不会影响遍历
+      std::vector<uint32_t> &batch = firing_batch_;
+      batch.clear();
+      for (uint32_t i = TakeSlot(0, idx); i != kNil; i = nodes_[i].next)
+        batch.push_back(i);
+
+      firing_ = true;
+      for (uint32_t i : batch) {
+        nodes_[i].pending = false;
+        if (nodes_[i].canceled) {
+          FreeNode(i);
+          --size_;
+        } else {
+          Fire(i);
+          ++fired;
+        }
+      }
+      firing_ = false;
+      ++now_tick_;
+    }
+    return fired;
+  }
+
+  void Fire(uint32_t idx) {
+    nodes_[idx].running = true;
+    // 回调中可能新增定时器导致nodes_扩容，先移出回调
+    TimerCb cb = std::move(nodes_[idx].cb);
+    cb();
+    Node &node = nodes_[idx];
+    node.running = false;
+    if (node.interval && !node.canceled) {
+      node.cb = std::move(cb);
+      node.expire = now_tick_ + node.interval;
+      Link(idx);
+    } else {
+      FreeNode(idx);
+      --size_;
+    }
+  }
+
+  /// @brief 第0层从idx起第一个非空槽位，无则返回-1
+  int32_t NextLevel0Slot(uint16_t idx) const {
+    uint32_t word = idx >> 6;
+    uint64_t bits = level0_bitmap_[word] & (~0ull << (idx & 63));
+    while (true) {
+      if (bits)
+        return static_cast<int32_t>(word * 64 + __builtin_ctzll(bits));
+      if (++word == kLevel0Size / 64)
+        return -1;
+      bits = level0_bitmap_[word];
+    }
+  }
+
+  /// @brief 下一个需要处理的tick
+  uint64_t NextTick() const {
+    uint16_t idx = now_tick_ & (kLevel0Size - 1);
+    if (idx == 0)
+      return now_tick_; // 尚未级联
+    int32_t slot = NextLevel0Slot(idx);
+    if (slot >= 0)
+      return now_tick_ + (slot - idx);
+    return (now_tick_ | (kLevel0Size - 1)) + 1; // 下一个级联边界
+  }
+
+  uint64_t tick_ms_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t now_tick_ = 0; // 下一个待处理的tick
+  size_t size_ = 0;
+  bool firing_ = false;
+  std::vector<uint32_t> firing_batch_;
+
+  std::vector<Node> nodes_;
+  uint32_t free_head_ = kNil;
+  std::vector<uint32_t> heads_[kLevels];
+  uint64_t level0_bitmap_[kLevel0Size / 64] = {};
+};
+
+} // namespace threading
@@ -79,7 +79,21 @@ void containers::RingBuffer::PrintBuffer() {
 }
 
 size_t containers::RingBuffer::Resize(size_t buffer_size) {
-  buffer_.resize(buffer_size);
+  std::lock_guard<std::mutex> lock(mutex_);
+  // 新容量需容纳已有数据
+  if (buffer_size == 0 || buffer_size < length_)
+    return buffer_.size();
+
+  // 未读数据线性化到新缓冲区头部，旧缓冲随交换释放
+  std::vector<uint8_t> resized(buffer_size);
+  const size_t first_chunk = std::min(length_, buffer_.size() - read_index_);
+  memcpy(resized.data(), buffer_.data() + read_index_, first_chunk);
+  if (length_ > first_chunk) {
+    memcpy(resized.data() + first_chunk, buffer_.data(), length_ - first_chunk);
+  }
+  buffer_.swap(resized);
+  read_index_ = 0;
+  write_index_ = length_ % buffer_.size();
   return buffer_.size();
 }
 
@@ -159,4 +173,22 @@ containers::RingBuffer::CommitReadSize(size_t read_size) {
   read_index_ = (read_index_ + read_size) % buffer_.size();
   length_ -= read_size;
   return Result::kSuccess;
-};
\ No newline at end of file
+};
+
+void containers::RingBuffer::Linearize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (length_ == 0) {
+    read_index_ = write_index_ = 0;
+    return;
+  }
+  if (read_index_ == 0)
+    return;
+  if (read_index_ + length_ <= buffer_.size()) {
+    memmove(buffer_.data(), buffer_.data() + read_index_, length_);
+  } else {
+    // 数据环回：整体左旋后两段首尾相接
+    std::rotate(buffer_.begin(), buffer_.begin() + read_index_, buffer_.end());
+  }
+  read_index_ = 0;
+  write_index_ = length_ % buffer_.size();
+}
@@ -0,0 +1,418 @@
+// 回环网络压测：ReactorCore作为回显服务端，客户端以独立epoll线程施压
+// 用法: net_loopback_bench [--conns N] [--size BYTES] [--depth N]
+//                          [--mode head|headtail|cb|http|resp] [--seconds N]
+//                          [--workers N] [--client-threads N]
+//                          [--port N] [--read-budget BYTES] [--help]
+// http模式下服务端为HttpHandler(循环线程内联处理)，请求为管线化的GET，
+// 响应体为请求路径中的时间戳；resp模式下服务端为RespHandler，请求为管线化的
+// ECHO命令。这两种模式下--size与--workers不生效
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/protocol/http_handler.hpp"
+#include "../../include/net/protocol/resp_handler.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/tcp.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace net;
+
+namespace {
+
+struct BenchConfig {
+  int conns = 8;
+  size_t size = 64;
+  int depth = 16;
+  std::string mode = "headtail";
+  int seconds = 5;
+  size_t workers = 2;
+  int client_threads = 1;
+  uint16_t port = 18080;
+  size_t read_budget = 0;
+  size_t reply_size = 0; // 每帧响应长度，回显模式与size相同
+};
+
+const std::vector<uint8_t> kHead = {0xE, 0xD};
+const std::vector<uint8_t> kTail = {0xA};
+constexpr size_t kStampLen = 16; // 发送时间戳，16位十六进制，避免与定位符冲突
+const std::string kHttpPrefix = "GET /";
+const std::string kHttpSuffix = " HTTP/1.1\r\nHost: bench\r\n\r\n";
+// 响应: 状态行 Date(定长29) Content-Type Content-Length 时间戳
+const size_t kHttpReplySize =
+    std::string("HTTP/1.1 200 OK\r\nDate: \r\nContent-Type: text/plain\r\n"
+                "Content-Length: 16\r\n\r\n")
+        .size() +
+    29 + kStampLen;
+const std::string kRespPrefix = "*2\r\n$4\r\nECHO\r\n$16\r\n";
+const std::string kRespSuffix = "\r\n";
+const size_t kRespReplySize = 5 + kStampLen + 2; // $16\r\n 时间戳 \r\n
+
+/// @brief 文本协议模式(http/resp)的请求前后缀，时间戳位于两者之间
+bool IsTextMode(const BenchConfig &cfg) {
+  return cfg.mode == "http" || cfg.mode == "resp";
+}
+const std::string &TextPrefix(const BenchConfig &cfg) {
+  return cfg.mode == "http" ? kHttpPrefix : kRespPrefix;
+}
+const std::string &TextSuffix(const BenchConfig &cfg) {
+  return cfg.mode == "http" ? kHttpSuffix : kRespSuffix;
+}
+size_t TextReplySize(const BenchConfig &cfg) {
+  return cfg.mode == "http" ? kHttpReplySize : kRespReplySize;
+}
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// @brief 帧格式: 头 [长度2字节,仅cb模式] 时间戳 填充 [尾,head模式无]
+size_t StampOffset(const BenchConfig &cfg) {
+  if (IsTextMode(cfg))
+    return TextPrefix(cfg).size();
+  return kHead.size() + (cfg.mode == "cb" ? 2 : 0);
+}
+
+/// @brief 响应帧中时间戳的偏移
+size_t ReplyStampOffset(const BenchConfig &cfg) {
+  if (cfg.mode == "http")
+    return kHttpReplySize - kStampLen;
+  return cfg.mode == "resp" ? 5 : StampOffset(cfg);
+}
+
+size_t MinFrameSize(const BenchConfig &cfg) {
+  if (IsTextMode(cfg))
+    return TextPrefix(cfg).size() + kStampLen + TextSuffix(cfg).size();
+  return StampOffset(cfg) + kStampLen + (cfg.mode == "head" ? 0 : kTail.size());
+}
+
+void BuildFrame(const BenchConfig &cfg, uint64_t stamp, uint8_t *frame) {
+  static const char *kHex = "0123456789abcdef";
+  if (IsTextMode(cfg)) {
+    const std::string &prefix = TextPrefix(cfg);
+    const std::string &suffix = TextSuffix(cfg);
+    memcpy(frame, prefix.data(), prefix.size());
+    for (size_t i = 0; i < kStampLen; ++i)
+      frame[prefix.size() + i] =
+          kHex[(stamp >> ((kStampLen - 1 - i) * 4)) & 0xF];
+    memcpy(frame + prefix.size() + kStampLen, suffix.data(), suffix.size());
+    return;
+  }
+  memcpy(frame, kHead.data(), kHead.size());
+  if (cfg.mode == "cb") {
+    uint16_t data_size = static_cast<uint16_t>(cfg.size - MinFrameSize(cfg));
+    frame[2] = static_cast<uint8_t>(data_size >> 8);
+    frame[3] = static_cast<uint8_t>(data_size);
+  }
+  uint8_t *p = frame + StampOffset(cfg);
+  for (size_t i = 0; i < kStampLen; ++i)
+    p[i] = kHex[(stamp >> ((kStampLen - 1 - i) * 4)) & 0xF];
+  size_t tail = cfg.mode == "head" ? 0 : kTail.size();
+  memset(p + kStampLen, 'x', cfg.size - StampOffset(cfg) - kStampLen - tail);
+  if (tail)
+    memcpy(frame + cfg.size - tail, kTail.data(), tail);
+}
+
+uint64_t ParseStamp(const BenchConfig &cfg, const uint8_t *frame) {
+  uint64_t stamp = 0;
+  const uint8_t *p = frame + ReplyStampOffset(cfg);
+  for (size_t i = 0; i < kStampLen; ++i)
+    stamp = (stamp << 4) | (p[i] <= '9' ? p[i] - '0' : p[i] - 'a' + 10);
+  return stamp;
+}
+
+/// @brief 客户端连接状态
+struct ClientConn {
+  int fd = -1;
+  std::vector<uint8_t> out;  // 待发送
+  size_t out_pos = 0;
+  std::vector<uint8_t> in;   // 未凑满一帧的接收数据
+  int inflight = 0;
+};
+
+struct ClientResult {
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  std::vector<uint32_t> latencies_us;
+};
+
+/// @brief 客户端线程：每个连接保持depth个在途帧，收到一帧回显即补发一帧
+void RunClient(const BenchConfig &cfg, int conns, uint64_t start_ns,
+               uint64_t end_ns, ClientResult &result) {
+  int epoll_fd = epoll_create1(0);
+  std::vector<ClientConn> clients(conns);
+  for (auto &c : clients) {
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg.port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(c.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+      perror("connect");
+      exit(1);
+    }
+    int on = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL) | O_NONBLOCK);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = &c;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c.fd, &ev);
+  }
+
+  std::vector<uint8_t> frame(cfg.size);
+  auto enqueue = [&](ClientConn &c) {
+    BuildFrame(cfg, NowNs(), frame.data());
+    c.out.insert(c.out.end(), frame.begin(), frame.end());
+    c.inflight++;
+  };
+  auto flush = [&](ClientConn &c) {
+    while (c.out_pos < c.out.size()) {
+      ssize_t n = send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos,
+                       MSG_NOSIGNAL);
+      if (n <= 0)
+        break;
+      c.out_pos += n;
+    }
+    if (c.out_pos == c.out.size()) {
+      c.out.clear();
+      c.out_pos = 0;
+    }
+  };
+
+  for (auto &c : clients) {
+    for (int i = 0; i < cfg.depth; ++i)
+      enqueue(c);
+    flush(c);
+  }
+
+  std::vector<uint8_t> buf(256 * 1024);
+  epoll_event events[64];
+  while (NowNs() < end_ns) {
+    int n = epoll_wait(epoll_fd, events, 64, 100);
+    for (int i = 0; i < n; ++i) {
+      ClientConn &c = *static_cast<ClientConn *>(events[i].data.ptr);
+      if (events[i].events & EPOLLIN) {
+        while (true) {
+          ssize_t r = recv(c.fd, buf.data(), buf.size(), 0);
+          if (r <= 0)
+            break;
+          c.in.insert(c.in.end(), buf.begin(), buf.begin() + r);
+        }
+        // 响应帧长固定，按帧长切分
+        size_t frames = c.in.size() / cfg.reply_size;
+        uint64_t now = NowNs();
+        for (size_t f = 0; f < frames; ++f) {
+          uint64_t stamp = ParseStamp(cfg, c.in.data() + f * cfg.reply_size);
+          c.inflight--;
+          if (stamp >= start_ns) { // 预热期间的帧不计入
+            result.messages++;
+            result.bytes += cfg.size;
+            result.latencies_us.push_back(
+                static_cast<uint32_t>((now - stamp) / 1000));
+          }
+          enqueue(c);
+        }
+        c.in.erase(c.in.begin(), c.in.begin() + frames * cfg.reply_size);
+      }
+      flush(c);
+    }
+  }
+  for (auto &c : clients)
+    close(c.fd);
+  close(epoll_fd);
+}
+
+void ConfigureServer(ReactorCore &server, int listen_fd,
+                     const BenchConfig &cfg) {
+  if (cfg.mode == "http") {
+    server.SetHandlerFactory(
+        listen_fd,
+        HttpHandler::Factory([](const HttpRequest &request,
+                                HttpResponse &response) {
+          response.AddHeader("Content-Type", "text/plain");
+          response.SetBody(request.path.substr(1));
+        }));
+    return;
+  }
+  if (cfg.mode == "resp") {
+    server.SetHandlerFactory(
+        listen_fd,
+        RespHandler::Factory([](const RespBatch &batch, RespWriter &writer) {
+          for (size_t i = 0; i < batch.Size(); ++i)
+            writer.Bulk(batch[i].Arg(1));
+        }));
+    return;
+  }
+  size_t buffer_size = std::max<size_t>(4096, cfg.size * 8);
+  if (cfg.mode == "head") {
+    server.SetConnHandlerParams(containers::HeadKey(kHead), {}, nullptr,
+                                nullptr, nullptr, buffer_size);
+  } else if (cfg.mode == "headtail") {
+    server.SetConnHandlerParams(containers::HeadKey(kHead),
+                                containers::TailKey(kTail), nullptr, nullptr,
+                                nullptr, buffer_size);
+  } else {
+    server.SetConnHandlerParams(
+        containers::HeadKey(kHead), containers::TailKey(kTail),
+        [](const uint8_t *head, size_t &head_size, size_t &data_size,
+           size_t &tail_size) {
+          head_size = kHead.size() + 2 + kStampLen;
+          data_size = (static_cast<size_t>(head[2]) << 8) | head[3];
+          tail_size = kTail.size();
+        },
+        [](const uint8_t *) { return true; }, nullptr, buffer_size);
+  }
+  server.SetConnExecCallback(
+      [&server](ConnId conn_id, std::vector<std::vector<uint8_t>> &packs) {
+        // 合并一批回显为一次发送
+        std::vector<uint8_t> out;
+        for (auto &pack : packs)
+          out.insert(out.end(), pack.begin(), pack.end());
+        server.Send(conn_id, std::move(out));
+      });
+}
+
+void PrintUsage(FILE *out, const char *prog) {
+  fprintf(out,
+          "usage: %s [--conns N] [--size BYTES] [--depth N] "
+          "[--mode head|headtail|cb|http|resp] [--seconds N] [--workers N] "
+          "[--client-threads N] [--port N] [--read-budget BYTES]\n"
+          "  --conns N           client connections (default 8)\n"
+          "  --size BYTES        frame size for head/headtail/cb (default 64)\n"
+          "  --depth N           frames in flight per connection (default 16)\n"
+          "  --mode MODE         head: head key only; headtail: head and tail "
+          "keys;\n"
+          "                      cb: head/tail keys with length callback;\n"
+          "                      http: pipelined GET to HttpHandler;\n"
+          "                      resp: pipelined ECHO to RespHandler "
+          "(default headtail)\n"
+          "  --seconds N         measured duration after 1s warm-up "
+          "(default 5)\n"
+          "  --workers N         dispatcher worker threads (default 2)\n"
+          "  --client-threads N  client epoll threads (default 1)\n"
+          "  --port N            loopback port (default 18080)\n"
+          "  --read-budget BYTES per-event read budget, 0 = unlimited\n"
+          "  --help              show this help\n",
+          prog);
+}
+
+bool ParseArgs(int argc, char **argv, BenchConfig &cfg) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--conns")
+      cfg.conns = atoi(value);
+    else if (key == "--size")
+      cfg.size = strtoul(value, nullptr, 10);
+    else if (key == "--depth")
+      cfg.depth = atoi(value);
+    else if (key == "--mode")
+      cfg.mode = value;
+    else if (key == "--seconds")
+      cfg.seconds = atoi(value);
+    else if (key == "--workers")
+      cfg.workers = strtoul(value, nullptr, 10);
+    else if (key == "--client-threads")
+      cfg.client_threads = atoi(value);
+    else if (key == "--port")
+      cfg.port = static_cast<uint16_t>(atoi(value));
+    else if (key == "--read-budget")
+      cfg.read_budget = strtoul(value, nullptr, 10);
+    else
+      return false;
+  }
+  if (cfg.mode != "head" && cfg.mode != "headtail" && cfg.mode != "cb" &&
+      !IsTextMode(cfg))
+    return false;
+  if (IsTextMode(cfg))
+    cfg.size = MinFrameSize(cfg);
+  if (cfg.size < MinFrameSize(cfg) || cfg.size > 65535 || cfg.conns <= 0 ||
+      cfg.depth <= 0 || cfg.client_threads <= 0)
+    return false;
+  // 仅头模式下最后一帧需等待下一帧的头才能切分
+  if (cfg.mode == "head" && cfg.depth < 2)
+    cfg.depth = 2;
+  cfg.reply_size = IsTextMode(cfg) ? TextReplySize(cfg) : cfg.size;
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchConfig cfg;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+      PrintUsage(stdout, argv[0]);
+      return 0;
+    }
+  }
+  if (!ParseArgs(argc, argv, cfg)) {
+    PrintUsage(stderr, argv[0]);
+    return 1;
+  }
+
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(cfg.workers));
+  server.SetReadBudget(cfg.read_budget);
+  int listen_fd = SocketCreator::CreateTcpSocket("127.0.0.1", cfg.port, true,
+                                                 SOMAXCONN);
+  if (listen_fd < 0) {
+    fprintf(stderr, "listen on %u failed\n", cfg.port);
+    return 1;
+  }
+  server.RegisterProtocol(listen_fd, nullptr, true);
+  ConfigureServer(server, listen_fd, cfg);
+  std::thread server_thread([&] { server.Run(); });
+
+  // 预热1秒后开始统计
+  uint64_t start_ns = NowNs() + 1000000000ull;
+  uint64_t end_ns = start_ns + static_cast<uint64_t>(cfg.seconds) * 1000000000ull;
+  std::vector<ClientResult> results(cfg.client_threads);
+  std::vector<std::thread> clients;
+  for (int t = 0; t < cfg.client_threads; ++t) {
+    int conns = cfg.conns / cfg.client_threads +
+                (t < cfg.conns % cfg.client_threads ? 1 : 0);
+    clients.emplace_back(RunClient, std::cref(cfg), conns, start_ns, end_ns,
+                         std::ref(results[t]));
+  }
+  for (auto &t : clients)
+    t.join();
+  server.Stop();
+  server_thread.join();
+
+  ClientResult total;
+  for (auto &r : results) {
+    total.messages += r.messages;
+    total.bytes += r.bytes;
+    total.latencies_us.insert(total.latencies_us.end(), r.latencies_us.begin(),
+                              r.latencies_us.end());
+  }
+  std::sort(total.latencies_us.begin(), total.latencies_us.end());
+  auto pct = [&](double p) -> uint32_t {
+    if (total.latencies_us.empty())
+      return 0;
+    size_t idx = static_cast<size_t>(p * (total.latencies_us.size() - 1));
+    return total.latencies_us[idx];
+  };
+
+  ReactorMetricsSnapshot m = server.Metrics();
+  printf("mode=%s conns=%d size=%zu depth=%d workers=%zu seconds=%d\n",
+         cfg.mode.c_str(), cfg.conns, cfg.size, cfg.depth, cfg.workers,
+         cfg.seconds);
+  printf("msgs/sec=%.0f MB/s=%.2f (echo, one direction)\n",
+         total.messages / static_cast<double>(cfg.seconds),
+         total.bytes / static_cast<double>(cfg.seconds) / (1024.0 * 1024.0));
+  printf("latency us: p50=%u p99=%u p999=%u max=%u\n", pct(0.5), pct(0.99),
+         pct(0.999), pct(1.0));
+  printf("server: wakeups=%lu events/wakeup=%.2f caller_runs=%lu "
+         "budget_yields=%lu\n",
+         m.wakeups, m.events_per_wakeup.Mean(), m.caller_runs,
+         m.budget_yields);
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include "../../include/net/core/broadcast_hub.hpp"
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <future>
+
+using namespace net;
+
+// 阻塞客户端连接
+int ConnectTo(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  timeval tv{2, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+// 读取恰好size字节
+bool ReadExact(int fd, uint8_t *out, size_t size) {
+  size_t received = 0;
+  while (received < size) {
+    ssize_t n = recv(fd, out + received, size - received, 0);
+    if (n <= 0)
+      return false;
+    received += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+int main() {
+  const uint16_t kPorts[2] = {8191, 8192};
+  const int kClientsPerLoop = 50;
+  const int kMessages = 2000;
+  const size_t kMessageSize = 1024;
+
+  ReactorCore loops[2];
+  BroadcastHub hub({&loops[0], &loops[1]});
+  std::atomic<int> subscribed{0};
+  std::mutex accepted_mutex;
+  std::vector<ConnId> accepted[2];
+  std::thread threads[2];
+  for (int i = 0; i < 2; ++i) {
+    ReactorCore &loop = loops[i];
+    loop.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    loop.SetAcceptCallback([&, i](ConnId conn_id) {
+      hub.Subscribe(loops[i], "news", conn_id);
+      {
+        std::lock_guard<std::mutex> lock(accepted_mutex);
+        accepted[i].push_back(conn_id);
+      }
+      subscribed++;
+    });
+    int listen_fd = SocketCreator::CreateTcpSocket("127.0.0.1", kPorts[i],
+                                                   true, SOMAXCONN);
+    loop.RegisterProtocol(listen_fd, nullptr, true);
+    threads[i] = std::thread([&loop] { loop.Run(); });
+  }
+
+  std::vector<int> clients;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < kClientsPerLoop; ++j)
+      clients.push_back(ConnectTo(kPorts[i]));
+  }
+  while (subscribed.load() < 2 * kClientsPerLoop)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  LOG_MSG("Broadcast_Fanout_Testing");
+  // 每个客户端由独立线程读取并校验全部消息
+  std::atomic<int> complete{0};
+  std::vector<std::thread> readers;
+  for (int fd : clients) {
+    readers.emplace_back([fd, &complete, kMessages, kMessageSize] {
+      std::vector<uint8_t> message(kMessageSize);
+      for (int m = 0; m < kMessages; ++m) {
+        if (!ReadExact(fd, message.data(), message.size()) ||
+            message[0] != static_cast<uint8_t>(m) ||
+            message.back() != static_cast<uint8_t>(m >> 8))
+          return;
+      }
+      complete++;
+    });
+  }
+
+  std::vector<BroadcastHub::Buffer> buffers;
+  auto start = std::chrono::steady_clock::now();
+  for (int m = 0; m < kMessages; ++m) {
+    std::vector<uint8_t> message(kMessageSize, 0x5a);
+    message[0] = static_cast<uint8_t>(m);
+    message.back() = static_cast<uint8_t>(m >> 8);
+    auto buffer =
+        std::make_shared<const std::vector<uint8_t>>(std::move(message));
+    if (m % 100 == 0)
+      buffers.push_back(buffer);
+    hub.Publish("news", std::move(buffer));
+  }
+  for (auto &reader : readers)
+    reader.join();
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  LOGP_MSG("clients complete:%d/%zu,%d messages in %ldms (%.0f MB/s out)",
+           complete.load(), clients.size(), kMessages, elapsed_ms,
+           clients.size() * kMessages * kMessageSize /
+               (std::max<long>(elapsed_ms, 1) * 1000.0));
+
+  // 发送完成后各连接释放引用，只剩本地持有的一份
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  long max_use_count = 0;
+  for (auto &buffer : buffers)
+    max_use_count = std::max(max_use_count, buffer.use_count());
+  LOGP_MSG("buffer max use_count after send:%ld", max_use_count);
+
+  LOG_MSG("Broadcast_Prune_Testing");
+  // 关闭一半客户端，下一次发布时惰性移除
+  for (size_t i = 0; i < clients.size(); i += 2) {
+    close(clients[i]);
+    clients[i] = -1;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  hub.Publish("news", std::vector<uint8_t>(kMessageSize, 0));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (int i = 0; i < 2; ++i) {
+    std::promise<size_t> count;
+    loops[i].RunInLoop(
+        [&, i] { count.set_value(hub.Subscribers(loops[i], "news")); });
+    LOGP_MSG("loop %d subscribers:%zu", i, count.get_future().get());
+  }
+
+  LOG_MSG("Broadcast_Unsubscribe_Testing");
+  // 取消订阅后不再收到发布，直接按连接列表广播仍可收到
+  std::vector<ConnId> conns;
+  {
+    std::lock_guard<std::mutex> lock(accepted_mutex);
+    conns = accepted[1];
+  }
+  for (ConnId conn_id : conns)
+    hub.Unsubscribe(loops[1], "news", conn_id);
+  hub.Publish("news", std::vector<uint8_t>(kMessageSize, 0));
+  auto shared = std::make_shared<const std::vector<uint8_t>>(16, 0x11);
+  loops[1].Broadcast(conns, shared);
+  int direct = 0;
+  for (int j = 1; j < kClientsPerLoop; j += 2) {
+    // 先读走剪枝测试的那条发布
+    std::vector<uint8_t> message(kMessageSize);
+    uint8_t direct_message[16];
+    int fd = clients[kClientsPerLoop + j];
+    if (ReadExact(fd, message.data(), message.size()) &&
+        ReadExact(fd, direct_message, sizeof(direct_message)) &&
+        direct_message[15] == 0x11)
+      direct++;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  LOGP_MSG("direct broadcast received:%d/%d,use_count:%ld", direct,
+           kClientsPerLoop / 2, shared.use_count());
+
+  for (int fd : clients) {
+    if (fd >= 0)
+      close(fd);
+  }
+  for (int i = 0; i < 2; ++i) {
+    loops[i].Stop();
+    threads[i].join();
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include "../../include/net/client/connection_pool.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+
+using namespace net;
+
+// 回显服务端
+void StartEchoServer(ReactorCore &server, uint16_t port) {
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  int tcp_fd = SocketCreator::CreateTcpSocket("127.0.0.1", port, true, SOMAXCONN);
+  server.RegisterProtocol(tcp_fd, nullptr, true);
+  server.SetConnHandlerParams({0xE, 0xD}, {0xA});
+  server.SetConnExecCallback(
+      [&server](ConnId conn_id, std::vector<std::vector<uint8_t>> &packs) {
+        for (auto &pack : packs)
+          server.Send(conn_id, pack);
+      });
+}
+
+int main() {
+  LOG_MSG("Pool_Reuse_Testing");
+  ReactorCore server;
+  StartEchoServer(server, 8185);
+  std::thread server_thread([&] { server.Run(); });
+
+  ReactorCore client;
+  client.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  client.SetConnHandlerParams({0xE, 0xD}, {0xA});
+
+  PoolOptions options;
+  options.max_conns_per_key = 2;
+  options.acquire_timeout_ms = 800;
+  ConnectionPool *pool_ptr = nullptr;
+  std::atomic<int> responses{0};
+  // 收到响应后归还连接，后续请求复用
+  options.connect.exec_cb = [&](ConnId conn_id,
+                                std::vector<std::vector<uint8_t>> &packs) {
+    responses += packs.size();
+    pool_ptr->Release(conn_id);
+  };
+  ConnectionPool pool(client, options);
+  pool_ptr = &pool;
+
+  for (int i = 0; i < 20; ++i) {
+    pool.Acquire("127.0.0.1", 8185, [&](ConnId conn_id, int error) {
+      if (error) {
+        LOGP_MSG("acquire error:%d", error);
+        return;
+      }
+      client.Send(conn_id, std::vector<uint8_t>{0xE, 0xD, 0x7, 0xA});
+    });
+  }
+
+  LOG_MSG("Pool_Backoff_Testing");
+  std::atomic<int> failures{0};
+  for (int i = 0; i < 3; ++i) {
+    // 无服务的端口：建连失败后退避重试，等待者超时返回ETIMEDOUT
+    pool.Acquire("127.0.0.1", 1, [&](ConnId, int error) {
+      LOGP_MSG("unreachable backend error:%d", error);
+      failures++;
+    });
+  }
+
+  LOG_MSG("Pool_Double_Release_Testing");
+  // 重复归还不会使同一连接两次进入空闲列表：单连接上限下第二个等待者超时
+  PoolOptions single_options;
+  single_options.max_conns_per_key = 1;
+  single_options.acquire_timeout_ms = 300;
+  ConnectionPool single(client, single_options);
+  std::vector<ConnId> holders;
+  int second_error = 0;
+  single.Acquire("127.0.0.1", 8185, [&](ConnId conn_id, int error) {
+    if (error)
+      return;
+    single.Release(conn_id);
+    single.Release(conn_id);
+    for (int i = 0; i < 2; ++i) {
+      single.Acquire("127.0.0.1", 8185, [&](ConnId held, int error) {
+        if (error)
+          second_error = error;
+        else
+          holders.push_back(held);
+      });
+    }
+  });
+
+  std::thread client_thread([&] { client.Run(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  LOGP_MSG("responses:%d,server accepts:%lu,failures:%d", responses.load(),
+           server.Metrics().accepts, failures.load());
+
+  client.RunInLoop([&] {
+    LOGP_MSG("holders:%zu(expected 1),second waiter error:%d(expected %d)",
+             holders.size(), second_error, ETIMEDOUT);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  client.Stop();
+  server.Stop();
+  client_thread.join();
+  server_thread.join();
+  return 0;
+}
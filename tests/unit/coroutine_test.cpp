@@ -0,0 +1,78 @@
+// 需以C++20编译: g++ -std=c++20
+#include "../../include/net/coro/co_connection.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+
+using namespace net;
+using namespace net::coro;
+
+// 回显服务：每个连接一个协程，顺序读写
+Task<void> Echo(CoConnection conn) {
+  while (auto frame = co_await conn.ReadFrame()) {
+    if (!co_await conn.Write(std::move(*frame)))
+      break;
+  }
+  LOGP_MSG("echo conn closed");
+}
+
+// 请求一次并等待响应
+Task<size_t> Request(CoConnection &conn, uint8_t seq) {
+  std::vector<uint8_t> request = {0xE, 0xD, seq, 0xA};
+  co_await conn.Write(std::move(request));
+  auto frame = co_await conn.ReadFrame();
+  if (!frame)
+    throw std::runtime_error("connection closed");
+  LOG_VECTOR(*frame);
+  co_return frame->size();
+}
+
+Task<void> Client(ReactorCore &reactor, std::atomic<int> &done) {
+  ConnectResult result = co_await ConnectAsync(reactor, "127.0.0.1", 8186);
+  LOGP_MSG("connect error:%d", result.error);
+  if (result.error != 0) {
+    done = -1;
+    co_return;
+  }
+  CoConnection conn(reactor, result.conn_id);
+  size_t total = 0;
+  for (uint8_t seq = 1; seq <= 3; ++seq)
+    total += co_await Request(conn, seq);
+
+  auto start = std::chrono::steady_clock::now();
+  co_await SleepFor(reactor, std::chrono::milliseconds(50));
+  LOGP_MSG("slept %ldms,echo bytes:%lu",
+           std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+               .count(),
+           total);
+  done = 1;
+}
+
+int main() {
+  LOG_MSG("Coroutine_Echo_Testing");
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  int tcp_fd =
+      SocketCreator::CreateTcpSocket("127.0.0.1", 8186, true, SOMAXCONN);
+  server.RegisterProtocol(tcp_fd, nullptr, true);
+  server.SetConnHandlerParams({0xE, 0xD}, {0xA});
+  server.SetAcceptCallback(
+      [&server](ConnId conn_id) { Spawn(Echo(CoConnection(server, conn_id))); });
+  std::thread server_thread([&] { server.Run(); });
+
+  ReactorCore client;
+  client.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  client.SetConnHandlerParams({0xE, 0xD}, {0xA});
+  std::atomic<int> done{0};
+  client.QueueInLoop([&] { Spawn(Client(client, done)); });
+  std::thread client_thread([&] { client.Run(); });
+
+  for (int i = 0; i < 100 && done == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  LOGP_MSG("client done:%d", done.load());
+
+  client.Stop();
+  server.Stop();
+  client_thread.join();
+  server_thread.join();
+  return 0;
+}
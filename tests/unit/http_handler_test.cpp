@@ -0,0 +1,172 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/protocol/http_handler.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+
+using namespace net;
+
+// 阻塞客户端连接
+int ConnectTo(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  timeval tv{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+void SendText(int fd, const std::string &text) {
+  send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+}
+
+// 统计完整的响应个数(按Content-Length)
+size_t CountResponses(const std::string &text) {
+  size_t count = 0;
+  size_t pos = 0;
+  while (true) {
+    size_t head_end = text.find("\r\n\r\n", pos);
+    if (head_end == std::string::npos)
+      return count;
+    size_t length_pos = text.find("Content-Length: ", pos);
+    size_t length = 0;
+    if (length_pos != std::string::npos && length_pos < head_end)
+      length = strtoul(text.c_str() + length_pos + 16, nullptr, 10);
+    if (text.size() < head_end + 4 + length)
+      return count;
+    pos = head_end + 4 + length;
+    count++;
+  }
+}
+
+// 读取直到收到指定个数的完整响应、超时或连接关闭
+std::string ReadResponses(int fd, size_t count) {
+  std::string received;
+  char buf[65536];
+  while (CountResponses(received) < count) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    received.append(buf, n);
+  }
+  return received;
+}
+
+// 打印响应的状态行与响应体(过长时只打印长度)
+void LogResponses(const std::string &text) {
+  size_t pos = 0;
+  while ((pos = text.find("HTTP/1.1 ", pos)) != std::string::npos) {
+    size_t line_end = text.find("\r\n", pos);
+    size_t head_end = text.find("\r\n\r\n", pos);
+    size_t length_pos = text.find("Content-Length: ", pos);
+    size_t length = 0;
+    if (length_pos != std::string::npos && length_pos < head_end)
+      length = strtoul(text.c_str() + length_pos + 16, nullptr, 10);
+    std::string body = length > 64 ? "<" + std::to_string(length) + " bytes>"
+                                   : text.substr(head_end + 4, length);
+    LOGP_MSG("%s | body:%s", text.substr(pos, line_end - pos).c_str(),
+             body.c_str());
+    pos = head_end + 4 + length;
+  }
+}
+
+int main() {
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  int listen_fd =
+      SocketCreator::CreateTcpSocket("127.0.0.1", 8187, true, SOMAXCONN);
+  server.RegisterProtocol(listen_fd, nullptr, true);
+
+  HttpLimits limits;
+  limits.initial_buffer_size = 256;
+  limits.max_request_size = 64 * 1024;
+  server.SetHandlerFactory(
+      listen_fd,
+      HttpHandler::Factory(
+          [](const HttpRequest &request, HttpResponse &response) {
+            if (request.path == "/plaintext") {
+              response.AddHeader("Content-Type", "text/plain");
+              response.SetBody("Hello, World!");
+            } else if (request.path == "/echo") {
+              response.AddHeader("Content-Type",
+                                 request.Header("content-type"));
+              response.SetBody(request.body);
+            } else if (request.path == "/large") {
+              response.SetBody(std::make_shared<const std::vector<uint8_t>>(
+                  100000, 'z'));
+            } else if (request.path == "/throw") {
+              throw std::runtime_error("handler failure");
+            } else {
+              response.SetStatus(404);
+            }
+          },
+          limits));
+  std::thread server_thread([&] { server.Run(); });
+
+  LOG_MSG("Http_Pipelining_Testing");
+  int fd = ConnectTo(8187);
+  SendText(fd, "GET /plaintext HTTP/1.1\r\nHost: a\r\n\r\n"
+               "GET /missing?x=1 HTTP/1.1\r\nHost: a\r\n\r\n"
+               "POST /echo HTTP/1.1\r\nHost: a\r\nContent-Type: text/x\r\n"
+               "Content-Length: 5\r\n\r\nhello");
+  LogResponses(ReadResponses(fd, 3));
+
+  LOG_MSG("Http_Split_And_Chunked_Testing");
+  // 请求头与分块请求体跨多次发送到达
+  SendText(fd, "POST /echo HTTP/1.1\r\nHo");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  SendText(fd, "st: a\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWiki\r\n");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  SendText(fd, "6;ext=1\r\npedia \r\nE\r\nin \r\n\r\nchunks.\r\n0\r\n"
+               "Trailer: x\r\n\r\n");
+  LogResponses(ReadResponses(fd, 1));
+
+  LOG_MSG("Http_Large_Body_Testing");
+  // 请求体超过初始缓冲区，扩容后收全；共享响应体经writev发出
+  std::string big(10000, 'b');
+  SendText(fd, "POST /echo HTTP/1.1\r\nContent-Length: 10000\r\n\r\n" + big +
+                   "GET /large HTTP/1.1\r\n\r\n");
+  std::string large = ReadResponses(fd, 2);
+  LogResponses(large);
+  LOGP_MSG("echo ok:%d", large.find(big) != std::string::npos);
+
+  LOG_MSG("Http_Error_Testing");
+  SendText(fd, "GET /throw HTTP/1.1\r\n\r\n");
+  LogResponses(ReadResponses(fd, 1));
+  char tail;
+  LOGP_MSG("closed after 500:%d", recv(fd, &tail, 1, 0) == 0);
+  close(fd);
+
+  fd = ConnectTo(8187);
+  SendText(fd, "GET / HTTP/2.0\r\n\r\n");
+  LogResponses(ReadResponses(fd, 1));
+  close(fd);
+
+  fd = ConnectTo(8187);
+  SendText(fd, "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n"
+               "Transfer-Encoding: chunked\r\n\r\n");
+  LogResponses(ReadResponses(fd, 1));
+  close(fd);
+
+  LOG_MSG("Http_Keepalive_Testing");
+  // HTTP/1.0默认关闭，Connection: close在响应后关闭
+  fd = ConnectTo(8187);
+  SendText(fd, "GET /plaintext HTTP/1.0\r\n\r\n");
+  LogResponses(ReadResponses(fd, 1));
+  LOGP_MSG("http/1.0 closed:%d", recv(fd, &tail, 1, 0) == 0);
+  close(fd);
+  fd = ConnectTo(8187);
+  SendText(fd, "GET /plaintext HTTP/1.1\r\nConnection: close\r\n\r\n"
+               "GET /plaintext HTTP/1.1\r\n\r\n");
+  std::string last = ReadResponses(fd, 2);
+  LogResponses(last);
+  close(fd);
+
+  server.Stop();
+  server_thread.join();
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "../../include/containers/mpmc_queue.hpp"
+#include "../../include/logger/logger.hpp"
+#include <thread>
+
+void General_IO_Testing() {
+  LOG_MSG("General_IO_Testing");
+  containers::MpmcQueue<std::vector<uint8_t>> queue(3); // 向上取整为4
+  LOGP_MSG("capacity:%d", queue.Capacity());
+
+  for (uint8_t i = 0; i < 5; ++i) {
+    std::vector<uint8_t> in = {i, i};
+    LOGP_MSG("push %d ret:%d", i, queue.TryPush(std::move(in)));
+  }
+
+  std::vector<uint8_t> out;
+  while (queue.TryPop(out)) {
+    LOG_VECTOR(out);
+  }
+}
+
+void Concurrent_Testing() {
+  LOG_MSG("Concurrent_Testing");
+  containers::MpmcQueue<uint64_t> queue(1024);
+  const uint64_t per_producer = 100000;
+  std::atomic<uint64_t> sum{0}, popped{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < 2; ++p) {
+    threads.emplace_back([&] {
+      for (uint64_t i = 1; i <= per_producer; ++i) {
+        uint64_t v = i;
+        while (!queue.TryPush(std::move(v)))
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (int c = 0; c < 2; ++c) {
+    threads.emplace_back([&] {
+      uint64_t v;
+      while (popped.load() < 2 * per_producer) {
+        if (queue.TryPop(v)) {
+          sum += v;
+          popped++;
+        }
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  LOGP_MSG("popped:%lu,sum:%lu,expect:%lu", popped.load(), sum.load(),
+           per_producer * (per_producer + 1));
+}
+
+int main(int argc, char const *argv[]) {
+  General_IO_Testing();
+  Concurrent_Testing();
+  return 0;
+}
@@ -1,6 +1,5 @@
 #include "net/core/reactor_core.hpp"
 #include "net/transport/socket_creator.hpp"
-#include "threading/timer_scheduler.hpp"
 #include <csignal>
 #include <iostream>
 
@@ -20,9 +19,14 @@ int main() {
 
   ReactorCore reactor;
 
-  // 定时线程池依赖注入
-  auto timer_scheduler = std::make_shared<threading::TimerScheduler>();
-  reactor.SetTimerScheduler(std::move(timer_scheduler));
+  // 数据包派发器依赖注入
+  auto dispatcher = std::make_shared<PacketDispatcher>(4);
+  reactor.SetDispatcher(std::move(dispatcher));
+  // 读侧流控：工作线程处理不过来时暂停读取
+  FlowLimits flow_limits;
+  flow_limits.conn_max_inflight = 64;
+  flow_limits.global_max_inflight = 1024;
+  reactor.SetFlowLimits(flow_limits);
 
   // 创建TCP服务器套接字
   int tcp_fd = SocketCreator::CreateTcpSocket("0.0.0.0", 8080, true, SOMAXCONN);
@@ -33,6 +37,15 @@ int main() {
 
   // 注册TCP监听套接字
   reactor.RegisterProtocol(tcp_fd, nullptr, true);
+  // 空闲30秒的连接自动回收
+  ConnTimeouts timeouts;
+  timeouts.idle_timeout_ms = 30 * 1000;
+  reactor.SetConnTimeouts(tcp_fd, timeouts);
+  // 接收缓冲区从1KB起按流量扩容到64KB，空闲5秒后收缩
+  RecvBufferPolicy buffer_policy;
+  buffer_policy.max_size = 64 * 1024;
+  buffer_policy.shrink_idle_ms = 5 * 1000;
+  reactor.SetRecvBufferPolicy(tcp_fd, buffer_policy);
   reactor.SetConnHandlerParams(
       {0xE, 0xD}, {0xA}, nullptr, nullptr,
       [](std::vector<std::vector<uint8_t>> &packs) -> void {
@@ -58,9 +71,24 @@ int main() {
       LOG_VECTOR(pack);
     }
   });
+  // 数据报回调：保留对端地址，批量回显
+  udp_handler->SetDatagramCallback(
+      [](int fd, std::vector<Datagram> &datagrams) {
+        UdpHandler::SendBatch(fd, datagrams);
+      });
 
   reactor.RegisterProtocol(udp_fd, std::move(udp_handler));
 
+  // 每10秒输出一次事件循环指标
+  reactor.RunEvery(10 * 1000, [&reactor]() {
+    ReactorMetricsSnapshot m = reactor.Metrics();
+    LOGP_MSG("wakeups:%lu,events:%lu,accepts:%lu,closed:%lu,"
+             "loop p99:%luns,handler p99:%luns,dispatch depth max:%lu",
+             m.wakeups, m.events, m.accepts, m.conns_closed,
+             m.loop_latency_ns.Percentile(0.99), m.handler_ns.Percentile(0.99),
+             m.dispatch_depth.max);
+  });
+
   std::cout << "Server started. Listening on TCP:8080 and UDP:9090\n";
   std::cout << "Press Ctrl+C to exit...\n";
 
@@ -0,0 +1,160 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+
+using namespace net;
+
+// 填充临时文件，返回已unlink的fd
+int MakeTempFile(size_t size) {
+  char path[] = "/tmp/output_queue_testXXXXXX";
+  int fd = mkstemp(path);
+  unlink(path);
+  std::vector<uint8_t> data(size, 0x5a);
+  if (write(fd, data.data(), data.size()) != static_cast<ssize_t>(size)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// SIGPIPE是否仍为默认处置(发送路径不应修改进程级处置)
+bool SigPipeIsDefault() {
+  struct sigaction current {};
+  sigaction(SIGPIPE, nullptr, &current);
+  return current.sa_handler == SIG_DFL;
+}
+
+int main() {
+  const size_t kFileSize = 4 << 20;
+
+  LOG_MSG("OutputQueue_File_To_Closed_Peer_Testing");
+  {
+    // sendfile没有MSG_NOSIGNAL，未屏蔽SIGPIPE时进程在此被终止
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds);
+    close(fds[1]);
+    int file_fd = MakeTempFile(kFileSize);
+    OutputQueue queue;
+    queue.Push(OutputChunk::FromFile(file_fd, 0, kFileSize, true));
+    OutputQueue::FlushResult result = queue.Flush(fds[0]);
+    int error = errno;
+    LOGP_MSG("file flush result:%d(kError=%d),errno:%d(EPIPE=%d)",
+             static_cast<int>(result),
+             static_cast<int>(OutputQueue::FlushResult::kError), error, EPIPE);
+    close(fds[0]);
+  }
+
+  LOG_MSG("OutputQueue_Pipe_To_Closed_Peer_Testing");
+  {
+    int fds[2], pipe_fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds);
+    close(fds[1]);
+    pipe2(pipe_fds, O_NONBLOCK);
+    const char text[] = "spliced payload";
+    ssize_t filled = write(pipe_fds[1], text, sizeof(text));
+    OutputQueue queue;
+    queue.Push(OutputChunk::FromPipe(pipe_fds[0], filled, true));
+    OutputQueue::FlushResult result = queue.Flush(fds[0]);
+    int error = errno;
+    LOGP_MSG("pipe flush result:%d,errno:%d", static_cast<int>(result), error);
+    close(pipe_fds[1]);
+    close(fds[0]);
+  }
+
+  LOG_MSG("OutputQueue_SigPipe_Disposition_Testing");
+  {
+    // 屏蔽仅在写入期间生效，结束后信号掩码与处置均恢复原状
+    sigset_t mask;
+    pthread_sigmask(SIG_SETMASK, nullptr, &mask);
+    sigset_t pending;
+    sigpending(&pending);
+    LOGP_MSG("sigpipe default:%d(expected 1),blocked:%d(expected 0),"
+             "pending:%d(expected 0)",
+             SigPipeIsDefault(), sigismember(&mask, SIGPIPE),
+             sigismember(&pending, SIGPIPE));
+  }
+
+  LOG_MSG("Reactor_SendFile_To_Reset_Peer_Testing");
+  {
+    // 对端发送RST后服务端继续sendfile，连接应被关闭而进程存活
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    std::atomic<ConnId> accepted{0};
+    reactor.SetAcceptCallback([&](ConnId conn_id) { accepted = conn_id; });
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8194, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8194);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    connect(client, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    while (accepted.load() == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    linger reset{1, 0};
+    setsockopt(client, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    close(client);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    for (int i = 0; i < 4; ++i)
+      reactor.SendFile(accepted.load(), MakeTempFile(kFileSize), 0, kFileSize,
+                       true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t closed = reactor.Metrics().conns_closed;
+    reactor.Stop();
+    loop.join();
+    LOGP_MSG("process alive,conns closed:%llu(expected 1),sigpipe default:%d"
+             "(expected 1)",
+             static_cast<unsigned long long>(closed), SigPipeIsDefault());
+  }
+
+  LOG_MSG("Reactor_ZeroCopy_Close_Drain_Testing");
+  {
+    // 对端未读取时关闭连接，零拷贝缓冲仍在发送队列中，应保留到完成通知到达
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    reactor.SetZeroCopyThreshold(1);
+    std::atomic<ConnId> accepted{0};
+    reactor.SetAcceptCallback([&](ConnId conn_id) { accepted = conn_id; });
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8195, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8195);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    connect(client, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    while (accepted.load() == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto blob = std::make_shared<const std::vector<uint8_t>>(kFileSize, 0x5a);
+    std::weak_ptr<const std::vector<uint8_t>> watch = blob;
+    reactor.Send(accepted.load(), std::move(blob));
+    reactor.Close(accepted.load());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool alive_after_close = !watch.expired();
+
+    // 读完全部数据与FIN后发送队列清空，完成通知释放缓冲
+    std::vector<uint8_t> sink(64 * 1024);
+    size_t received = 0;
+    ssize_t n;
+    while ((n = read(client, sink.data(), sink.size())) > 0)
+      received += n;
+    for (int i = 0; i < 100 && !watch.expired(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    bool released = watch.expired();
+    reactor.Stop();
+    loop.join();
+    close(client);
+    // 关闭时尚未写入套接字的部分被丢弃，received为关闭前内核已接收的字节数
+    LOGP_MSG("buffer alive after close:%d(expected 1),received:%zu,released "
+             "after drain:%d(expected 1)",
+             alive_after_close, received, released);
+  }
+  return 0;
+}
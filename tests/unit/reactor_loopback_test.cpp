@@ -0,0 +1,414 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+using namespace net;
+
+// 阻塞连接回环端口
+int ConnectLoopback(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// 在timeout_ms内读取全部到达的数据
+std::vector<uint8_t> ReadFor(int fd, int timeout_ms) {
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  pollfd pfd{fd, POLLIN, 0};
+  while (poll(&pfd, 1, timeout_ms) > 0) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n <= 0)
+      break;
+    data.insert(data.end(), buffer, buffer + n);
+  }
+  return data;
+}
+
+// 绑定回环临时端口的UDP套接字，返回其端口
+int BindUdpLoopback(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// 对端是否已关闭连接(不阻塞)
+bool PeerClosed(int fd) {
+  uint8_t byte;
+  ssize_t n = recv(fd, &byte, 1, MSG_DONTWAIT | MSG_PEEK);
+  return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+// 在循环线程取连接统计
+ConnStatsSnapshot QueryStats(ReactorCore &reactor, ConnId conn_id) {
+  std::promise<ConnStatsSnapshot> promise;
+  reactor.RunInLoop([&] {
+    ConnStatsSnapshot stats{};
+    reactor.GetConnStats(conn_id, stats);
+    promise.set_value(stats);
+  });
+  return promise.get_future().get();
+}
+
+// 等待条件成立，最多timeout_ms
+template <class Pred> bool WaitFor(Pred pred, int timeout_ms = 1000) {
+  for (int i = 0; i < timeout_ms && !pred(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return pred();
+}
+
+int main() {
+  LOG_MSG("Reactor_Stale_ConnId_Testing");
+  {
+    // 连接关闭后fd被新连接复用，发往旧连接ID的数据必须丢弃
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    std::atomic<ConnId> accepted{0};
+    reactor.SetAcceptCallback([&](ConnId conn_id) { accepted = conn_id; });
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8196, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    int first = ConnectLoopback(8196);
+    WaitFor([&] { return accepted.load() != 0; });
+    ConnId old_id = accepted.exchange(0);
+    close(first);
+    WaitFor([&] { return reactor.Metrics().conns_closed == 1; });
+
+    int second = ConnectLoopback(8196);
+    WaitFor([&] { return accepted.load() != 0; });
+    ConnId new_id = accepted.load();
+
+    reactor.Send(old_id, std::vector<uint8_t>{1, 2, 3});
+    reactor.Send(new_id, std::vector<uint8_t>{4, 5});
+    std::vector<uint8_t> received = ReadFor(second, 100);
+    reactor.Stop();
+    loop.join();
+    close(second);
+    LOGP_MSG("same fd:%d(expected 1),same id:%d(expected 0),received:%zu"
+             "(expected 2),first byte:%d(expected 4)",
+             ConnIdToFd(old_id) == ConnIdToFd(new_id), old_id == new_id,
+             received.size(), received.empty() ? 0 : received[0]);
+  }
+
+  LOG_MSG("Reactor_Udp_Batch_Boundary_Testing");
+  {
+    // 两个对端各发3个不同长度的数据报，事件循环启动前全部到达，
+    // 一次recvmmsg收下且每个数据报保持独立边界与来源地址
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    int udp_fd = SocketCreator::CreateUdpSocket("127.0.0.1", 9196);
+    auto handler = std::make_unique<UdpHandler>(udp_fd, nullptr);
+    std::mutex mutex;
+    std::vector<std::pair<uint16_t, size_t>> seen; // 来源端口,长度
+    handler->SetDatagramCallback([&](int fd, std::vector<Datagram> &datagrams) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Datagram &d : datagrams) {
+          auto *peer = reinterpret_cast<const sockaddr_in *>(&d.peer);
+          seen.emplace_back(ntohs(peer->sin_port), d.payload.size());
+        }
+      }
+      UdpHandler::SendBatch(fd, datagrams); // 回显到各自的对端
+    });
+    reactor.RegisterProtocol(udp_fd, std::move(handler));
+
+    uint16_t ports[2];
+    int clients[2] = {BindUdpLoopback(ports[0]), BindUdpLoopback(ports[1])};
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(9196);
+    inet_pton(AF_INET, "127.0.0.1", &server.sin_addr);
+    for (size_t size = 1; size <= 3; ++size) {
+      for (int c = 0; c < 2; ++c) {
+        std::vector<uint8_t> payload(size * 100 + c, static_cast<uint8_t>(c));
+        sendto(clients[c], payload.data(), payload.size(), 0,
+               reinterpret_cast<sockaddr *>(&server), sizeof(server));
+      }
+    }
+    std::thread loop([&] { reactor.Run(); });
+    WaitFor([&] {
+      std::lock_guard<std::mutex> lock(mutex);
+      return seen.size() == 6;
+    });
+
+    // 回显的数据报回到各自的来源，长度不变
+    size_t echoed[2] = {0, 0};
+    bool echo_ok = true;
+    for (int c = 0; c < 2; ++c) {
+      uint8_t buffer[1024];
+      pollfd pfd{clients[c], POLLIN, 0};
+      while (poll(&pfd, 1, 100) > 0) {
+        ssize_t n = recv(clients[c], buffer, sizeof(buffer), 0);
+        if (n <= 0)
+          break;
+        echo_ok &= n == static_cast<ssize_t>((echoed[c] + 1) * 100 + c) &&
+                   buffer[0] == c;
+        ++echoed[c];
+      }
+      close(clients[c]);
+    }
+    reactor.Stop();
+    loop.join();
+
+    bool boundary_ok = seen.size() == 6;
+    size_t order[2] = {0, 0};
+    for (auto &[port, size] : seen) {
+      int c = port == ports[0] ? 0 : port == ports[1] ? 1 : -1;
+      if (c < 0 || size != (++order[c]) * 100 + c)
+        boundary_ok = false;
+    }
+    LOGP_MSG("datagrams:%zu(expected 6),boundaries and peers ok:%d(expected 1),"
+             "echoed:%zu,%zu(expected 3,3),echo ok:%d(expected 1)",
+             seen.size(), boundary_ok, echoed[0], echoed[1], echo_ok);
+  }
+
+  LOG_MSG("Reactor_Idle_Timeout_Testing");
+  {
+    // 空闲超时200ms：不发数据的连接被回收，持续发数据的连接保留
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    reactor.SetConnHandlerParams({0xE, 0xD}, {0xA});
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8197, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    ConnTimeouts timeouts;
+    timeouts.idle_timeout_ms = 200;
+    reactor.SetConnTimeouts(listen_fd, timeouts);
+    std::thread loop([&] { reactor.Run(); });
+
+    int idle = ConnectLoopback(8197);
+    int active = ConnectLoopback(8197);
+    const uint8_t ping[] = {0xE, 0xD, 0x1, 0xA};
+    bool idle_closed_early = false;
+    for (int i = 0; i < 12; ++i) { // 600ms，每50ms发一次
+      send(active, ping, sizeof(ping), MSG_NOSIGNAL);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      if (i == 1)
+        idle_closed_early = PeerClosed(idle); // 100ms时尚未超时
+    }
+    bool idle_closed = PeerClosed(idle);
+    bool active_closed = PeerClosed(active);
+    uint64_t timeouts_fired = reactor.Metrics().conn_timeouts;
+    reactor.Stop();
+    loop.join();
+    close(idle);
+    close(active);
+    LOGP_MSG("idle closed at 100ms:%d(expected 0),idle closed:%d(expected 1),"
+             "active closed:%d(expected 0),timeouts:%llu(expected 1)",
+             idle_closed_early, idle_closed, active_closed,
+             static_cast<unsigned long long>(timeouts_fired));
+  }
+
+  LOG_MSG("Reactor_Flow_Control_Pause_Resume_Testing");
+  {
+    // 单连接在途批次上限2，工作线程阻塞时暂停读取，放行后恢复并读完全部数据
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    FlowLimits limits;
+    limits.conn_max_inflight = 2;
+    reactor.SetFlowLimits(limits);
+    reactor.SetConnHandlerParams({0xE, 0xD}, {0xA});
+    std::atomic<bool> gate_open{false};
+    std::atomic<size_t> processed{0};
+    reactor.SetConnExecCallback(
+        [&](ConnId, std::vector<std::vector<uint8_t>> &packs) {
+          while (!gate_open)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          processed += packs.size();
+        });
+    std::atomic<ConnId> accepted{0};
+    reactor.SetAcceptCallback([&](ConnId conn_id) { accepted = conn_id; });
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8198, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    int client = ConnectLoopback(8198);
+    WaitFor([&] { return accepted.load() != 0; });
+    const size_t kFrames = 20;
+    const uint8_t frame[] = {0xE, 0xD, 0x1, 0xA};
+    for (size_t i = 0; i < kFrames; ++i) { // 分开写入，每次读取成一个批次
+      send(client, frame, sizeof(frame), MSG_NOSIGNAL);
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ConnStatsSnapshot paused = QueryStats(reactor, accepted.load());
+    uint64_t pauses = reactor.Metrics().read_pauses;
+
+    gate_open = true;
+    WaitFor([&] { return processed.load() == kFrames; });
+    ConnStatsSnapshot resumed = QueryStats(reactor, accepted.load());
+    reactor.Stop();
+    loop.join();
+    close(client);
+    LOGP_MSG("pauses:%llu(expected >=1),packets read while saturated:%llu"
+             "(expected <%zu),packets read after drain:%llu(expected %zu),"
+             "processed:%zu(expected %zu)",
+             static_cast<unsigned long long>(pauses),
+             static_cast<unsigned long long>(paused.packets_read), kFrames,
+             static_cast<unsigned long long>(resumed.packets_read), kFrames,
+             processed.load(), kFrames);
+  }
+
+  LOG_MSG("Poller_Spin_Backoff_Testing");
+  {
+    // 自旋落空时预算减半，自旋中命中恢复完整预算，阻塞后很快被唤醒时加倍
+    int epoll_fd = epoll_create1(0);
+    int event_fd = eventfd(0, EFD_NONBLOCK);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev);
+    PollOptions options;
+    options.spin_us = 2000;
+    AdaptivePoller poller;
+    poller.SetOptions(options);
+    std::atomic<bool> running{true};
+    epoll_event events[4];
+    uint64_t one = 1, value = 0;
+
+    // 事件在delay_us之后到达的一次等待
+    auto wait_with_delay = [&](int delay_us) {
+      std::thread writer([&] {
+        std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        (void)!write(event_fd, &one, sizeof(one));
+      });
+      poller.Wait(epoll_fd, events, 4, running);
+      writer.join();
+      (void)!read(event_fd, &value, sizeof(value));
+    };
+
+    wait_with_delay(20000); // 自旋2ms落空后阻塞，20ms后唤醒不算流量回升
+    uint64_t after_first_miss = poller.SpinBudgetUs();
+    wait_with_delay(20000);
+    uint64_t after_second_miss = poller.SpinBudgetUs();
+
+    // 事件已就绪：自旋首轮命中，预算恢复
+    (void)!write(event_fd, &one, sizeof(one));
+    poller.Wait(epoll_fd, events, 4, running);
+    (void)!read(event_fd, &value, sizeof(value));
+    uint64_t after_hit = poller.SpinBudgetUs();
+
+    // 持续落空直至退化为直接阻塞
+    int misses = 0;
+    while (poller.SpinBudgetUs() > 0 && misses < 32) {
+      wait_with_delay(5000);
+      ++misses;
+    }
+    uint64_t after_backoff = poller.SpinBudgetUs();
+    // 不再自旋：100us后到达的事件直接阻塞等待，很快被唤醒则重新开始自旋
+    wait_with_delay(100);
+    uint64_t after_quick_wake = poller.SpinBudgetUs();
+    close(event_fd);
+    close(epoll_fd);
+    LOGP_MSG("budget after misses:%llu,%llu(expected 1000,500),after hit:%llu"
+             "(expected 2000),after %d misses:%llu(expected 0),after quick "
+             "wake:%llu(expected 8)",
+             static_cast<unsigned long long>(after_first_miss),
+             static_cast<unsigned long long>(after_second_miss),
+             static_cast<unsigned long long>(after_hit), misses,
+             static_cast<unsigned long long>(after_backoff),
+             static_cast<unsigned long long>(after_quick_wake));
+  }
+
+  LOG_MSG("Reactor_Read_Budget_Fairness_Testing");
+  {
+    // 两个连接各积压64KB，读取预算4KB：两者交替推进，单个连接不会连续读完
+    const size_t kBacklog = 64 * 1024, kFrame = 64;
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    reactor.SetConnHandlerParams({0xE, 0xD}, {0xA});
+    reactor.SetReadBudget(4096);
+    std::vector<ConnId> conns;
+    std::vector<int> order; // 循环线程按读取顺序记录连接序号
+    size_t packets[2] = {0, 0};
+    reactor.SetAcceptCallback([&](ConnId conn_id) {
+      int index = static_cast<int>(conns.size());
+      conns.push_back(conn_id);
+      reactor.SetConnInlineCallback(
+          conn_id, [&, index](ConnId, std::vector<std::vector<uint8_t>> &packs) {
+            order.push_back(index);
+            packets[index] += packs.size();
+          });
+    });
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8199, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    int clients[2] = {ConnectLoopback(8199), ConnectLoopback(8199)};
+    std::atomic<size_t> accepted{0};
+    WaitFor([&] {
+      reactor.RunInLoop([&] { accepted = conns.size(); });
+      return accepted.load() == 2;
+    });
+    // 阻塞事件循环，等两个连接的数据都到达后再一起处理
+    std::atomic<bool> writes_done{false};
+    reactor.RunInLoop([&] {
+      while (!writes_done)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; i < kBacklog / kFrame; ++i) {
+      stream.insert(stream.end(), {0xE, 0xD});
+      stream.insert(stream.end(), kFrame - 3, 0x1);
+      stream.push_back(0xA);
+    }
+    for (int c = 0; c < 2; ++c)
+      send(clients[c], stream.data(), stream.size(), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writes_done = true;
+
+    const size_t kFrames = kBacklog / kFrame;
+    std::atomic<bool> drained{false};
+    WaitFor([&] {
+      reactor.RunInLoop(
+          [&] { drained = packets[0] == kFrames && packets[1] == kFrames; });
+      return drained.load();
+    });
+    uint64_t yields = reactor.Metrics().budget_yields;
+    reactor.Stop();
+    loop.join();
+    close(clients[0]);
+    close(clients[1]);
+
+    // 两个连接都有积压期间同一连接连续读取的最长次数
+    size_t done[2] = {0, 0}, longest = 0, run = 0;
+    int last = -1;
+    size_t reads[2] = {0, 0};
+    for (int index : order)
+      ++reads[index];
+    for (int index : order) {
+      if (done[0] == reads[0] || done[1] == reads[1])
+        break;
+      run = index == last ? run + 1 : 1;
+      last = index;
+      longest = std::max(longest, run);
+      ++done[index];
+    }
+    LOGP_MSG("packets:%zu,%zu(expected %zu,%zu),budget yields:%llu(expected "
+             ">0),longest run while both busy:%zu(expected <=4),reads:%zu",
+             packets[0], packets[1], kFrames, kFrames,
+             static_cast<unsigned long long>(yields), longest, order.size());
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/protocol/resp_handler.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <unordered_map>
+
+using namespace net;
+
+// 阻塞客户端连接
+int ConnectTo(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  timeval tv{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+// 按RESP数组格式编码命令
+std::string Command(std::initializer_list<std::string> args) {
+  std::string out = "*" + std::to_string(args.size()) + "\r\n";
+  for (const auto &arg : args)
+    out += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  return out;
+}
+
+// 读取直到收到期望的字节数、超时或连接关闭
+std::string ReadReply(int fd, size_t expected) {
+  std::string received;
+  char buf[65536];
+  while (received.size() < expected) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    received.append(buf, n);
+  }
+  return received;
+}
+
+// 转义换行便于单行打印
+std::string Escape(const std::string &text) {
+  std::string out;
+  for (char c : text) {
+    if (c == '\r')
+      out += "\\r";
+    else if (c == '\n')
+      out += "\\n";
+    else
+      out += c;
+  }
+  return out;
+}
+
+int main() {
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  int listen_fd =
+      SocketCreator::CreateTcpSocket("127.0.0.1", 8188, true, SOMAXCONN);
+  server.RegisterProtocol(listen_fd, nullptr, true);
+
+  // 存储只在循环线程访问，无需加锁
+  std::unordered_map<std::string, std::string> store;
+  size_t batches = 0;
+  size_t largest_batch = 0;
+  server.SetHandlerFactory(
+      listen_fd,
+      RespHandler::Factory([&](const RespBatch &batch, RespWriter &writer) {
+        batches++;
+        largest_batch = std::max(largest_batch, batch.Size());
+        for (size_t i = 0; i < batch.Size(); ++i) {
+          RespCommand cmd = batch[i];
+          if (cmd.Is("PING")) {
+            writer.SimpleString("PONG");
+          } else if (cmd.Is("ECHO") && cmd.argc == 2) {
+            writer.Bulk(cmd.Arg(1));
+          } else if (cmd.Is("SET") && cmd.argc == 3) {
+            store[std::string(cmd.Arg(1))] = std::string(cmd.Arg(2));
+            writer.SimpleString("OK");
+          } else if (cmd.Is("GET") && cmd.argc == 2) {
+            auto it = store.find(std::string(cmd.Arg(1)));
+            if (it == store.end())
+              writer.Null();
+            else
+              writer.Bulk(it->second);
+          } else if (cmd.Is("HELLO")) {
+            writer.SetProtocol(cmd.Arg(1) == "3" ? 3 : 2);
+            writer.MapHeader(1);
+            writer.Bulk("proto");
+            writer.Integer(writer.Protocol());
+          } else if (cmd.Is("QUIT")) {
+            writer.SimpleString("OK");
+            writer.CloseAfterReply();
+          } else {
+            writer.Error("ERR unknown command '" + std::string(cmd.Name()) +
+                         "'");
+          }
+        }
+      }));
+  std::thread server_thread([&] { server.Run(); });
+
+  LOG_MSG("Resp_Pipeline_Testing");
+  int fd = ConnectTo(8188);
+  std::string pipeline;
+  for (int i = 0; i < 100; ++i)
+    pipeline += Command({"SET", "key:" + std::to_string(i), std::to_string(i)});
+  pipeline += Command({"GET", "key:42"});
+  send(fd, pipeline.data(), pipeline.size(), MSG_NOSIGNAL);
+  std::string reply = ReadReply(fd, 100 * 5 + 8);
+  LOGP_MSG("pipeline reply bytes:%lu,tail:%s", reply.size(),
+           Escape(reply.substr(reply.size() - 8)).c_str());
+  LOGP_MSG("batches:%lu,largest batch:%lu", batches, largest_batch);
+
+  LOG_MSG("Resp_Split_Testing");
+  // 命令跨多次发送到达
+  std::string split = Command({"ECHO", "hello world"});
+  send(fd, split.data(), 10, MSG_NOSIGNAL);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  send(fd, split.data() + 10, split.size() - 10, MSG_NOSIGNAL);
+  LOGP_MSG("echo reply:%s", Escape(ReadReply(fd, 18)).c_str());
+
+  LOG_MSG("Resp_Inline_And_Resp3_Testing");
+  std::string inline_cmds = "PING\r\nGET missing\r\n" + Command({"HELLO", "3"}) +
+                            Command({"GET", "missing"}) +
+                            Command({"FLUSHALL"});
+  send(fd, inline_cmds.data(), inline_cmds.size(), MSG_NOSIGNAL);
+  LOGP_MSG("replies:%s", Escape(ReadReply(fd, 66)).c_str());
+
+  LOG_MSG("Resp_Quit_Testing");
+  std::string quit = Command({"QUIT"});
+  send(fd, quit.data(), quit.size(), MSG_NOSIGNAL);
+  LOGP_MSG("quit reply:%s", Escape(ReadReply(fd, 5)).c_str());
+  char tail;
+  LOGP_MSG("closed after quit:%d", recv(fd, &tail, 1, 0) == 0);
+  close(fd);
+
+  LOG_MSG("Resp_Protocol_Error_Testing");
+  fd = ConnectTo(8188);
+  std::string bad = Command({"PING"}) + "*1\r\n+x\r\n";
+  send(fd, bad.data(), bad.size(), MSG_NOSIGNAL);
+  LOGP_MSG("error reply:%s", Escape(ReadReply(fd, 64)).c_str());
+  close(fd);
+
+  server.Stop();
+  server_thread.join();
+  return 0;
+}
@@ -46,10 +46,11 @@ void General_IO_Testing() {
 
   // 环绕读写测试
   containers::RingBuffer ring_buffer_3(5);
-  ring_buffer_3.Write({1, 2, 3, 4, 5});
+  std::vector<uint8_t> wrap_out(3);
+  ring_buffer_3.Write(std::vector<uint8_t>{1, 2, 3, 4, 5});
   ring_buffer_3.PrintBuffer();
-  ring_buffer_3.Read(out, 3);
-  ring_buffer_3.Write({6, 7, 8});
+  ring_buffer_3.Read(wrap_out, 3);
+  ring_buffer_3.Write(std::vector<uint8_t>{6, 7, 8});
   ring_buffer_3.PrintBuffer();
 };
 
@@ -68,8 +69,45 @@ void General_Fullempty_Testing() {
            ring_buffer.IsFull() * 100, ring_buffer.Usage());
 };
 
+void General_Resize_Testing() {
+  LOG_MSG("General_Resize_Testing");
+  containers::RingBuffer ring_buffer(5);
+  std::vector<uint8_t> out(5);
+
+  // 环回状态下扩容，数据顺序保持不变
+  ring_buffer.Write(std::vector<uint8_t>{1, 2, 3, 4});
+  ring_buffer.Read(out, 3);
+  ring_buffer.Write(std::vector<uint8_t>{5, 6, 7});
+  LOGP_MSG("resize ret:%d(expected 8)", ring_buffer.Resize(8));
+  ring_buffer.Write(std::vector<uint8_t>{8, 9});
+  ring_buffer.PrintBuffer();
+
+  // 小于已有数据时拒绝收缩
+  LOGP_MSG("resize ret:%d(expected 8)", ring_buffer.Resize(3));
+  ring_buffer.Read(out, 4);
+  LOGP_MSG("resize ret:%d(expected 3)", ring_buffer.Resize(3));
+  ring_buffer.PrintBuffer();
+};
+
+void General_Linearize_Testing() {
+  LOG_MSG("General_Linearize_Testing");
+  containers::RingBuffer ring_buffer(6);
+  std::vector<uint8_t> out(6);
+
+  // 环回数据原地线性化后可一次线性读取
+  ring_buffer.Write(std::vector<uint8_t>{1, 2, 3, 4, 5});
+  ring_buffer.Read(out, 4);
+  ring_buffer.Write(std::vector<uint8_t>{6, 7, 8});
+  ring_buffer.Linearize();
+  auto [data, len] = ring_buffer.GetLinearReadSpace();
+  LOGP_MSG("linear read len:%lu,first:%d,last:%d(expected 4,5,8)", len, data[0], data[len - 1]);
+  ring_buffer.PrintBuffer();
+};
+
 int main(int argc, char const *argv[]) {
   General_IO_Testing();
   General_Fullempty_Testing();
+  General_Resize_Testing();
+  General_Linearize_Testing();
   return 0;
 }
@@ -0,0 +1,145 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/rpc/rpc_client.hpp"
+#include "../../include/net/rpc/rpc_server.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <future>
+
+using namespace net;
+
+enum Method : uint16_t { kEcho = 1, kSlowEcho = 2, kThrow = 3, kCloseConn = 4 };
+
+struct CallResult {
+  RpcStatus status;
+  std::string payload;
+};
+
+// 阻塞等待调用完成
+CallResult CallSync(RpcClient &client, uint16_t method, std::string payload,
+                    uint64_t timeout_ms = 0) {
+  auto promise = std::make_shared<std::promise<CallResult>>();
+  auto future = promise->get_future();
+  client.Call(
+      method, std::move(payload),
+      [promise](RpcStatus status, std::string_view payload) {
+        promise->set_value(CallResult{status, std::string(payload)});
+      },
+      timeout_ms);
+  return future.get();
+}
+
+int main() {
+  auto pool = std::make_unique<ThreadPool>(4);
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  RpcServer rpc_server(server, pool.get());
+  rpc_server.Register(kEcho, [](const RpcRequest &request,
+                                std::string &response) {
+    response.assign(request.payload.data(), request.payload.size());
+  });
+  rpc_server.Register(kSlowEcho, [](const RpcRequest &request,
+                                    std::string &response) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(
+        std::stoi(std::string(request.payload))));
+    response = "slept " + std::string(request.payload);
+  });
+  rpc_server.Register(kThrow, [](const RpcRequest &, std::string &) {
+    throw std::runtime_error("bad argument");
+  });
+  rpc_server.Register(kCloseConn, [&server](const RpcRequest &request,
+                                         std::string &) {
+    server.Close(request.conn_id);
+  });
+  int listen_fd =
+      SocketCreator::CreateTcpSocket("127.0.0.1", 8190, true, SOMAXCONN);
+  server.RegisterProtocol(listen_fd, nullptr, true);
+  std::thread server_thread([&] { server.Run(); });
+
+  ReactorCore client_loop;
+  client_loop.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  RpcClient client(client_loop);
+  std::thread client_thread([&] { client_loop.Run(); });
+  std::promise<int> connected;
+  client.Connect("127.0.0.1", 8190,
+                 [&](ConnId, int error) { connected.set_value(error); });
+  LOGP_MSG("connect error:%d", connected.get_future().get());
+
+  LOG_MSG("Rpc_Call_Testing");
+  CallResult result = CallSync(client, kEcho, "hello rpc");
+  LOGP_MSG("echo status:%d,payload:%s", static_cast<int>(result.status),
+           result.payload.c_str());
+  result = CallSync(client, 99, "x");
+  LOGP_MSG("unknown method status:%d", static_cast<int>(result.status));
+  result = CallSync(client, kThrow, "x");
+  LOGP_MSG("throw status:%d,payload:%s", static_cast<int>(result.status),
+           result.payload.c_str());
+
+  LOG_MSG("Rpc_Out_Of_Order_Testing");
+  // 同一连接上慢调用先发，快调用先完成
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  std::promise<void> both_done;
+  std::atomic<int> remaining{2};
+  auto record = [&](RpcStatus, std::string_view payload) {
+    {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.emplace_back(payload);
+    }
+    if (--remaining == 0)
+      both_done.set_value();
+  };
+  client.Call(kSlowEcho, "100", record);
+  client.Call(kEcho, "fast", record);
+  both_done.get_future().get();
+  LOGP_MSG("completion order:%s,%s", order[0].c_str(), order[1].c_str());
+
+  LOG_MSG("Rpc_Deadline_Testing");
+  result = CallSync(client, kSlowEcho, "300", 50);
+  LOGP_MSG("deadline status:%d,payload:%s", static_cast<int>(result.status),
+           result.payload.c_str());
+
+  LOG_MSG("Rpc_Pipeline_Testing");
+  // 单连接深度流水线
+  const int kCalls = 200000;
+  std::atomic<int> ok{0};
+  std::atomic<int> done{0};
+  std::promise<void> all_done;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kCalls; ++i) {
+    client.Call(kEcho, std::to_string(i),
+                [&, i](RpcStatus status, std::string_view payload) {
+                  if (status == RpcStatus::kOk &&
+                      payload == std::to_string(i))
+                    ok++;
+                  if (++done == kCalls)
+                    all_done.set_value();
+                });
+  }
+  all_done.get_future().get();
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  LOGP_MSG("pipelined calls ok:%d/%d in %ldms (%.0f calls/s)", ok.load(),
+           kCalls, elapsed_ms, kCalls * 1000.0 / std::max<long>(elapsed_ms, 1));
+
+  LOG_MSG("Rpc_Disconnect_Testing");
+  // 服务端断开时未完成的调用以kDisconnected完成
+  auto pending = std::make_shared<std::promise<CallResult>>();
+  client.Call(kSlowEcho, "200",
+              [pending](RpcStatus status, std::string_view payload) {
+                pending->set_value(CallResult{status, std::string(payload)});
+              });
+  client.Call(kCloseConn, "", [](RpcStatus, std::string_view) {});
+  result = pending->get_future().get();
+  LOGP_MSG("pending status:%d,payload:%s", static_cast<int>(result.status),
+           result.payload.c_str());
+  result = CallSync(client, kEcho, "after close");
+  LOGP_MSG("after close status:%d", static_cast<int>(result.status));
+
+  client_loop.Stop();
+  client_thread.join();
+  server.Stop();
+  server_thread.join();
+  // 等待仍在执行的方法结束后再析构服务端
+  pool.reset();
+  return 0;
+}
@@ -0,0 +1,309 @@
+#include "../../include/logger/logger.hpp"
+#include "../../include/net/core/packet_dispatcher.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+using namespace net;
+
+// 包格式: 键4 序号4
+std::vector<uint8_t> MakePack(uint32_t key, uint32_t seq) {
+  std::vector<uint8_t> pack(8);
+  memcpy(pack.data(), &key, 4);
+  memcpy(pack.data() + 4, &seq, 4);
+  return pack;
+}
+
+void ParsePack(const std::vector<uint8_t> &pack, uint32_t &key,
+               uint32_t &seq) {
+  memcpy(&key, pack.data(), 4);
+  memcpy(&seq, pack.data() + 4, 4);
+}
+
+struct CountingTracker : BatchTracker {
+  std::atomic<uint64_t> done{0};
+  void OnBatchDone() override { done++; }
+};
+
+struct OrderResult {
+  uint64_t packs = 0;
+  uint64_t out_of_order = 0;
+  uint64_t overlapped = 0; // 同一键被两个线程同时执行
+  uint64_t stalls = 0;
+  double ms = 0;
+};
+
+// 每个连接连续派发批次，批内每包携带该连接递增序号
+OrderResult RunConnOrder(DispatchPolicy policy) {
+  const uint32_t kConns = 64;
+  const uint32_t kBatches = 2000;
+  const uint32_t kPacksPerBatch = 4;
+  std::vector<std::atomic<uint32_t>> next(kConns);
+  std::vector<std::atomic<bool>> busy(kConns);
+  std::atomic<uint64_t> out_of_order{0}, overlapped{0}, packs{0};
+  auto cb = std::make_shared<const ConnExecCb>(
+      [&](ConnId conn_id, std::vector<std::vector<uint8_t>> &batch) {
+        if (busy[conn_id].exchange(true))
+          overlapped++;
+        for (const auto &pack : batch) {
+          uint32_t key, seq;
+          ParsePack(pack, key, seq);
+          if (next[key].exchange(seq + 1) != seq)
+            out_of_order++;
+        }
+        packs += batch.size();
+        busy[conn_id].store(false);
+      });
+
+  OrderResult result;
+  auto start = std::chrono::steady_clock::now();
+  {
+    PacketDispatcher dispatcher(4, 64);
+    dispatcher.SetPolicy(policy);
+    uint32_t seq = 0;
+    for (uint32_t b = 0; b < kBatches; ++b, seq += kPacksPerBatch) {
+      for (uint32_t c = 0; c < kConns; ++c) {
+        PacketBatch batch;
+        batch.conn_id = c;
+        batch.conn_cb = cb;
+        for (uint32_t p = 0; p < kPacksPerBatch; ++p)
+          batch.packs.push_back(MakePack(c, seq + p));
+        dispatcher.Dispatch(std::move(batch));
+      }
+    }
+    result.stalls = dispatcher.ShardStalls();
+  }
+  result.ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  result.packs = packs.load();
+  result.out_of_order = out_of_order.load();
+  result.overlapped = overlapped.load();
+  return result;
+}
+
+int main() {
+  LOG_MSG("Dispatch_RoundRobin_Order_Testing");
+  OrderResult rr = RunConnOrder(DispatchPolicy::kRoundRobin);
+  LOGP_MSG("round robin packs:%llu,out of order:%llu,overlapped:%llu in %.0fms",
+           static_cast<unsigned long long>(rr.packs),
+           static_cast<unsigned long long>(rr.out_of_order),
+           static_cast<unsigned long long>(rr.overlapped), rr.ms);
+
+  LOG_MSG("Dispatch_ShardByConn_Order_Testing");
+  OrderResult sharded = RunConnOrder(DispatchPolicy::kShardByConn);
+  LOGP_MSG("shard by conn packs:%llu,out of order:%llu,overlapped:%llu,"
+           "stalls:%llu in %.0fms",
+           static_cast<unsigned long long>(sharded.packs),
+           static_cast<unsigned long long>(sharded.out_of_order),
+           static_cast<unsigned long long>(sharded.overlapped),
+           static_cast<unsigned long long>(sharded.stalls), sharded.ms);
+
+  LOG_MSG("Dispatch_ShardByKey_Testing");
+  {
+    // 少量连接上复用大量会话，按会话键路由，会话状态按分片存放且不加锁
+    const uint32_t kConns = 3;
+    const uint32_t kSessions = 256;
+    const uint32_t kBatches = 20000;
+    const size_t kWorkers = 4;
+    std::vector<std::unordered_map<uint32_t, uint32_t>> session_next(kWorkers);
+    std::atomic<uint64_t> out_of_order{0}, wrong_shard{0}, packs{0};
+    auto tracker = std::make_shared<CountingTracker>();
+    std::unique_ptr<PacketDispatcher> dispatcher =
+        std::make_unique<PacketDispatcher>(kWorkers, 256);
+    PacketDispatcher *raw = dispatcher.get();
+    raw->SetPolicy(DispatchPolicy::kShardByKey,
+                   [](ConnId, const uint8_t *data, size_t) {
+                     uint32_t key;
+                     memcpy(&key, data, 4);
+                     return static_cast<uint64_t>(key);
+                   });
+    auto cb = std::make_shared<const ConnExecCb>(
+        [&](ConnId, std::vector<std::vector<uint8_t>> &batch) {
+          size_t shard = raw->CurrentShard();
+          auto &state = session_next[shard];
+          for (const auto &pack : batch) {
+            uint32_t key, seq;
+            ParsePack(pack, key, seq);
+            if (raw->ShardOf(key) != shard)
+              wrong_shard++;
+            uint32_t &expected = state[key];
+            if (seq != expected)
+              out_of_order++;
+            expected = seq + 1;
+          }
+          packs += batch.size();
+        });
+
+    std::vector<uint32_t> seq(kSessions, 0);
+    uint32_t rng = 12345;
+    uint64_t sent = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < kBatches; ++b) {
+      PacketBatch batch;
+      batch.conn_id = b % kConns;
+      batch.conn_cb = cb;
+      batch.tracker = tracker;
+      size_t count = 1 + b % 8;
+      for (size_t p = 0; p < count; ++p) {
+        rng = rng * 1103515245 + 12345;
+        uint32_t session = (rng >> 8) % kSessions;
+        batch.packs.push_back(MakePack(session, seq[session]++));
+      }
+      sent += count;
+      dispatcher->Dispatch(std::move(batch));
+    }
+    uint64_t stalls = dispatcher->ShardStalls();
+    dispatcher.reset();
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOGP_MSG("shard by key packs:%llu/%llu,out of order:%llu,wrong shard:%llu,"
+             "tracker done:%llu/%u,stalls:%llu in %.0fms",
+             static_cast<unsigned long long>(packs.load()),
+             static_cast<unsigned long long>(sent),
+             static_cast<unsigned long long>(out_of_order.load()),
+             static_cast<unsigned long long>(wrong_shard.load()),
+             static_cast<unsigned long long>(tracker->done.load()), kBatches,
+             static_cast<unsigned long long>(stalls), ms);
+  }
+
+  LOG_MSG("Dispatch_Redispatch_Backlog_Testing");
+  {
+    // 工作线程执行批次时向自身分片再派发，分片队列中已有积压：再派发的批次
+    // 排在积压批次之后执行，不与当前批次交错
+    const uint32_t kBacklog = 9;
+    std::unique_ptr<PacketDispatcher> dispatcher =
+        std::make_unique<PacketDispatcher>(1, 64);
+    PacketDispatcher *raw = dispatcher.get();
+    raw->SetPolicy(DispatchPolicy::kShardByConn);
+    std::vector<uint32_t> order; // 仅工作线程写入
+    std::atomic<bool> backlog_ready{false};
+    size_t backlog_seen = 0;
+    int depth = 0, nested = 0;
+    std::shared_ptr<const ConnExecCb> cb;
+    cb = std::make_shared<const ConnExecCb>(
+        [&](ConnId conn_id, std::vector<std::vector<uint8_t>> &batch) {
+          if (depth++ != 0)
+            nested++;
+          for (const auto &pack : batch) {
+            uint32_t key, seq;
+            ParsePack(pack, key, seq);
+            order.push_back(seq);
+            if (seq != 0)
+              continue;
+            while (!backlog_ready.load())
+              std::this_thread::yield();
+            backlog_seen = raw->QueueDepthApprox();
+            PacketBatch again;
+            again.conn_id = conn_id;
+            again.conn_cb = cb;
+            again.packs.push_back(MakePack(key, 100));
+            raw->Dispatch(std::move(again));
+          }
+          depth--;
+        });
+
+    PacketBatch first;
+    first.conn_id = 0;
+    first.conn_cb = cb;
+    first.packs.push_back(MakePack(0, 0));
+    first.packs.push_back(MakePack(0, 1));
+    raw->Dispatch(std::move(first));
+    for (uint32_t b = 0; b < kBacklog; ++b) {
+      PacketBatch batch;
+      batch.conn_id = 0;
+      batch.conn_cb = cb;
+      batch.packs.push_back(MakePack(0, 2 + b));
+      raw->Dispatch(std::move(batch));
+    }
+    backlog_ready = true;
+    dispatcher.reset();
+
+    std::vector<uint32_t> expected = {0, 1};
+    for (uint32_t b = 0; b < kBacklog; ++b)
+      expected.push_back(2 + b);
+    expected.push_back(100);
+    LOGP_MSG("order ok:%d(expected 1),nested runs:%d(expected 0),"
+             "backlog at re-dispatch:%zu(expected %u)",
+             order == expected, nested, backlog_seen, kBacklog);
+  }
+
+  LOG_MSG("Dispatch_Mutual_Forward_Testing");
+  {
+    // 两个工作线程、队列容量1，回调中互相向对方分片扇出转发：队列满时
+    // 工作线程不等待对方出队，转入溢出队列，全部批次执行完毕
+    const uint32_t kSeeds = 8, kHops = 6, kFanout = 3;
+    std::unique_ptr<PacketDispatcher> dispatcher =
+        std::make_unique<PacketDispatcher>(2, 1);
+    PacketDispatcher *raw = dispatcher.get();
+    raw->SetPolicy(DispatchPolicy::kShardByConn);
+    ConnId conns[2] = {0, 0};
+    for (ConnId id = 1; conns[0] == 0 || conns[1] == 0; ++id)
+      if (conns[raw->ShardOf(id)] == 0)
+        conns[raw->ShardOf(id)] = id;
+    std::atomic<uint64_t> runs{0}, wrong_shard{0};
+    std::shared_ptr<const ConnExecCb> cb;
+    cb = std::make_shared<const ConnExecCb>(
+        [&](ConnId conn_id, std::vector<std::vector<uint8_t>> &batch) {
+          size_t shard = raw->CurrentShard();
+          if (conns[shard] != conn_id)
+            wrong_shard++;
+          uint32_t key, hops;
+          ParsePack(batch.front(), key, hops);
+          runs++;
+          for (uint32_t i = 0; hops != 0 && i < kFanout; ++i) {
+            PacketBatch forward;
+            forward.conn_id = conns[1 - shard];
+            forward.conn_cb = cb;
+            forward.packs.push_back(MakePack(key, hops - 1));
+            raw->Dispatch(std::move(forward));
+          }
+        });
+
+    uint64_t expected = 0, level = 1;
+    for (uint32_t h = 0; h <= kHops; ++h, level *= kFanout)
+      expected += level;
+    expected *= kSeeds;
+    for (uint32_t s = 0; s < kSeeds; ++s) {
+      PacketBatch seed;
+      seed.conn_id = conns[s & 1];
+      seed.conn_cb = cb;
+      seed.packs.push_back(MakePack(s, kHops));
+      raw->Dispatch(std::move(seed));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (runs.load() != expected &&
+           std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    uint64_t overflows = raw->ShardOverflows();
+    bool finished = runs.load() == expected;
+    if (finished)
+      dispatcher.reset();
+    LOGP_MSG("forwarded runs:%llu(expected %llu),wrong shard:%llu(expected 0),"
+             "overflows:%llu(expected >0)",
+             static_cast<unsigned long long>(runs.load()),
+             static_cast<unsigned long long>(expected),
+             static_cast<unsigned long long>(wrong_shard.load()),
+             static_cast<unsigned long long>(overflows));
+    if (!finished) {
+      dispatcher.release(); // 工作线程互相等待，无法回收
+      return 1;
+    }
+  }
+
+  LOG_MSG("Dispatch_ShardDistribution_Testing");
+  {
+    // 连接ID高位为代数，低位为fd，检查分布是否均匀
+    PacketDispatcher dispatcher(8);
+    std::vector<size_t> hits(dispatcher.WorkerCount(), 0);
+    for (int fd = 3; fd < 10003; ++fd)
+      hits[dispatcher.ShardOf(MakeConnId(fd, fd % 7))]++;
+    size_t lo = *std::min_element(hits.begin(), hits.end());
+    size_t hi = *std::max_element(hits.begin(), hits.end());
+    LOGP_MSG("8 shards over 10000 conns min:%zu max:%zu,main is no shard:%d",
+             lo, hi, dispatcher.CurrentShard() == PacketDispatcher::kNoShard);
+  }
+  return 0;
+}
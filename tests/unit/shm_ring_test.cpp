@@ -0,0 +1,202 @@
+#include "../../include/containers/shm_ring.hpp"
+#include <sys/wait.h>
+
+using namespace containers;
+
+struct Message {
+  uint32_t producer;
+  uint32_t seq;
+};
+
+// 子进程不写日志，以退出码返回结果
+template <typename F> pid_t Spawn(F &&body) {
+  pid_t pid = fork();
+  if (pid == 0)
+    _exit(body() ? 0 : 1);
+  return pid;
+}
+
+bool Reap(pid_t pid) {
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main() {
+  LOG_MSG("ShmRing_Spsc_Testing");
+  {
+    // 变长消息跨进程传递，校验顺序与内容
+    const uint32_t kCount = 2000000;
+    auto ring = ShmRing::Create("spsc", 1 << 20);
+    int fd = ring->Fd();
+    pid_t consumer = Spawn([fd, kCount] {
+      auto peer = ShmRing::Attach(dup(fd));
+      uint32_t expected = 0;
+      bool ok = true;
+      while (expected < kCount) {
+        peer->Wait(1000);
+        peer->Poll([&](const uint8_t *data, size_t size) {
+          Message message;
+          memcpy(&message, data, sizeof(message));
+          if (message.seq != expected ||
+              size != sizeof(Message) + expected % 64 ||
+              (size > sizeof(Message) &&
+               data[size - 1] != static_cast<uint8_t>(expected)))
+            ok = false;
+          expected++;
+        });
+      }
+      return ok;
+    });
+
+    uint8_t payload[sizeof(Message) + 64];
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kCount; ++i) {
+      Message message{0, i};
+      memcpy(payload, &message, sizeof(message));
+      size_t size = sizeof(Message) + i % 64;
+      if (size > sizeof(Message))
+        payload[size - 1] = static_cast<uint8_t>(i);
+      ring->Write(payload, size);
+    }
+    bool ok = Reap(consumer);
+    double ms = ElapsedMs(start);
+    LOGP_MSG("spsc %u messages ok:%d in %.0fms (%.1f M msgs/s)", kCount, ok,
+             ms, kCount / ms / 1000.0);
+  }
+
+  LOG_MSG("ShmRing_Mpsc_Testing");
+  {
+    // 多个生产者进程，消费者校验每个生产者内的顺序
+    const uint32_t kProducers = 4;
+    const uint32_t kPerProducer = 500000;
+    auto ring = ShmRing::Create("mpsc", 1 << 16, ShmRingMode::kMpsc);
+    int fd = ring->Fd();
+    std::vector<pid_t> producers;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t p = 0; p < kProducers; ++p) {
+      producers.push_back(Spawn([fd, p, kPerProducer] {
+        auto peer = ShmRing::Attach(dup(fd));
+        for (uint32_t i = 0; i < kPerProducer; ++i) {
+          Message message{p, i};
+          if (!peer->Write(&message, sizeof(message), 5000))
+            return false;
+        }
+        return true;
+      }));
+    }
+    std::vector<uint32_t> next(kProducers, 0);
+    uint32_t received = 0;
+    bool ordered = true;
+    while (received < kProducers * kPerProducer) {
+      if (!ring->Wait(5000))
+        break;
+      received += ring->Poll([&](const uint8_t *data, size_t) {
+        Message message;
+        memcpy(&message, data, sizeof(message));
+        if (message.producer >= kProducers ||
+            message.seq != next[message.producer]++)
+          ordered = false;
+      });
+    }
+    bool ok = true;
+    for (pid_t pid : producers)
+      ok = Reap(pid) && ok;
+    double ms = ElapsedMs(start);
+    LOGP_MSG("mpsc received:%u/%u ordered:%d producers ok:%d in %.0fms "
+             "(%.1f M msgs/s)",
+             received, kProducers * kPerProducer, ordered, ok, ms,
+             received / ms / 1000.0);
+  }
+
+  LOG_MSG("ShmRing_Latency_Testing");
+  {
+    // 两个环往返；多核时对端忙轮询，单核时短暂自旋后futex等待
+    const int kRounds = 100000;
+    const int spins = std::thread::hardware_concurrency() > 1 ? 1 << 20 : 0;
+    auto ping = ShmRing::Create("ping", 1 << 16);
+    auto pong = ShmRing::Create("pong", 1 << 16);
+    int ping_fd = ping->Fd(), pong_fd = pong->Fd();
+    auto wait = [spins](ShmRing &ring) {
+      for (int i = 0; i < spins && !ring.HasData(); ++i)
+        ;
+      ring.Wait();
+    };
+    pid_t echo = Spawn([&, ping_fd, pong_fd] {
+      auto in = ShmRing::Attach(dup(ping_fd));
+      auto out = ShmRing::Attach(dup(pong_fd));
+      for (int done = 0; done < kRounds;) {
+        wait(*in);
+        done += in->Poll([&](const uint8_t *data, size_t size) {
+          out->TryWrite(data, size);
+        });
+      }
+      return true;
+    });
+    uint64_t value = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+      ping->TryWrite(&value, sizeof(value));
+      wait(*pong);
+      pong->Poll([&](const uint8_t *data, size_t) {
+        memcpy(&value, data, sizeof(value));
+      });
+      value++;
+    }
+    double ms = ElapsedMs(start);
+    bool ok = Reap(echo);
+    LOGP_MSG("%s round trips:%llu ok:%d avg one-way %.0fns",
+             spins ? "busy poll" : "futex", static_cast<unsigned long long>(value),
+             ok, ms * 1e6 / kRounds / 2);
+  }
+
+  LOG_MSG("ShmRing_Named_Testing");
+  {
+    const std::string name = "/nebula_shm_ring_test";
+    auto writer = ShmRing::Create(name, 4096);
+    auto reader = ShmRing::Open(name);
+    ShmRing::Unlink(name);
+    const char text[] = "hello shm";
+    writer->TryWrite(text, sizeof(text));
+    std::vector<uint8_t> out;
+    bool read = reader && reader->TryRead(out);
+    LOGP_MSG("named read:%d,text:%s,capacity:%zu", read,
+             read ? reinterpret_cast<const char *>(out.data()) : "",
+             reader ? reader->Capacity() : 0);
+    // 消息跨越数据区末尾仍连续
+    std::vector<uint8_t> big(3000, 0xab);
+    writer->TryWrite(big.data(), big.size());
+    writer->TryWrite(big.data(), big.size());
+    bool full = !writer->TryWrite(big.data(), big.size());
+    reader->TryRead(out);
+    bool wrapped = writer->TryWrite(big.data(), big.size());
+    reader->TryRead(out);
+    reader->TryRead(out);
+    LOGP_MSG("full:%d,wrapped write:%d,wrapped read size:%zu,last:0x%x",
+             full, wrapped, out.size(), out.back());
+  }
+
+  LOG_MSG("ShmRing_EventFd_Testing");
+  {
+    auto ring = ShmRing::Create("eventfd", 4096);
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ring->SetNotifyFd(event_fd);
+    uint64_t signals = 0;
+    bool armed = ring->ArmNotify();
+    uint64_t value = 7;
+    ring->TryWrite(&value, sizeof(value));
+    ring->TryWrite(&value, sizeof(value)); // 已唤醒过，不再写eventfd
+    ssize_t n = read(event_fd, &signals, sizeof(signals));
+    LOGP_MSG("armed:%d,eventfd read:%zd,signals:%llu,pending:%zu", armed, n,
+             static_cast<unsigned long long>(signals),
+             ring->Poll([](const uint8_t *, size_t) {}));
+    close(event_fd);
+  }
+  return 0;
+}
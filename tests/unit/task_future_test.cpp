@@ -0,0 +1,177 @@
+#include "../../include/logger/logger.hpp"
+#include "../../include/threading/thread_pool.hpp"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main() {
+  ThreadPool pool(4);
+
+  LOG_MSG("Submit_Typed_Testing");
+  {
+    auto sum = pool.Submit([](int a, int b) { return a + b; }, 40, 2);
+    auto text = pool.Submit(
+        [](const std::string &name) { return "hello " + name; }, "pool");
+    std::atomic<bool> ran{false};
+    auto done = pool.Submit([&] { ran = true; });
+    // 只可移动的参数与返回值
+    auto boxed = pool.Submit(
+        [](std::unique_ptr<int> value) {
+          *value *= 2;
+          return value;
+        },
+        std::make_unique<int>(21));
+    int sum_value = sum.Get();
+    std::string text_value = text.Get();
+    done.Get();
+    std::unique_ptr<int> boxed_value = boxed.Get();
+    LOGP_MSG("sum:%d,text:%s,void ran:%d,boxed:%d,valid after get:%d",
+             sum_value, text_value.c_str(), ran.load(), *boxed_value,
+             sum.Valid());
+  }
+
+  LOG_MSG("Submit_Lvalue_Callable_Testing");
+  {
+    // 具名的可调用对象按拷贝保存，调用方的对象保持可用
+    auto scale = [factor = 3](int value) { return value * factor; };
+    std::function<std::string(int)> format = [](int value) {
+      return std::to_string(value);
+    };
+    const auto constant = [] { return 7; };
+    auto scaled = pool.Submit(scale, 14);
+    auto formatted = pool.Submit(format, 42);
+    auto seven = pool.Submit(constant);
+    int scaled_value = scaled.Get();
+    std::string formatted_value = formatted.Get();
+    LOGP_MSG("scaled:%d(expected 42),formatted:%s(expected 42),const:%d"
+             "(expected 7),caller copy still callable:%d(expected 1)",
+             scaled_value, formatted_value.c_str(), seven.Get(),
+             format(1) == "1" && scale(1) == 3);
+  }
+
+  LOG_MSG("Submit_Exception_Testing");
+  {
+    auto failed = pool.Submit([]() -> int {
+      throw std::runtime_error("task failed");
+    });
+    std::string message;
+    try {
+      failed.Get();
+    } catch (const std::runtime_error &e) {
+      message = e.what();
+    }
+    LOGP_MSG("propagated:%s", message.c_str());
+  }
+
+  LOG_MSG("Then_Chain_Testing");
+  {
+    auto chained = pool.Submit([] { return 6; })
+                       .Then([](int v) { return v * 7; })
+                       .Then([](int v) { return std::to_string(v) + "!"; });
+    LOGP_MSG("chained:%s", chained.Get().c_str());
+
+    // 异常跳过后续续体，传递到链尾
+    std::atomic<int> skipped_runs{0};
+    auto broken = pool.Submit([]() -> int { throw std::logic_error("bad"); })
+                      .Then([&](int v) {
+                        skipped_runs++;
+                        return v + 1;
+                      });
+    std::string message;
+    try {
+      broken.Get();
+    } catch (const std::logic_error &e) {
+      message = e.what();
+    }
+    // 已就绪的任务上挂续体，立即在调用线程执行
+    auto ready = pool.Submit([] { return 1; });
+    ready.Wait();
+    auto caller = std::this_thread::get_id();
+    bool inline_run = false;
+    ready.Then([&](int) { inline_run = std::this_thread::get_id() == caller; })
+        .Get();
+    LOGP_MSG("error after then:%s,continuation runs:%d,ready then inline:%d",
+             message.c_str(), skipped_runs.load(), inline_run);
+  }
+
+  LOG_MSG("WhenAll_Testing");
+  {
+    // 扇入汇总，不对每个任务阻塞get
+    const int kTasks = 10000;
+    std::vector<TaskFuture<uint64_t>> parts;
+    for (int i = 0; i < kTasks; ++i)
+      parts.push_back(pool.Submit([i] { return static_cast<uint64_t>(i); }));
+    auto total = WhenAll(std::move(parts)).Then([](std::vector<uint64_t> v) {
+      uint64_t sum = 0;
+      for (uint64_t x : v)
+        sum += x;
+      return sum;
+    });
+    LOGP_MSG("when all sum:%llu (expected %llu)",
+             static_cast<unsigned long long>(total.Get()),
+             static_cast<unsigned long long>(uint64_t(kTasks) * (kTasks - 1) /
+                                             2));
+
+    std::atomic<int> finished{0};
+    std::vector<TaskFuture<void>> steps;
+    for (int i = 0; i < 8; ++i)
+      steps.push_back(pool.Submit([&, i] {
+        if (i == 5)
+          throw std::runtime_error("step 5");
+        finished++;
+      }));
+    std::string message;
+    try {
+      WhenAll(std::move(steps)).Get();
+    } catch (const std::runtime_error &e) {
+      message = e.what();
+    }
+    bool empty_ready = WhenAll(std::vector<TaskFuture<int>>()).Ready();
+    LOGP_MSG("void when all error:%s,others finished:%d,empty ready:%d",
+             message.c_str(), finished.load(), empty_ready);
+  }
+
+  LOG_MSG("Submit_Throughput_Testing");
+  {
+    // 与std::packaged_task+std::future逐个get对比
+    const int kTasks = 200000;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TaskFuture<int>> futures;
+    futures.reserve(kTasks);
+    for (int i = 0; i < kTasks; ++i)
+      futures.push_back(pool.Submit([i] { return i & 1; }));
+    int odd = 0;
+    for (int v : WhenAll(std::move(futures)).Get())
+      odd += v;
+    double submit_ms = ElapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::future<int>> std_futures;
+    std_futures.reserve(kTasks);
+    for (int i = 0; i < kTasks; ++i) {
+      auto task =
+          std::make_shared<std::packaged_task<int()>>([i] { return i & 1; });
+      std_futures.push_back(task->get_future());
+      pool.PostTask([task]() -> size_t {
+        (*task)();
+        return 0;
+      });
+    }
+    int std_odd = 0;
+    for (auto &future : std_futures)
+      std_odd += future.get();
+    double std_ms = ElapsedMs(start);
+    LOGP_MSG("Submit+WhenAll %d tasks:%.0fms (odd:%d), packaged_task+get:"
+             "%.0fms (odd:%d)",
+             kTasks, submit_ms, odd, std_ms, std_odd);
+  }
+  return 0;
+}
@@ -32,5 +32,95 @@ int main() {
 
   // 等待演示任务完成
   std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  LOGP_MSG("=== 外部提交吞吐 ===");
+  {
+    // 多个外部线程高频提交小任务，经注入队列分发
+    const int kSubmitters = 4;
+    const size_t kPerSubmitter = 200000;
+    std::atomic<size_t> done{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+      ThreadPool pool(4);
+      std::vector<std::thread> submitters;
+      for (int s = 0; s < kSubmitters; ++s) {
+        submitters.emplace_back([&] {
+          for (size_t i = 0; i < kPerSubmitter; ++i)
+            pool.PostTask([&]() -> size_t { return ++done; });
+        });
+      }
+      for (auto &submitter : submitters)
+        submitter.join();
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOGP_MSG("external tasks:%zu/%zu in %.0fms (%.1f M tasks/s)", done.load(),
+             kSubmitters * kPerSubmitter, ms,
+             done.load() / ms / 1000.0);
+  }
+
+  LOGP_MSG("=== 批量提交 ===");
+  {
+    std::atomic<size_t> done{0};
+    {
+      ThreadPool pool(4);
+      for (int round = 0; round < 100; ++round) {
+        std::vector<CallBack> tasks;
+        for (int i = 0; i < 1000; ++i)
+          tasks.emplace_back([&]() -> size_t { return ++done; });
+        pool.PostTask(std::move(tasks));
+      }
+    }
+    LOGP_MSG("batched tasks:%zu/100000", done.load());
+  }
+
+  LOGP_MSG("=== 递归派生与窃取 ===");
+  {
+    // 工作线程内派生的任务进入本地队列，空闲线程窃取
+    const int kDepth = 18;
+    std::atomic<size_t> leaves{0};
+    uint64_t steals = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+      ThreadPool pool(4);
+      std::function<void(int)> split = [&](int depth) {
+        if (depth == 0) {
+          leaves++;
+          return;
+        }
+        for (int child = 0; child < 2; ++child) {
+          pool.PostTask([&, depth]() -> size_t {
+            split(depth - 1);
+            return 0;
+          });
+        }
+      };
+      pool.PostTask([&]() -> size_t {
+        split(kDepth);
+        return 0;
+      });
+      while (leaves.load() < (size_t(1) << kDepth))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      steals = pool.StealCount();
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOGP_MSG("spawned leaves:%zu/%zu,steals:%llu in %.0fms", leaves.load(),
+             size_t(1) << kDepth, static_cast<unsigned long long>(steals),
+             ms);
+  }
+
+  LOGP_MSG("=== 析构排空 ===");
+  {
+    std::atomic<size_t> done{0};
+    {
+      ThreadPool pool(2);
+      for (int i = 0; i < 10000; ++i)
+        pool.PostTask([&]() -> size_t { return ++done; });
+    }
+    LOGP_MSG("drained on destruction:%zu/10000", done.load());
+  }
   return 0;
 }
\ No newline at end of file
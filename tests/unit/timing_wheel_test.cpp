@@ -0,0 +1,47 @@
+#include "../../include/logger/logger.hpp"
+#include "../../include/threading/timing_wheel.hpp"
+#include <thread>
+
+int main() {
+  threading::TimingWheel wheel(1); // 1ms精度
+
+  // 基本测试
+  wheel.Add(10, []() { LOG_MSG("10ms后执行"); });
+  wheel.Add(300, []() { LOG_MSG("300ms后执行(第1层级联)"); });
+
+  // 周期测试
+  int ticks = 0;
+  threading::TimerId every_id = 0;
+  every_id = wheel.Add(
+      50,
+      [&]() {
+        LOGP_MSG("周期任务第%d次", ++ticks);
+        if (ticks == 3)
+          wheel.Cancel(every_id); // 回调内取消自身
+      },
+      50);
+
+  // 取消测试
+  auto cancel_id = wheel.Add(20, []() { LOG_MSG("这个应该看不到"); });
+  bool first = wheel.Cancel(cancel_id);
+  bool second = wheel.Cancel(cancel_id);
+  LOGP_MSG("cancel ret:%d,重复取消ret:%d", first, second);
+
+  // 未推进时下一到期tick保持不变，剩余毫秒数随时间减少
+  wheel.Advance();
+  int64_t tick_before = wheel.NextExpireTick();
+  int64_t timeout_before = wheel.NextTimeoutMs();
+  std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  LOGP_MSG("next tick stable:%d(expected 1),timeout shrinks:%d(expected 1)",
+           wheel.NextExpireTick() == tick_before,
+           wheel.NextTimeoutMs() < timeout_before);
+
+  // 模拟事件循环推进
+  while (wheel.Size() > 0) {
+    int64_t timeout = wheel.NextTimeoutMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+    wheel.Advance();
+  }
+  LOGP_MSG("测试结束,周期任务执行%d次", ticks);
+  return 0;
+}
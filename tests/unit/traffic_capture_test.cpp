@@ -0,0 +1,211 @@
+#include "../../include/net/core/capture_replay.hpp"
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <random>
+
+using namespace net;
+
+// 帧格式: 'N''R' 长度2 负载 0x0A
+const size_t kHeadSize = 4;
+
+void FrameSize(const uint8_t *head, size_t &head_size, size_t &data_size,
+               size_t &tail_size) {
+  head_size = kHeadSize;
+  data_size = (static_cast<size_t>(head[2]) << 8) | head[3];
+  tail_size = 1;
+}
+
+std::unique_ptr<containers::UnPacker> MakeUnPacker() {
+  return containers::UnPacker::CreateWithCallbacks(
+      containers::HeadKey{'N', 'R'}, containers::TailKey{0x0A},
+      containers::DataSzCb(FrameSize),
+      containers::CheckValidCb([](const uint8_t *) { return true; }), 4096);
+}
+
+void AppendFrame(std::vector<uint8_t> &out, size_t payload_size) {
+  out.push_back('N');
+  out.push_back('R');
+  out.push_back(static_cast<uint8_t>(payload_size >> 8));
+  out.push_back(static_cast<uint8_t>(payload_size));
+  for (size_t i = 0; i < payload_size; ++i)
+    out.push_back(static_cast<uint8_t>('a' + i % 26));
+  out.push_back(0x0A);
+}
+
+int ConnectTo(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  return fd;
+}
+
+int main() {
+  const std::string path = "./capture_test.ncap";
+  const int kClients = 4;
+  const int kFramesPerClient = 20000;
+
+  LOG_MSG("Capture_Record_Testing");
+  std::atomic<uint64_t> live_packets{0};
+  auto capture = TrafficCapture::Open(path, 256 << 20);
+  size_t sent_bytes = 0;
+  {
+    ReactorCore reactor;
+    reactor.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+    reactor.SetConnHandlerParams(
+        containers::HeadKey{'N', 'R'}, containers::TailKey{0x0A},
+        FrameSize, [](const uint8_t *) { return true; },
+        [&](std::vector<std::vector<uint8_t>> &packs) {
+          live_packets += packs.size();
+        },
+        4096);
+    reactor.SetCapture(capture);
+    int listen_fd =
+        SocketCreator::CreateTcpSocket("127.0.0.1", 8193, true, SOMAXCONN);
+    reactor.RegisterProtocol(listen_fd, nullptr, true);
+    std::thread loop([&] { reactor.Run(); });
+
+    // 随机帧长、随机写入粒度，制造跨帧与半帧的分段
+    std::mt19937 rng(7);
+    for (int c = 0; c < kClients; ++c) {
+      int fd = ConnectTo(8193);
+      std::vector<uint8_t> stream;
+      for (int i = 0; i < kFramesPerClient; ++i)
+        AppendFrame(stream, rng() % 300);
+      for (size_t offset = 0; offset < stream.size();) {
+        size_t n = std::min<size_t>(1 + rng() % 1500, stream.size() - offset);
+        offset += send(fd, stream.data() + offset, n, 0);
+      }
+      sent_bytes += stream.size();
+      close(fd);
+    }
+    while (live_packets.load() < uint64_t(kClients) * kFramesPerClient)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    reactor.Stop();
+    loop.join();
+  }
+  LOGP_MSG("live packets:%llu,capture records:%llu,bytes:%zu,dropped:%llu",
+           static_cast<unsigned long long>(live_packets.load()),
+           static_cast<unsigned long long>(capture->Records()),
+           capture->Bytes(),
+           static_cast<unsigned long long>(capture->Dropped()));
+  capture->Close();
+
+  LOG_MSG("Capture_Read_Testing");
+  auto reader = CaptureReader::Open(path);
+  uint64_t captured_bytes = 0;
+  std::unordered_map<ConnId, size_t> conns;
+  uint64_t last_ns = 0;
+  bool monotonic = true;
+  size_t records = reader->ForEach([&](const CaptureRecord &record) {
+    captured_bytes += record.size;
+    conns[record.conn_id]++;
+    monotonic = monotonic && record.time_ns >= last_ns;
+    last_ns = record.time_ns;
+    return true;
+  });
+  LOGP_MSG("records:%zu,conns:%zu,bytes:%llu/%zu,monotonic:%d,file:%zu",
+           records, conns.size(),
+           static_cast<unsigned long long>(captured_bytes), sent_bytes,
+           monotonic, reader->Size());
+
+  LOG_MSG("Capture_Replay_UnPacker_Testing");
+  CaptureReplay replay(*reader);
+  ReplayStats stats = replay.ToUnPacker(MakeUnPacker);
+  LOGP_MSG("replayed records:%llu,packets:%llu,invalid:%llu in %.2fms "
+           "(%.0f MB/s)",
+           static_cast<unsigned long long>(stats.records),
+           static_cast<unsigned long long>(stats.packets),
+           static_cast<unsigned long long>(stats.invalid),
+           stats.elapsed_ns / 1e6, stats.bytes * 1e3 / stats.elapsed_ns);
+
+  LOG_MSG("Capture_Replay_Handler_Testing");
+  // 回放到真实的TcpHandler，批次交给派发器工作线程
+  std::atomic<uint64_t> handler_packets{0};
+  auto exec = std::make_shared<const ExecCb>(
+      [&](std::vector<std::vector<uint8_t>> &packs) {
+        handler_packets += packs.size();
+      });
+  {
+    PacketDispatcher dispatcher(1);
+    stats = replay.ToHandlers(
+        [&](int fd, CaptureKind) -> std::unique_ptr<ProtocolHandler> {
+          auto handler = std::make_unique<TcpHandler>(fd, MakeUnPacker());
+          handler->SetCallback(exec);
+          return handler;
+        },
+        dispatcher);
+    while (handler_packets.load() < stats.records &&
+           handler_packets.load() < uint64_t(kClients) * kFramesPerClient)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  LOGP_MSG("handler replay records:%llu,packets:%llu in %.2fms",
+           static_cast<unsigned long long>(stats.records),
+           static_cast<unsigned long long>(handler_packets.load()),
+           stats.elapsed_ns / 1e6);
+
+  LOG_MSG("Capture_Replay_Pacing_Testing");
+  // 10倍速按原始节奏回放单个连接
+  ReplayOptions options;
+  options.original_pacing = true;
+  options.speed = 10.0;
+  options.only_conn = conns.begin()->first;
+  uint64_t span_ns = 0;
+  reader->ForEach([&](const CaptureRecord &record) {
+    if (record.conn_id == options.only_conn)
+      span_ns = record.time_ns;
+    return true;
+  });
+  stats = CaptureReplay(*reader, options).Run([](const CaptureRecord &) {});
+  LOGP_MSG("paced records:%llu,capture span:%.2fms,replay took:%.2fms",
+           static_cast<unsigned long long>(stats.records), span_ns / 1e6,
+           stats.elapsed_ns / 1e6);
+
+  reader.reset();
+  unlink(path.c_str());
+
+  LOG_MSG("Capture_Replay_Max_Packet_Testing");
+  {
+    // 声明60000字节的帧超过回放扩容上限：丢弃而不是无限扩容，之后的帧照常解析
+    const std::string hostile_path = "./capture_hostile.ncap";
+    auto writer = TrafficCapture::Open(hostile_path, 1 << 20);
+    std::vector<uint8_t> head = {'N', 'R', 60000 >> 8, 60000 & 0xFF};
+    std::vector<uint8_t> body(8000, 'x'), more(12000, 'y'), valid;
+    AppendFrame(valid, 100);
+    head.insert(head.end(), body.begin(), body.end());
+    writer->Append(1, CaptureKind::kStream, head.data(), head.size());
+    writer->Append(1, CaptureKind::kStream, more.data(), more.size());
+    writer->Append(1, CaptureKind::kStream, valid.data(), valid.size());
+    writer->Close();
+
+    auto hostile = CaptureReader::Open(hostile_path);
+    auto permissive = [] {
+      auto unpacker = MakeUnPacker();
+      unpacker->SetMaxPacketSize(1 << 20); // 解析器本身不限制包长
+      return unpacker;
+    };
+    ReplayOptions capped;
+    capped.max_packet_size = 16384;
+    ReplayStats capped_stats =
+        CaptureReplay(*hostile, capped).ToUnPacker(permissive);
+    ReplayStats fixed_stats = CaptureReplay(*hostile).ToUnPacker(permissive);
+    // 有上限时与TcpHandler一致，超长的声明长度按误匹配的头丢弃；
+    // 不扩容时未收全的包填满缓冲区，丢弃已缓冲数据
+    LOGP_MSG("capped invalid:%llu(expected >0),packets:%llu(expected 1);"
+             "fixed rejected:%llu(expected 1),packets:%llu(expected 1)",
+             static_cast<unsigned long long>(capped_stats.invalid),
+             static_cast<unsigned long long>(capped_stats.packets),
+             static_cast<unsigned long long>(fixed_stats.rejected),
+             static_cast<unsigned long long>(fixed_stats.packets));
+    hostile.reset();
+    unlink(hostile_path.c_str());
+  }
+  return 0;
+}
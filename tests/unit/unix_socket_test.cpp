@@ -0,0 +1,163 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+#include <fcntl.h>
+
+using namespace net;
+
+// 读取经SCM_RIGHTS收到的管道内容
+std::string ReadPassedFd(int fd) {
+  char buf[64] = {};
+  ssize_t n = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  return n > 0 ? std::string(buf, n) : std::string();
+}
+
+// 创建写入了内容的管道，返回读端
+int MakePipeWith(const char *text) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return -1;
+  write(fds[1], text, strlen(text));
+  close(fds[1]);
+  return fds[0];
+}
+
+int main() {
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  server.SetConnHandlerParams({0xE, 0xD}, {0xA});
+
+  std::atomic<int> packs_received{0};
+  std::atomic<int> fds_received{0};
+  server.SetConnExecCallback(
+      [&](ConnId conn_id, std::vector<std::vector<uint8_t>> &packs) {
+        for (auto &pack : packs) {
+          LOG_VECTOR(pack);
+          server.Send(conn_id, pack);
+        }
+        packs_received += packs.size();
+      });
+  server.SetFdRecvCallback([&](ConnId, std::vector<int> &fds) {
+    for (int fd : fds)
+      LOGP_MSG("received fd content:%s", ReadPassedFd(fd).c_str());
+    fds_received += fds.size();
+  });
+
+  LOG_MSG("Unix_Stream_Abstract_Testing");
+  int abstract_fd =
+      SocketCreator::CreateUnixStreamSocket("@nebula_unix_test", true, SOMAXCONN);
+  server.RegisterProtocol(abstract_fd, nullptr, true);
+
+  LOG_MSG("Unix_Stream_Path_Testing");
+  int path_fd = SocketCreator::CreateUnixStreamSocket(
+      "/tmp/nebula_unix_test.sock", true, SOMAXCONN);
+  server.RegisterProtocol(path_fd, nullptr, true);
+
+  LOG_MSG("Unix_Dgram_Testing");
+  int dgram_fd = SocketCreator::CreateUnixDgramSocket("@nebula_unix_dgram");
+  auto dgram_handler = std::make_unique<UdpHandler>(dgram_fd, nullptr);
+  dgram_handler->SetFdPassing(4);
+  std::atomic<int> datagrams_received{0};
+  dgram_handler->SetDatagramCallback(
+      [&](int fd, std::vector<Datagram> &datagrams) {
+        for (auto &dg : datagrams) {
+          LOGP_MSG("datagram size:%lu,fds:%lu", dg.payload.size(),
+                   dg.fds.size());
+          for (int passed : dg.fds)
+            LOGP_MSG("datagram fd content:%s", ReadPassedFd(passed).c_str());
+          dg.fds.clear();
+        }
+        datagrams_received += datagrams.size();
+        UdpHandler::SendBatch(fd, datagrams);
+      });
+  server.RegisterProtocol(dgram_fd, std::move(dgram_handler));
+  std::thread server_thread([&] { server.Run(); });
+
+  // 客户端：两条流式连接各发一个包，抽象地址连接附带一个描述符
+  ReactorCore client;
+  client.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  client.SetConnHandlerParams({0xE, 0xD}, {0xA});
+  std::atomic<int> echoes{0};
+  ConnectOptions options;
+  options.exec_cb = [&](ConnId, std::vector<std::vector<uint8_t>> &packs) {
+    echoes += packs.size();
+  };
+  client.ConnectUnix(
+      "@nebula_unix_test",
+      [&](ConnId conn_id, int error) {
+        LOGP_MSG("abstract connect error:%d", error);
+        if (error == 0)
+          client.SendFds(conn_id, {0xE, 0xD, 0x1, 0xA},
+                         {MakePipeWith("from abstract")});
+      },
+      options);
+  client.ConnectUnix(
+      "/tmp/nebula_unix_test.sock",
+      [&](ConnId conn_id, int error) {
+        LOGP_MSG("path connect error:%d", error);
+        if (error == 0)
+          client.Send(conn_id, std::vector<uint8_t>{0xE, 0xD, 0x2, 0xA});
+      },
+      options);
+  client.ConnectUnix("@nebula_unix_missing", [](ConnId, int error) {
+    LOGP_MSG("missing connect error:%d", error);
+  });
+  std::thread client_thread([&] { client.Run(); });
+
+  // 数据报：自动命名的客户端套接字附带两个描述符
+  int dgram_client = SocketCreator::CreateUnixDgramSocket("", false);
+  std::vector<Datagram> out(1);
+  SocketCreator::MakeUnixAddress(
+      "@nebula_unix_dgram", *reinterpret_cast<sockaddr_un *>(&out[0].peer),
+      out[0].peer_len);
+  out[0].payload = {0x1, 0x2, 0x3};
+  out[0].fds = {MakePipeWith("dgram a"), MakePipeWith("dgram b")};
+  LOGP_MSG("dgram sent:%d", UdpHandler::SendBatch(dgram_client, out));
+  for (int fd : out[0].fds)
+    close(fd);
+  uint8_t reply[16];
+  ssize_t reply_len = recv(dgram_client, reply, sizeof(reply), 0);
+  LOGP_MSG("dgram reply size:%ld", reply_len);
+  close(dgram_client);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  LOGP_MSG("packs:%d,fds:%d,datagrams:%d,echoes:%d", packs_received.load(),
+           fds_received.load(), datagrams_received.load(), echoes.load());
+
+  client.Stop();
+  server.Stop();
+  client_thread.join();
+  server_thread.join();
+  unlink("/tmp/nebula_unix_test.sock");
+
+  LOG_MSG("PacketBatch_Drop_Closes_Fds_Testing");
+  {
+    // 未执行即丢弃的批次关闭携带的描述符；执行后所有权归回调，不再关闭
+    auto is_open = [](int fd) { return fcntl(fd, F_GETFD) != -1; };
+    auto keep = std::make_shared<const FdRecvCb>(
+        [](ConnId, std::vector<int> &) {});
+    int dropped_fd = MakePipeWith("dropped");
+    int dropped_dgram_fd = MakePipeWith("dropped dgram");
+    {
+      PacketBatch batch;
+      batch.fd_cb = keep;
+      batch.fds = {dropped_fd};
+      batch.datagrams.resize(1);
+      batch.datagrams[0].fds = {dropped_dgram_fd};
+      PacketBatch moved = std::move(batch);
+    }
+    bool dropped_closed = !is_open(dropped_fd) && !is_open(dropped_dgram_fd);
+    int kept_fd = MakePipeWith("kept");
+    {
+      PacketBatch batch;
+      batch.fd_cb = keep;
+      batch.fds = {kept_fd};
+      batch.Run();
+    }
+    bool kept_open = is_open(kept_fd);
+    close(kept_fd);
+    LOGP_MSG("dropped fds closed:%d(expected 1),run fds kept:%d(expected 1)",
+             dropped_closed, kept_open);
+  }
+  return 0;
+}
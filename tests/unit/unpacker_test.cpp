@@ -5,8 +5,8 @@
 int main(int argc, char const *argv[]) {
   using namespace containers;
 
-  UnPacker up(
-      HeadKey{0x7, 0x9}, HeadKey{0xE,0XD},
+  auto up = UnPacker::CreateWithCallbacks(
+      HeadKey{0x7, 0x9}, TailKey{0xE, 0XD},
       [](const uint8_t *head_ptr, size_t &head_size, size_t &data_size,
          size_t &tail_size) {
         head_size = 3;
@@ -29,11 +29,81 @@ int main(int argc, char const *argv[]) {
 
   std::vector<std::vector<uint8_t>> test_out_data;
 
-  up.PushAndGet(test_in_data.data(), test_in_data.size(), test_out_data);
-  LOGP_MSG("剩余%d可读字节,解出%d包", up.Length(),test_out_data.size());
+  up->PushAndGet(test_in_data.data(), test_in_data.size(), test_out_data);
+  LOGP_MSG("剩余%d可读字节,解出%d包", up->Length(),test_out_data.size());
 
   for (const auto &item : test_out_data) {
     LOG_VECTOR(item);
   }
+
+  // 头部: 0x7,0x9,长度低字节,长度高字节
+  auto length_cb = [](const uint8_t *head_ptr, size_t &head_size,
+                      size_t &data_size, size_t &tail_size) {
+    head_size = 4;
+    data_size = head_ptr[2] | (head_ptr[3] << 8);
+    tail_size = 2;
+  };
+
+  LOG_MSG("UnPacker_Partial_Head_Testing");
+  {
+    // 长度字段分两次到达，先到的部分不应被当作误匹配的头丢弃
+    auto partial = UnPacker::CreateWithCallbacks(
+        HeadKey{0x7, 0x9}, TailKey{0xE, 0XD}, length_cb,
+        [](const uint8_t *) { return true; }, 64);
+    std::vector<uint8_t> first = {0x7, 0x9, 3};
+    std::vector<uint8_t> second = {0, 0xA, 0xB, 0xC, 0xE, 0XD};
+    std::vector<std::vector<uint8_t>> out;
+    partial->PushAndGet(first.data(), first.size(), out);
+    size_t first_count = out.size();
+    size_t first_pending = partial->PendingPacketSize();
+    partial->PushAndGet(second.data(), second.size(), out);
+    LOGP_MSG("first push packets:%zu(expected 0),pending:%zu(expected 4),"
+             "second push packets:%zu(expected 1),size:%zu(expected 9),"
+             "invalid:%llu",
+             first_count, first_pending, out.size(),
+             out.empty() ? 0 : out[0].size(),
+             static_cast<unsigned long long>(partial->InvalidCount()));
+  }
+
+  LOG_MSG("UnPacker_Partial_Head_Wrap_Testing");
+  {
+    // 缓冲区末尾只剩半个头部，其余字节环回到开头
+    auto wrap = UnPacker::CreateWithCallbacks(
+        HeadKey{0x7, 0x9}, TailKey{0xE, 0XD}, length_cb,
+        [](const uint8_t *) { return true; }, 16);
+    std::vector<uint8_t> filler = {0x7, 0x9, 7, 0, 1, 2,   3,
+                                   4,   5,   6, 7, 0xE, 0XD};
+    std::vector<uint8_t> head = {0x7, 0x9};
+    std::vector<uint8_t> rest = {2, 0, 0xA, 0xB, 0xE, 0XD};
+    std::vector<std::vector<uint8_t>> out;
+    // 首包解出后读位置停在13，长度字段跨越环回，开头仍是首包的残留字节
+    wrap->PushAndGet(filler.data(), filler.size(), out);
+    size_t filler_count = out.size();
+    wrap->PushAndGet(head.data(), head.size(), out);
+    size_t head_count = out.size();
+    wrap->PushAndGet(rest.data(), rest.size(), out);
+    LOGP_MSG("filler packets:%zu,head only packets:%zu,after rest "
+             "packets:%zu(expected 1),size:%zu(expected 8),invalid:%llu",
+             filler_count, head_count, out.size(),
+             out.empty() ? 0 : out[0].size(),
+             static_cast<unsigned long long>(wrap->InvalidCount()));
+  }
+
+  LOG_MSG("UnPacker_HeadTail_Wrap_Testing");
+  {
+    // 头前垃圾字节应被丢弃，同一次写入中的连续包都应解出，尾定位符跨越环回
+    auto ht = UnPacker::CreateBasic(HeadKey{0x7, 0x9}, TailKey{0xE, 0XD}, 16);
+    std::vector<uint8_t> first = {0x1, 0x7, 0x9, 1, 2, 3, 4, 5, 6, 0xE, 0XD};
+    std::vector<uint8_t> second = {0x2, 0x7, 0x9, 1, 0xE, 0XD,
+                                   0x7, 0x9, 2, 0xE, 0XD};
+    std::vector<std::vector<uint8_t>> out;
+    ht->PushAndGet(first.data(), first.size(), out);
+    size_t first_count = out.size();
+    ht->PushAndGet(second.data(), second.size(), out);
+    LOGP_MSG("first push packets:%zu(expected 1),second push packets:%zu"
+             "(expected 2),sizes:%zu,%zu(expected 5,5),remain:%zu(expected 0)",
+             first_count, out.size(), out.size() > 0 ? out[0].size() : 0,
+             out.size() > 1 ? out[1].size() : 0, ht->Length());
+  }
   return 0;
 }
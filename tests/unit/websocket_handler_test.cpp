@@ -0,0 +1,289 @@
+#include "../../include/net/core/reactor_core.hpp"
+#include "../../include/net/protocol/websocket_handler.hpp"
+#include "../../include/net/transport/socket_creator.hpp"
+
+using namespace net;
+
+// 阻塞客户端连接
+int ConnectTo(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  timeval tv{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+void SendText(int fd, const std::string &text) {
+  send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+}
+
+// 读取直到收到响应头结束符
+std::string ReadHead(int fd) {
+  std::string received;
+  char c;
+  while (received.find("\r\n\r\n") == std::string::npos &&
+         recv(fd, &c, 1, 0) == 1)
+    received.push_back(c);
+  return received;
+}
+
+// 升级请求，返回响应状态行
+std::string Upgrade(int fd, const std::string &extra = std::string()) {
+  SendText(fd, "GET /chat HTTP/1.1\r\nHost: a\r\nUpgrade: websocket\r\n"
+               "Connection: keep-alive, Upgrade\r\n"
+               "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n" +
+                   extra + "\r\n");
+  std::string head = ReadHead(fd);
+  return head.substr(0, head.find("\r\n"));
+}
+
+// 编码客户端帧(带掩码)
+std::string ClientFrame(WebSocketOpcode opcode, const std::string &payload,
+                        bool fin = true, bool masked = true) {
+  uint8_t header[WebSocketCodec::kMaxHeaderSize];
+  size_t header_size =
+      WebSocketCodec::EncodeHeader(header, opcode, payload.size(), fin);
+  std::string frame(reinterpret_cast<char *>(header), header_size);
+  if (!masked)
+    return frame + payload;
+  frame[1] = static_cast<char>(frame[1] | 0x80);
+  const uint8_t mask[4] = {0x37, 0xfa, 0x21, 0x3d};
+  frame.append(reinterpret_cast<const char *>(mask), 4);
+  for (size_t i = 0; i < payload.size(); ++i)
+    frame.push_back(static_cast<char>(payload[i] ^ mask[i & 3]));
+  return frame;
+}
+
+// 读取一个服务端帧
+bool ReadFrame(int fd, WebSocketOpcode &opcode, std::string &payload) {
+  std::string data;
+  char buf[65536];
+  WebSocketFrameHeader header;
+  while (true) {
+    int parsed = WebSocketCodec::ParseHeader(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size(), header);
+    if (parsed == 1 && data.size() >= header.header_size + header.payload_size)
+      break;
+    // 逐帧读取，不越过当前帧
+    size_t want = parsed == 1 ? header.header_size + header.payload_size -
+                                    data.size()
+                              : 1;
+    ssize_t n = recv(fd, buf, std::min(want, sizeof(buf)), 0);
+    if (n <= 0)
+      return false;
+    data.append(buf, n);
+  }
+  opcode = header.opcode;
+  payload = data.substr(header.header_size, header.payload_size);
+  return true;
+}
+
+// 打印帧，关闭帧打印状态码
+void LogFrame(int fd) {
+  WebSocketOpcode opcode;
+  std::string payload;
+  if (!ReadFrame(fd, opcode, payload)) {
+    LOG_MSG("no frame");
+    return;
+  }
+  if (opcode == WebSocketOpcode::kClose && payload.size() >= 2) {
+    int code = (static_cast<uint8_t>(payload[0]) << 8) |
+               static_cast<uint8_t>(payload[1]);
+    LOGP_MSG("close frame code:%d,reason:%s", code, payload.substr(2).c_str());
+    return;
+  }
+  LOGP_MSG("opcode:%d,size:%lu,payload:%s", static_cast<int>(opcode),
+           payload.size(),
+           payload.size() > 64 ? "<large>" : payload.c_str());
+}
+
+int main() {
+  LOG_MSG("Websocket_Codec_Testing");
+  // RFC 6455 1.3节示例
+  LOGP_MSG("accept key:%s",
+           WebSocketCodec::AcceptKey("dGhlIHNhbXBsZSBub25jZQ==").c_str());
+  const char *utf8_cases[] = {"hello", "\xe4\xbd\xa0\xe5\xa5\xbd",
+                              "\xc0\xaf", "\xed\xa0\x80",
+                              "\xf4\x90\x80\x80", "\xe4\xbd"};
+  for (const char *text : utf8_cases)
+    LOGP_MSG("utf8 valid:%d", WebSocketCodec::IsValidUtf8(
+                                  reinterpret_cast<const uint8_t *>(text),
+                                  strlen(text)));
+
+  // 向量化去掩码与逐字节结果一致，并比较耗时
+  const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+  std::vector<uint8_t> data(1 << 20);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i * 131);
+  bool same = true;
+  for (size_t offset : {0, 1, 3, 7}) {
+    for (size_t len : {0, 5, 31, 33, 64, 95, 1000}) {
+      std::vector<uint8_t> scalar(data.begin() + offset,
+                                  data.begin() + offset + len);
+      for (size_t i = 0; i < len; ++i)
+        scalar[i] ^= mask[i & 3];
+      std::vector<uint8_t> vec = data;
+      WebSocketCodec::Unmask(vec.data() + offset, len, mask);
+      same = same && std::equal(scalar.begin(), scalar.end(),
+                                vec.begin() + offset);
+    }
+  }
+  LOGP_MSG("unmask matches scalar:%d,avx2 path:%d", same,
+           WebSocketCodec::HasAvx2());
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < 100; ++round)
+    WebSocketCodec::Unmask(data.data(), data.size(), mask);
+  auto vec_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < 100; ++round) {
+    volatile uint8_t *p = data.data();
+    for (size_t i = 0; i < data.size(); ++i)
+      p[i] ^= mask[i & 3];
+  }
+  auto scalar_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOGP_MSG("unmask 100MB vectorized:%ldus,bytewise:%ldus", vec_us, scalar_us);
+
+  ReactorCore server;
+  server.SetDispatcher(std::make_shared<PacketDispatcher>(1));
+  int listen_fd =
+      SocketCreator::CreateTcpSocket("127.0.0.1", 8189, true, SOMAXCONN);
+  server.RegisterProtocol(listen_fd, nullptr, true);
+
+  // 连接表只在循环线程访问
+  std::vector<ConnId> subscribers;
+  WebSocketCallbacks callbacks;
+  callbacks.on_upgrade = [](const HttpRequest &request) {
+    return request.path == "/chat";
+  };
+  callbacks.on_open = [&](ConnId conn_id, WebSocketWriter &writer) {
+    subscribers.push_back(conn_id);
+    writer.Text("welcome");
+  };
+  callbacks.on_message = [&](const WebSocketMessage &message,
+                             WebSocketWriter &writer) {
+    if (message.payload == "broadcast") {
+      // 编码一次，各连接共享同一帧
+      auto frame = WebSocketCodec::EncodeFrame(WebSocketOpcode::kText,
+                                               "news for everyone");
+      for (ConnId conn_id : subscribers)
+        server.Send(conn_id, frame);
+    } else if (message.payload == "bye") {
+      writer.Close(kWsCloseGoingAway, "server done");
+    } else if (message.IsText()) {
+      writer.Text(message.payload);
+    } else {
+      writer.Binary(message.payload);
+    }
+  };
+  WebSocketLimits limits;
+  limits.initial_buffer_size = 256;
+  limits.max_message_size = 256 * 1024;
+  server.SetHandlerFactory(listen_fd,
+                           WebSocketHandler::Factory(callbacks, limits));
+  std::thread server_thread([&] { server.Run(); });
+
+  LOG_MSG("Websocket_Handshake_Testing");
+  int fd = ConnectTo(8189);
+  // 升级请求与首帧在同一次发送中到达
+  SendText(fd, "GET /chat HTTP/1.1\r\nHost: a\r\nUpgrade: websocket\r\n"
+               "Connection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+               "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n" +
+                   ClientFrame(WebSocketOpcode::kText, "early"));
+  std::string head = ReadHead(fd);
+  LOGP_MSG("status:%s", head.substr(0, head.find("\r\n")).c_str());
+  LOGP_MSG("accept ok:%d",
+           head.find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos);
+  LogFrame(fd);
+  LogFrame(fd);
+
+  LOG_MSG("Websocket_Fragment_Testing");
+  // 分片之间穿插Ping，分片跨多次发送
+  std::string fragments =
+      ClientFrame(WebSocketOpcode::kText, "frag", false) +
+      ClientFrame(WebSocketOpcode::kPing, "are you there") +
+      ClientFrame(WebSocketOpcode::kContinuation, "ment", false) +
+      ClientFrame(WebSocketOpcode::kContinuation, "ed!");
+  SendText(fd, fragments.substr(0, 9));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  SendText(fd, fragments.substr(9));
+  LogFrame(fd);
+  LogFrame(fd);
+
+  LOG_MSG("Websocket_Large_Testing");
+  // 16位与64位扩展长度，超过初始缓冲区
+  std::string medium(1000, 'm');
+  std::string large(100000, 'L');
+  SendText(fd, ClientFrame(WebSocketOpcode::kBinary, medium) +
+                   ClientFrame(WebSocketOpcode::kBinary, large));
+  WebSocketOpcode opcode;
+  std::string payload;
+  ReadFrame(fd, opcode, payload);
+  LOGP_MSG("medium echo ok:%d", payload == medium);
+  ReadFrame(fd, opcode, payload);
+  LOGP_MSG("large echo ok:%d", payload == large);
+
+  LOG_MSG("Websocket_Broadcast_Testing");
+  int fd2 = ConnectTo(8189);
+  LOGP_MSG("second:%s", Upgrade(fd2, "Sec-WebSocket-Version: 13\r\n").c_str());
+  LogFrame(fd2);
+  SendText(fd, ClientFrame(WebSocketOpcode::kText, "broadcast"));
+  LogFrame(fd);
+  LogFrame(fd2);
+
+  LOG_MSG("Websocket_Close_Testing");
+  std::string close_payload("\x03\xe8ok", 4);
+  SendText(fd2, ClientFrame(WebSocketOpcode::kClose, close_payload));
+  LogFrame(fd2);
+  char tail;
+  LOGP_MSG("closed after close:%d", recv(fd2, &tail, 1, 0) == 0);
+  close(fd2);
+  SendText(fd, ClientFrame(WebSocketOpcode::kText, "bye"));
+  LogFrame(fd);
+  LOGP_MSG("closed after server close:%d", recv(fd, &tail, 1, 0) == 0);
+  close(fd);
+
+  LOG_MSG("Websocket_Error_Testing");
+  fd = ConnectTo(8189);
+  LOGP_MSG("no version:%s", Upgrade(fd).c_str());
+  close(fd);
+  fd = ConnectTo(8189);
+  SendText(fd, "GET /other HTTP/1.1\r\nUpgrade: websocket\r\n"
+               "Connection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+               "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n");
+  head = ReadHead(fd);
+  LOGP_MSG("wrong path:%s", head.substr(0, head.find("\r\n")).c_str());
+  close(fd);
+
+  const std::pair<const char *, std::string> bad_frames[] = {
+      {"unmasked", ClientFrame(WebSocketOpcode::kText, "x", true, false)},
+      {"invalid utf8", ClientFrame(WebSocketOpcode::kText, "\xc0\xaf")},
+      {"bare continuation",
+       ClientFrame(WebSocketOpcode::kContinuation, "x")},
+      {"too big", ClientFrame(WebSocketOpcode::kBinary,
+                              std::string(300 * 1024, 'x'))},
+  };
+  for (const auto &[name, frame] : bad_frames) {
+    fd = ConnectTo(8189);
+    Upgrade(fd, "Sec-WebSocket-Version: 13\r\n");
+    ReadFrame(fd, opcode, payload);
+    SendText(fd, frame);
+    LOGP_MSG("%s:", name);
+    LogFrame(fd);
+    close(fd);
+  }
+
+  server.Stop();
+  server_thread.join();
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "../../include/containers/work_steal_deque.hpp"
+#include "../../include/logger/logger.hpp"
+#include <thread>
+
+void General_IO_Testing() {
+  LOG_MSG("General_IO_Testing");
+  containers::WorkStealDeque<uintptr_t> deque(3); // 向上取整为4
+  LOGP_MSG("capacity:%zu", deque.Capacity());
+  for (uintptr_t i = 1; i <= 10; ++i)
+    deque.Push(i);
+  LOGP_MSG("size:%zu,capacity after grow:%zu", deque.SizeApprox(),
+           deque.Capacity());
+
+  // 所有者后进先出，窃取方先进先出
+  uintptr_t value = 0;
+  deque.Pop(value);
+  LOGP_MSG("pop:%zu", static_cast<size_t>(value));
+  deque.Steal(value);
+  LOGP_MSG("steal:%zu", static_cast<size_t>(value));
+  size_t rest = 0;
+  while (deque.Pop(value))
+    rest++;
+  LOGP_MSG("rest:%zu,empty:%d,steal on empty:%d", rest, deque.IsEmpty(),
+           deque.Steal(value));
+}
+
+void Concurrent_Testing() {
+  LOG_MSG("Concurrent_Testing");
+  // 所有者边入队边出队，多个窃取方并发窃取，每个元素恰好被取走一次
+  const uintptr_t kItems = 1000000;
+  const int kThieves = 3;
+  containers::WorkStealDeque<uintptr_t> deque(64);
+  std::vector<std::atomic<uint8_t>> taken(kItems + 1);
+  std::atomic<uintptr_t> total{0};
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> stolen{0};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThieves; ++i) {
+    thieves.emplace_back([&] {
+      uintptr_t value;
+      uint64_t local = 0;
+      while (!done.load(std::memory_order_acquire) || !deque.IsEmpty()) {
+        if (deque.Steal(value)) {
+          taken[value]++;
+          total++;
+          local++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      stolen += local;
+    });
+  }
+
+  uintptr_t value;
+  for (uintptr_t i = 1; i <= kItems; ++i) {
+    deque.Push(i);
+    if (i % 3 == 0 && deque.Pop(value)) {
+      taken[value]++;
+      total++;
+    }
+  }
+  while (deque.Pop(value)) {
+    taken[value]++;
+    total++;
+  }
+  done.store(true, std::memory_order_release);
+  for (auto &thief : thieves)
+    thief.join();
+
+  size_t duplicated = 0, missing = 0;
+  for (uintptr_t i = 1; i <= kItems; ++i) {
+    if (taken[i] == 0)
+      missing++;
+    else if (taken[i] > 1)
+      duplicated++;
+  }
+  LOGP_MSG("total:%zu,stolen:%llu,missing:%zu,duplicated:%zu",
+           static_cast<size_t>(total.load()),
+           static_cast<unsigned long long>(stolen.load()), missing,
+           duplicated);
+}
+
+int main() {
+  General_IO_Testing();
+  Concurrent_Testing();
+  return 0;
+}